@@ -18,6 +18,7 @@ foreach(
   DEVILUTIONX_RESAMPLER_SPEEX
   DEVILUTIONX_RESAMPLER_SDL
   DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+  DEVILUTIONX_MONSTER_PATH_PLANNING
   SCREEN_READER_INTEGRATION
   UNPACKED_MPQS
   UNPACKED_SAVES
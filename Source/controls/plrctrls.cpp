@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
-#include <list>
 
 #ifdef USE_SDL1
 #include "utils/sdl2_to_1_2_backports.h"
@@ -17,6 +16,7 @@
 #endif
 #include "controls/control_mode.hpp"
 #include "controls/game_controls.h"
+#include "controls/target_search.hpp"
 #include "controls/touch/gamepad.h"
 #include "cursor.h"
 #include "doom.h"
@@ -284,55 +284,44 @@ void FindRangedTarget()
 	}
 }
 
+/** Buffers of the melee target search, kept between game ticks. */
+TileSearch MeleeTargetSearch;
+
 void FindMeleeTarget()
 {
-	bool visited[MAXDUNX][MAXDUNY] = { {} };
 	int maxSteps = 25; // Max steps for FindPath is 25
 	int rotations = 0;
 	bool canTalk = false;
 
-	struct SearchNode {
-		int x, y;
-		int steps;
-	};
-	std::list<SearchNode> queue;
-
 	const Player &myPlayer = *MyPlayer;
+	TileSearch &search = MeleeTargetSearch;
+	search.start(myPlayer.position.future);
 
-	{
-		const int startX = myPlayer.position.future.x;
-		const int startY = myPlayer.position.future.y;
-		visited[startX][startY] = true;
-		queue.push_back({ startX, startY, 0 });
-	}
-
-	while (!queue.empty()) {
-		const SearchNode node = queue.front();
-		queue.pop_front();
+	while (!search.empty()) {
+		const TileSearch::Node node = search.pop();
 
 		for (auto pathDir : PathDirs) {
-			const int dx = node.x + pathDir.deltaX;
-			const int dy = node.y + pathDir.deltaY;
+			const Point target = node.position + pathDir;
 
-			if (visited[dx][dy])
+			if (search.isVisited(target))
 				continue; // already visisted
 
 			if (node.steps > maxSteps) {
-				visited[dx][dy] = true;
+				search.markVisited(target);
 				continue;
 			}
 
-			if (!PosOkPlayer(myPlayer, { dx, dy })) {
-				visited[dx][dy] = true;
+			if (!PosOkPlayer(myPlayer, target)) {
+				search.markVisited(target);
 
-				if (dMonster[dx][dy] != 0) {
-					const int mi = std::abs(dMonster[dx][dy]) - 1;
+				if (dMonster[target.x][target.y] != 0) {
+					const int mi = std::abs(dMonster[target.x][target.y]) - 1;
 					const Monster &monster = Monsters[mi];
 					if (CanTargetMonster(monster)) {
 						const bool newCanTalk = CanTalkToMonst(monster);
 						if (pcursmonst != -1 && !canTalk && newCanTalk)
 							continue;
-						const int newRotations = GetRotaryDistance({ dx, dy });
+						const int newRotations = GetRotaryDistance(target);
 						if (pcursmonst != -1 && canTalk == newCanTalk && rotations < newRotations)
 							continue;
 						rotations = newRotations;
@@ -346,9 +335,8 @@ void FindMeleeTarget()
 				continue;
 			}
 
-			if (CanStep({ node.x, node.y }, { dx, dy })) {
-				queue.push_back({ dx, dy, node.steps + 1 });
-				visited[dx][dy] = true;
+			if (CanStep(node.position, target)) {
+				search.push(target, node.steps + 1);
 			}
 		}
 	}
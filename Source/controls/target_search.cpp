@@ -0,0 +1,41 @@
+#include "controls/target_search.hpp"
+
+#include <cassert>
+
+namespace devilution {
+
+void TileSearch::start(Point origin)
+{
+	generation_++;
+	if (generation_ == 0) {
+		// The stamps wrapped around, stale stamps could now match the current search
+		for (auto &column : visited_) {
+			for (uint16_t &stamp : column)
+				stamp = 0;
+		}
+		generation_ = 1;
+	}
+
+	head_ = 0;
+	count_ = 0;
+	push(origin, 0);
+}
+
+TileSearch::Node TileSearch::pop()
+{
+	assert(count_ > 0);
+	const Node node = queue_[head_];
+	head_ = (head_ + 1) % QueueCapacity;
+	count_--;
+	return node;
+}
+
+void TileSearch::push(Point position, int steps)
+{
+	assert(count_ < QueueCapacity);
+	markVisited(position);
+	queue_[(head_ + count_) % QueueCapacity] = { position, steps };
+	count_++;
+}
+
+} // namespace devilution
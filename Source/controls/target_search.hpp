@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/point.hpp"
+#include "levels/gendung_defs.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Breadth-first search over dungeon tiles that keeps its buffers between searches.
+ *
+ * Visited tiles are stamped with the number of the current search, so starting a new search does not need to
+ * clear the grid, and queued tiles live in a fixed ring buffer, so expanding a tile never allocates.
+ */
+class TileSearch {
+public:
+	struct Node {
+		Point position;
+		int steps;
+	};
+
+	/** @brief Nodes that can be queued at once, enough for two rings of a search limited to 60 steps. */
+	static constexpr size_t QueueCapacity = 1024;
+
+	/** @brief Forgets all visited tiles and queued nodes, then queues `origin` as visited at 0 steps. */
+	void start(Point origin);
+
+	[[nodiscard]] bool empty() const
+	{
+		return count_ == 0;
+	}
+
+	/** @brief Removes and returns the node that was queued first. */
+	Node pop();
+
+	/** @brief Marks the tile as visited and queues it. */
+	void push(Point position, int steps);
+
+	[[nodiscard]] bool isVisited(Point position) const
+	{
+		return visited_[position.x][position.y] == generation_;
+	}
+
+	void markVisited(Point position)
+	{
+		visited_[position.x][position.y] = generation_;
+	}
+
+private:
+	/** Number of the search that last visited each tile. */
+	uint16_t visited_[MAXDUNX][MAXDUNY] = {};
+	uint16_t generation_ = 0;
+	std::array<Node, QueueCapacity> queue_;
+	size_t head_ = 0;
+	size_t count_ = 0;
+};
+
+} // namespace devilution
@@ -40,7 +40,7 @@ enum cursor_id : uint8_t {
 	CURSOR_FIRSTITEM,
 };
 
-extern int pcursmonst;
+extern DVL_API_FOR_TEST int pcursmonst;
 extern int8_t pcursinvitem;
 extern uint16_t pcursstashitem;
 extern int8_t pcursitem;
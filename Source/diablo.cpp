@@ -49,6 +49,7 @@
 #include "hwcursor.hpp"
 #include "init.hpp"
 #include "inv.h"
+#include "items.h"
 #include "levels/drlg_l1.h"
 #include "levels/drlg_l2.h"
 #include "levels/drlg_l3.h"
@@ -56,6 +57,7 @@
 #include "levels/gendung.h"
 #include "levels/setmaps.h"
 #include "levels/themes.h"
+#include "levels/tile_properties.hpp"
 #include "levels/town.h"
 #include "levels/trigs.h"
 #include "lighting.h"
@@ -95,6 +97,7 @@
 #include "utils/display.h"
 #include "utils/is_of.hpp"
 #include "utils/language.h"
+#include "utils/log.hpp"
 #include "utils/parse_int.hpp"
 #include "utils/paths.h"
 #include "utils/screen_reader.hpp"
@@ -3316,6 +3319,9 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 {
 	const _music_id neededTrack = GetLevelMusic(leveltype);
 
+	const RecreateItemCacheStats recreateItemStats = GetRecreateItemCacheStats();
+	LogVerbose("RecreateItem cache: {} hits, {} misses", recreateItemStats.hits, recreateItemStats.misses);
+
 	ClearFloatingNumbers();
 	LoadGameLevelStopMusic(neededTrack);
 	LoadGameLevelResetCursor();
@@ -3326,6 +3332,7 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	RETURN_IF_ERROR(LoadTrns());
 	MakeLightTable();
 	RETURN_IF_ERROR(LoadLevelSOLData());
+	ClearTileBitboards();
 
 	IncProgress();
 
@@ -3366,6 +3373,7 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	} else {
 		RETURN_IF_ERROR(LoadGameLevelStandardLevel(firstflag, lvldir, myPlayer));
 	}
+	CompileTileBitboards();
 
 	SyncPortals();
 	LoadGameLevelSyncPlayerEntry(lvldir);
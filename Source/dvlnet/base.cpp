@@ -127,6 +127,7 @@ tl::expected<void, PacketError> base::HandleDisconnect(packet &pkt)
 		PlayerState &playerState = playerStateTable_[*newPlayer];
 		playerState.isConnected = false;
 		playerState.turnQueue.clear();
+		playerState.roundTripLatency = std::nullopt;
 	}
 	return {};
 }
@@ -349,9 +350,30 @@ bool base::SNetSendTurn(char *data, size_t size)
 	std::deque<turn_t> &turnQueue = playerState.turnQueue;
 	turnQueue.push_back(turn);
 	SendTurnIfReady(turn);
+	SendEchoRequests();
 	return true;
 }
 
+void base::SendEchoRequests()
+{
+	// Keep measuring the round trip time so the turn pacing can follow changes in latency
+	constexpr uint32_t EchoRequestInterval = 1000;
+
+	const uint32_t now = SDL_GetTicks();
+	if (now - lastEchoRequestTime_ < EchoRequestInterval)
+		return;
+	lastEchoRequestTime_ = now;
+
+	for (plr_t player = 0; player < Players.size(); player++) {
+		if (player == plr_self || !IsConnected(player))
+			continue;
+		if (tl::expected<void, PacketError> result = SendEchoRequest(player);
+		    !result.has_value()) {
+			LogError("SendEchoRequest: {}", result.error().what());
+		}
+	}
+}
+
 tl::expected<void, PacketError> base::SendTurnIfReady(turn_t turn)
 {
 	if (awaitingSequenceNumber_)
@@ -525,5 +547,18 @@ bool base::SNetGetTurnsInTransit(uint32_t *turns)
 	return true;
 }
 
+bool base::SNetGetLatency(uint8_t playerId, uint32_t *latency)
+{
+	if (playerId >= MAX_PLRS || !IsConnected(playerId))
+		return false;
+
+	const PlayerState &playerState = playerStateTable_[playerId];
+	if (!playerState.roundTripLatency)
+		return false;
+
+	*latency = *playerState.roundTripLatency;
+	return true;
+}
+
 } // namespace net
 } // namespace devilution
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <ankerl/unordered_dense.h>
@@ -29,6 +30,7 @@ public:
 	bool SNetDropPlayer(int playerid, uint32_t flags) override;
 	bool SNetGetOwnerTurnsWaiting(uint32_t *turns) override;
 	bool SNetGetTurnsInTransit(uint32_t *turns) override;
+	bool SNetGetLatency(uint8_t playerId, uint32_t *latency) override;
 
 	virtual tl::expected<void, PacketError> poll() = 0;
 	virtual tl::expected<void, PacketError> send(packet &pkt) = 0;
@@ -64,7 +66,7 @@ protected:
 		bool isConnected = {};
 		std::deque<turn_t> turnQueue;
 		int32_t lastTurnValue = {};
-		uint32_t roundTripLatency = {};
+		std::optional<uint32_t> roundTripLatency;
 	};
 
 	seq_t current_turn = 0;
@@ -88,8 +90,10 @@ protected:
 private:
 	std::array<PlayerState, MAX_PLRS> playerStateTable_;
 	bool awaitingSequenceNumber_ = true;
+	uint32_t lastEchoRequestTime_ = 0;
 
 	plr_t GetOwner();
+	void SendEchoRequests();
 	bool AllTurnsArrived();
 	tl::expected<void, PacketError> MakeReady(seq_t sequenceNumber);
 	tl::expected<void, PacketError> SendTurnIfReady(turn_t turn);
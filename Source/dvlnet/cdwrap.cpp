@@ -98,6 +98,11 @@ bool cdwrap::SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_wrap->SNetGetTurnsInTransit(turns);
 }
 
+bool cdwrap::SNetGetLatency(uint8_t playerId, uint32_t *latency)
+{
+	return dvlnet_wrap->SNetGetLatency(playerId, latency);
+}
+
 std::string cdwrap::make_default_gamename()
 {
 	return dvlnet_wrap->make_default_gamename();
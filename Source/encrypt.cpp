@@ -19,7 +19,7 @@ namespace devilution {
 namespace {
 
 struct TDataInfo {
-	std::byte *srcData;
+	const std::byte *srcData;
 	uint32_t srcOffset;
 	uint32_t srcSize;
 	std::byte *destData;
@@ -114,4 +114,25 @@ uint32_t PkwareDecompress(std::byte *inBuff, uint32_t recvSize, size_t maxBytes)
 	return info.destOffset;
 }
 
+const size_t PkwareWorkBufferSize = CMP_BUFFER_SIZE;
+
+uint32_t PkwareDecompress(const std::byte *src, uint32_t srcSize, std::byte *dest, size_t destSize, std::byte *workBuf)
+{
+	TDataInfo info;
+	info.srcData = src;
+	info.srcOffset = 0;
+	info.srcSize = srcSize;
+	info.destData = dest;
+	info.destOffset = 0;
+	info.destSize = destSize;
+	info.error = false;
+
+	const unsigned result = explode(PkwareBufferRead, PkwareBufferWrite, reinterpret_cast<char *>(workBuf), &info);
+	if (result != CMP_NO_ERROR || info.error) {
+		return 0;
+	}
+
+	return info.destOffset;
+}
+
 } // namespace devilution
@@ -13,4 +13,14 @@ namespace devilution {
 uint32_t PkwareCompress(std::byte *srcData, uint32_t size);
 uint32_t PkwareDecompress(std::byte *inBuff, uint32_t recvSize, size_t maxBytes);
 
+/** @brief Size of the scratch buffer expected by the non-destructive PkwareDecompress. */
+extern const size_t PkwareWorkBufferSize;
+
+/**
+ * @brief Decompresses PKWare imploded data without modifying the source, e.g. straight out of a memory mapped file.
+ * @param workBuf Scratch space of at least PkwareWorkBufferSize bytes
+ * @return Number of bytes written to dest, or 0 if the data does not fit or is corrupt
+ */
+uint32_t PkwareDecompress(const std::byte *src, uint32_t srcSize, std::byte *dest, size_t destSize, std::byte *workBuf);
+
 } // namespace devilution
@@ -298,7 +298,7 @@ bool LoadMPQ(std::span<const std::string> paths, std::string_view mpqName, int p
 	std::int32_t error = 0;
 	for (const auto &path : paths) {
 		mpqAbsPath = StrCat(path, mpqName, ext);
-		archive = MpqArchive::Open(mpqAbsPath.c_str(), error);
+		archive = MpqArchive::Open(mpqAbsPath.c_str(), error, /*memoryMap=*/true);
 		if (archive.has_value()) {
 			LogVerbose("  Found: {} in {}", mpqName, path);
 			auto [it, inserted] = MpqArchives.emplace(priority, *std::move(archive));
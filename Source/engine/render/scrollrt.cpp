@@ -1372,6 +1372,20 @@ void DrawFPS(const Surface &out)
 	DrawString(out, formatted, Point { 8, 68 }, { .flags = UiFlags::ColorRed });
 }
 
+/**
+ * @brief Display the turn pacing state below the FPS counter in multiplayer games
+ */
+void DrawNetworkInfo(const Surface &out)
+{
+	if (!frameflag || !gbActive || !gbIsMultiplayer) {
+		return;
+	}
+
+	const TurnPacingInfo pacing = nthread_get_turn_pacing();
+	const std::string info = StrCat(pacing.latency, " ms, ", pacing.turnsInTransit, " turns, ", pacing.stallsPerMinute, " stalls/min");
+	DrawString(out, info, Point { 8, 86 }, { .flags = UiFlags::ColorRed });
+}
+
 /**
  * @brief Update part of the screen from the back buffer
  */
@@ -1792,6 +1806,7 @@ void DrawAndBlit()
 	DrawCursor(out);
 
 	DrawFPS(out);
+	DrawNetworkInfo(out);
 
 	LuaEvent("GameDrawComplete");
 
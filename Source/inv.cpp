@@ -1604,7 +1604,7 @@ void CheckInvSwap(Player &player, const Item &item, int invGridIndex)
 		}
 	}
 
-	CalcPlrInv(player, true);
+	CalcPlrInv(player, true, PlayerStatGroup::Carried);
 }
 
 void CheckInvRemove(Player &player, int invGridIndex)
@@ -2050,7 +2050,7 @@ void ConsumeStaffCharge(Player &player)
 		return;
 
 	staff._iCharges--;
-	CalcPlrInv(player, false);
+	CalcPlrInv(player, false, PlayerStatGroup::ItemBonuses);
 }
 
 bool CanUseStaff(Player &player, SpellID spellId)
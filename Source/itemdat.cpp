@@ -6,6 +6,8 @@
 
 #include "itemdat.h"
 
+#include <array>
+#include <bit>
 #include <string_view>
 #include <vector>
 
@@ -44,6 +46,21 @@ std::vector<PLStruct> ItemSuffixes;
 
 namespace {
 
+/** Number of single-bit AffixItemType values. */
+constexpr size_t AffixItemTypeCount = 6;
+
+/** Prefixes that can roll on each item type, indexed by the bit of the AffixItemType. */
+std::array<std::vector<AffixCandidate>, AffixItemTypeCount> PrefixCandidates;
+
+/** Suffixes that can roll on each item type, indexed by the bit of the AffixItemType. */
+std::array<std::vector<AffixCandidate>, AffixItemTypeCount> SuffixCandidates;
+
+/** Indices into UniqueItems, grouped by unique_base_item. */
+std::vector<std::vector<int32_t>> UniqueItemsByBase;
+
+/** Bumped whenever any of the item tables change. */
+uint32_t ItemDataGeneration;
+
 tl::expected<item_class, std::string> ParseItemClass(std::string_view value)
 {
 	if (value == "None") return ICLASS_NONE;
@@ -558,6 +575,7 @@ tl::expected<goodorevil, std::string> ParseAffixAlignment(std::string_view value
 void LoadItemDatFromFile(DataFile &dataFile, std::string_view filename, int32_t baseMappingId)
 {
 	dataFile.skipHeaderOrDie(filename);
+	++ItemDataGeneration;
 
 	int32_t currentMappingId = baseMappingId;
 	AllItemsList.reserve(AllItemsList.size() + dataFile.numRecords());
@@ -626,6 +644,7 @@ void ReadItemPower(RecordReader &reader, std::string_view fieldName, ItemPower &
 void LoadUniqueItemDatFromFile(DataFile &dataFile, std::string_view filename, int32_t baseMappingId)
 {
 	dataFile.skipHeaderOrDie(filename);
+	++ItemDataGeneration;
 
 	int32_t currentMappingId = baseMappingId;
 	UniqueItems.reserve(UniqueItems.size() + dataFile.numRecords());
@@ -652,6 +671,13 @@ void LoadUniqueItemDatFromFile(DataFile &dataFile, std::string_view filename, in
 			DisplayFatalErrorAndExit("Adding Unique Item Failed", fmt::format("A unique item already exists for mapping ID {}.", item.mappingId));
 		}
 
+		if (item.UIItemId >= 0) {
+			const auto base = static_cast<size_t>(item.UIItemId);
+			if (UniqueItemsByBase.size() <= base)
+				UniqueItemsByBase.resize(base + 1);
+			UniqueItemsByBase[base].push_back(static_cast<int32_t>(UniqueItems.size()) - 1);
+		}
+
 		++currentMappingId;
 	}
 	UniqueItems.shrink_to_fit();
@@ -666,6 +692,7 @@ void LoadUniqueItemDat()
 
 	UniqueItems.clear();
 	UniqueItemMappingIdsToIndices.clear();
+	UniqueItemsByBase.clear();
 	LoadUniqueItemDatFromFile(dataFile, filename, 0);
 
 	LuaEvent("UniqueItemDataLoaded");
@@ -695,6 +722,21 @@ void LoadItemAffixesDat(std::string_view filename, std::vector<PLStruct> &out)
 	out.shrink_to_fit();
 }
 
+void BuildAffixCandidates(const std::vector<PLStruct> &affixList, std::array<std::vector<AffixCandidate>, AffixItemTypeCount> &out)
+{
+	for (size_t bit = 0; bit < AffixItemTypeCount; bit++) {
+		const auto type = static_cast<AffixItemType>(1 << bit);
+		std::vector<AffixCandidate> &candidates = out[bit];
+		candidates.clear();
+		for (const PLStruct &affix : affixList) {
+			if (!HasAnyOf(type, affix.PLIType))
+				continue;
+			candidates.push_back({ &affix, affix.PLMinLvl, affix.PLGOE, affix.PLChance, affix.PLOk, affix.power.type == IPL_CHARGES });
+		}
+		candidates.shrink_to_fit();
+	}
+}
+
 } // namespace
 
 void LoadItemData()
@@ -703,6 +745,32 @@ void LoadItemData()
 	LoadUniqueItemDat();
 	LoadItemAffixesDat("txtdata\\items\\item_prefixes.tsv", ItemPrefixes);
 	LoadItemAffixesDat("txtdata\\items\\item_suffixes.tsv", ItemSuffixes);
+	BuildAffixCandidates(ItemPrefixes, PrefixCandidates);
+	BuildAffixCandidates(ItemSuffixes, SuffixCandidates);
+	++ItemDataGeneration;
+}
+
+uint32_t GetItemDataGeneration()
+{
+	// Staves, books and scrolls take their spell, level and price from the spell table
+	return ItemDataGeneration + GetSpellDataGeneration();
+}
+
+std::span<const AffixCandidate> GetAffixCandidates(const std::vector<PLStruct> &affixList, AffixItemType type)
+{
+	const auto flags = static_cast<unsigned>(type);
+	if (!std::has_single_bit(flags))
+		return {};
+	const auto &table = &affixList == &ItemSuffixes ? SuffixCandidates : PrefixCandidates;
+	return table[std::countr_zero(flags)];
+}
+
+std::span<const int32_t> GetUniqueItemsForBase(unique_base_item baseItemId)
+{
+	const auto base = static_cast<size_t>(baseItemId);
+	if (baseItemId < 0 || base >= UniqueItemsByBase.size())
+		return {};
+	return UniqueItemsByBase[base];
 }
 
 std::string_view ItemTypeToString(ItemType itemType)
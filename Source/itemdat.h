@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -636,6 +637,16 @@ struct PLStruct {
 	int multVal;
 };
 
+/** @brief The fields of a PLStruct that SelectAffix filters on, copied into a compact per item type table. */
+struct AffixCandidate {
+	const PLStruct *affix;
+	int8_t minLvl;
+	goodorevil goe;
+	uint8_t chance;
+	bool useful;
+	bool isCharges;
+};
+
 struct UniqueItem {
 	std::string UIName;
 	enum item_cursor_graphic UICurs;
@@ -658,4 +669,17 @@ void LoadItemDatFromFile(DataFile &dataFile, std::string_view filename, int32_t
 void LoadUniqueItemDatFromFile(DataFile &dataFile, std::string_view filename, int32_t baseMappingId);
 void LoadItemData();
 
+/**
+ * @brief Returns the affixes that can roll on the given item type, in data file order.
+ * @param affixList ItemPrefixes or ItemSuffixes
+ * @param type A single AffixItemType flag
+ */
+std::span<const AffixCandidate> GetAffixCandidates(const std::vector<PLStruct> &affixList, AffixItemType type);
+
+/** @brief Returns the indices into UniqueItems of the uniques using the given base item, in ascending order. */
+std::span<const int32_t> GetUniqueItemsForBase(unique_base_item baseItemId);
+
+/** @brief Returns a counter that changes whenever item, unique, affix or spell data is (re)loaded, for invalidating caches of generated items. */
+uint32_t GetItemDataGeneration();
+
 } // namespace devilution
@@ -12,9 +12,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -81,7 +84,6 @@
 #include "utils/log.hpp"
 #include "utils/math.h"
 #include "utils/sdl_geometry.h"
-#include "utils/static_vector.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
 #include "utils/string_or_view.hpp"
@@ -1063,29 +1065,41 @@ std::optional<const PLStruct *> SelectAffix(
     goodorevil goe,
     bool excludeChargesForStaffs)
 {
-	StaticVector<const PLStruct *, 256> eligibleAffixes;
+	const std::span<const AffixCandidate> candidates = GetAffixCandidates(affixList, type);
+	const bool excludeCharges = excludeChargesForStaffs && type == AffixItemType::Staff;
 
-	for (const PLStruct &affix : affixList) {
-		if (!HasAnyOf(type, affix.PLIType))
-			continue;
-		if (affix.PLMinLvl < minlvl || affix.PLMinLvl > maxlvl)
-			continue;
-		if (onlygood && !affix.PLOk)
-			continue;
-		if ((goe == GOE_GOOD && affix.PLGOE == GOE_EVIL) || (goe == GOE_EVIL && affix.PLGOE == GOE_GOOD))
-			continue;
-		if (excludeChargesForStaffs && type == AffixItemType::Staff && affix.power.type == IPL_CHARGES)
-			continue;
+	const auto isEligible = [&](const AffixCandidate &candidate) {
+		if (candidate.minLvl < minlvl || candidate.minLvl > maxlvl)
+			return false;
+		if (onlygood && !candidate.useful)
+			return false;
+		if ((goe == GOE_GOOD && candidate.goe == GOE_EVIL) || (goe == GOE_EVIL && candidate.goe == GOE_GOOD))
+			return false;
+		if (excludeCharges && candidate.isCharges)
+			return false;
+		return true;
+	};
 
-		for (int i = 0; i < affix.PLChance; ++i) {
-			eligibleAffixes.push_back(&affix);
-		}
+	// Equivalent to picking from a list that holds each eligible affix PLChance times, without building the list.
+	int totalChance = 0;
+	for (const AffixCandidate &candidate : candidates) {
+		if (isEligible(candidate))
+			totalChance += candidate.chance;
 	}
 
-	if (eligibleAffixes.empty())
+	if (totalChance == 0)
 		return std::nullopt;
 
-	return eligibleAffixes[GenerateRnd(static_cast<int>(eligibleAffixes.size()))];
+	int roll = GenerateRnd(totalChance);
+	for (const AffixCandidate &candidate : candidates) {
+		if (!isEligible(candidate))
+			continue;
+		if (roll < candidate.chance)
+			return candidate.affix;
+		roll -= candidate.chance;
+	}
+
+	return std::nullopt;
 }
 
 std::optional<const PLStruct *> GetStaffPrefix(int maxlvl, bool onlygood)
@@ -1414,12 +1428,10 @@ _item_indexes RndTypeItems(ItemType itemType, int imid, int lvl)
 std::vector<uint8_t> GetValidUniques(int lvl, unique_base_item baseItemId)
 {
 	std::vector<uint8_t> validUniques;
-	int index = 0;
-	for (const UniqueItem &itemData : UniqueItems) {
-		if (itemData.UIItemId == baseItemId && lvl >= itemData.UIMinLvl) {
-			validUniques.push_back(index);
+	for (const int32_t index : GetUniqueItemsForBase(baseItemId)) {
+		if (lvl >= UniqueItems[index].UIMinLvl) {
+			validUniques.push_back(static_cast<uint8_t>(index));
 		}
-		index++;
 	}
 	return validUniques;
 }
@@ -1429,19 +1441,29 @@ _unique_items CheckUnique(Item &item, int lvl, int uper, int uidOffset = 0)
 	if (GenerateRnd(100) > uper)
 		return UITEM_INVALID;
 
-	auto validUniques = GetValidUniques(lvl, AllItemsList[item.IDidx].iItemId);
+	const std::span<const int32_t> candidates = GetUniqueItemsForBase(AllItemsList[item.IDidx].iItemId);
+	const auto isValid = [lvl](int32_t index) { return lvl >= UniqueItems[index].UIMinLvl; };
 
-	if (validUniques.empty())
+	const auto validCount = static_cast<size_t>(std::count_if(candidates.begin(), candidates.end(), isValid));
+	if (validCount == 0)
 		return UITEM_INVALID;
 
 	DiscardRandomValues(1);
 
 	// Check if uidOffset is out of bounds
-	if (static_cast<size_t>(uidOffset) >= validUniques.size()) {
+	if (static_cast<size_t>(uidOffset) >= validCount) {
 		return UITEM_INVALID;
 	}
 
-	const uint8_t selectedUniqueIndex = validUniques[validUniques.size() - 1 - uidOffset];
+	// Counting back from the last valid unique, as GetValidUniques lists them in ascending order.
+	uint8_t selectedUniqueIndex = 0;
+	int remaining = uidOffset;
+	for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+		if (isValid(*it) && remaining-- == 0) {
+			selectedUniqueIndex = static_cast<uint8_t>(*it);
+			break;
+		}
+	}
 
 	return static_cast<_unique_items>(selectedUniqueIndex);
 }
@@ -2875,20 +2897,40 @@ void CalcPlrItemVals(Player &player, bool loadgfx)
 	RedrawComponent(PanelDrawComponent::Health);
 }
 
-void CalcPlrInv(Player &player, bool loadgfx)
+namespace {
+
+uint8_t GetEquipmentStatFlags(const Player &player)
 {
-	// Determine the players current stats, this updates the statFlag on all equipped items that became unusable after
-	//  a change in equipment.
-	CalcSelfItems(player);
+	uint8_t statFlags = 0;
+	for (size_t i = 0; i < NUM_INVLOC; i++) {
+		if (player.InvBody[i]._iStatFlag)
+			statFlags |= 1 << i;
+	}
+	return statFlags;
+}
 
-	// Determine the current item bonuses gained from usable equipped items
-	if (&player != MyPlayer && !player.isOnActiveLevel()) {
-		// Ensure we don't load graphics for players that aren't on our level
-		loadgfx = false;
+void UpdateStaleStatGroups(Player &player, bool loadgfx)
+{
+	if (HasAnyOf(player.staleStatGroups, PlayerStatGroup::Equipment)) {
+		// Determine the players current stats, this updates the statFlag on all equipped items that became unusable after
+		//  a change in equipment.
+		const uint8_t oldStatFlags = GetEquipmentStatFlags(player);
+		CalcSelfItems(player);
+		if (GetEquipmentStatFlags(player) != oldStatFlags)
+			player.staleStatGroups |= PlayerStatGroup::ItemBonuses;
 	}
-	CalcPlrItemVals(player, loadgfx);
 
-	if (&player == MyPlayer) {
+	if (HasAnyOf(player.staleStatGroups, PlayerStatGroup::ItemBonuses)) {
+		// Determine the current item bonuses gained from usable equipped items
+		const int oldStrength = player._pStrength;
+		const int oldMagic = player._pMagic;
+		const int oldDexterity = player._pDexterity;
+		CalcPlrItemVals(player, loadgfx);
+		if (player._pStrength != oldStrength || player._pMagic != oldMagic || player._pDexterity != oldDexterity)
+			player.staleStatGroups |= PlayerStatGroup::Carried;
+	}
+
+	if (&player == MyPlayer && HasAnyOf(player.staleStatGroups, PlayerStatGroup::Carried)) {
 		// Now that stat gains from equipped items have been calculated, mark unusable scrolls etc
 		for (Item &item : InventoryAndBeltPlayerItemsRange { player }) {
 			item.updateRequiredStatsCacheForPlayer(player);
@@ -2899,6 +2941,69 @@ void CalcPlrInv(Player &player, bool loadgfx)
 			Stash.RefreshItemStatFlags();
 		}
 	}
+
+	player.staleStatGroups = PlayerStatGroup::None;
+}
+
+#ifdef _DEBUG
+uint64_t GetCarriedStatFlags(const Player &player)
+{
+	uint64_t statFlags = 0;
+	if (&player != MyPlayer)
+		return statFlags;
+
+	int i = 0;
+	for (const Item &item : InventoryAndBeltPlayerItemsRange { player }) {
+		if (item._iStatFlag)
+			statFlags |= uint64_t { 1 } << (i % 64);
+		i++;
+	}
+	return statFlags;
+}
+
+/** @brief Returns everything CalcPlrInv derives, used to compare partial updates against a full recompute. */
+auto GetDerivedPlayerStats(const Player &player)
+{
+	return std::make_tuple(
+	    player._pStrength, player._pMagic, player._pDexterity, player._pVitality,
+	    player._pIMinDam, player._pIMaxDam, player._pDamageMod, player._pIBonusDam, player._pIBonusDamMod, player._pIBonusToHit,
+	    player._pIAC, player._pIBonusAC, player._pIEnAc, player._pIGetHit, player._pIFlags, player.pDamAcFlags,
+	    player._pMagResist, player._pFireResist, player._pLghtResist, player._pLightRad,
+	    player._pMaxHP, player._pHitPoints, player._pMaxMana, player._pMana,
+	    player._pIFMinDam, player._pIFMaxDam, player._pILMinDam, player._pILMaxDam,
+	    player._pISpells, player._pScrlSpells, player._pISplLvlAdd, player._pRSpell, player._pRSplType,
+	    player._pBlockFlag, player._pgfxnum, GetEquipmentStatFlags(player), GetCarriedStatFlags(player));
+}
+
+/**
+ * @brief Recomputes every stat group and reports any difference to the result of the partial update.
+ */
+void CheckDerivedPlayerStats(Player &player)
+{
+	const auto cached = GetDerivedPlayerStats(player);
+	player.staleStatGroups = PlayerStatGroup::All;
+	UpdateStaleStatGroups(player, false);
+	if (GetDerivedPlayerStats(player) != cached)
+		LogError("Derived stats of player {} were stale after a partial CalcPlrInv update", player._pName);
+}
+#endif
+
+} // namespace
+
+void CalcPlrInv(Player &player, bool loadgfx, PlayerStatGroup changed)
+{
+	player.staleStatGroups |= changed;
+
+	if (&player != MyPlayer && !player.isOnActiveLevel()) {
+		// Ensure we don't load graphics for players that aren't on our level
+		loadgfx = false;
+	}
+	UpdateStaleStatGroups(player, loadgfx);
+
+#ifdef _DEBUG
+	if (changed != PlayerStatGroup::All)
+		CheckDerivedPlayerStats(player);
+#endif
 }
 
 void InitializeItem(Item &item, _item_indexes itemData)
@@ -3489,6 +3594,88 @@ void CreateTypeItem(Point position, bool onlygood, ItemType itemType, int imisc,
 	SetupBaseItem(position, idx, onlygood, sendmsg, delta, spawn);
 }
 
+namespace {
+
+/** Number of slots in the RecreateItem cache, must be a power of two. */
+constexpr size_t RecreateItemCacheSize = 1024;
+
+struct RecreateItemKey {
+	uint32_t seed;
+	uint32_t dwBuff;
+	uint16_t createInfo;
+	int16_t idx;
+	/** Game mode flags the generation reads besides CF_HELLFIRE */
+	uint8_t gameMode;
+
+	bool operator==(const RecreateItemKey &) const = default;
+};
+
+struct RecreateItemCacheEntry {
+	RecreateItemKey key;
+	bool valid;
+	/** LCG state generating the item left behind, restored on a hit so later rolls don't change. */
+	uint32_t rngState;
+	/** The item before SetupItem, which depends on the local player's level loading state. */
+	Item item;
+};
+
+/** Direct-mapped, so a colliding item simply replaces the previous one. */
+std::unique_ptr<RecreateItemCacheEntry[]> RecreateItemCache;
+uint32_t RecreateItemCacheGeneration;
+RecreateItemCacheStats RecreateItemStats;
+
+size_t GetRecreateItemCacheSlot(const RecreateItemKey &key)
+{
+	uint32_t hash = key.seed * 0x9E3779B1U;
+	hash ^= (key.createInfo | (static_cast<uint32_t>(static_cast<uint16_t>(key.idx)) << 16)) * 0x85EBCA77U;
+	hash ^= (key.dwBuff ^ key.gameMode) * 0xC2B2AE3DU;
+	hash ^= hash >> 15;
+	return hash & (RecreateItemCacheSize - 1);
+}
+
+RecreateItemCacheEntry &GetRecreateItemCacheEntry(const RecreateItemKey &key)
+{
+	if (RecreateItemCache == nullptr)
+		RecreateItemCache = std::make_unique<RecreateItemCacheEntry[]>(RecreateItemCacheSize);
+	if (RecreateItemCacheGeneration != GetItemDataGeneration()) {
+		ClearRecreateItemCache();
+		RecreateItemCacheGeneration = GetItemDataGeneration();
+	}
+	return RecreateItemCache[GetRecreateItemCacheSlot(key)];
+}
+
+/** @brief Mana to life and life to mana read the player's base stats, so those items can't be reused for another player. */
+bool DependsOnPlayerStats(const Item &item)
+{
+	const auto readsStats = [](item_effect_type type) {
+		return IsAnyOf(type, IPL_MANATOLIFE, IPL_LIFETOMANA);
+	};
+	if (item._iMagical == ITEM_QUALITY_UNIQUE) {
+		for (const ItemPower &power : UniqueItems[item._iUid].powers) {
+			if (readsStats(power.type))
+				return true;
+		}
+		return false;
+	}
+	return readsStats(item._iPrePower) || readsStats(item._iSufPower);
+}
+
+} // namespace
+
+RecreateItemCacheStats GetRecreateItemCacheStats()
+{
+	return RecreateItemStats;
+}
+
+void ClearRecreateItemCache()
+{
+	if (RecreateItemCache != nullptr) {
+		for (size_t i = 0; i < RecreateItemCacheSize; i++)
+			RecreateItemCache[i].valid = false;
+	}
+	RecreateItemStats = {};
+}
+
 void RecreateItem(const Player &player, Item &item, _item_indexes idx, uint16_t icreateinfo, uint32_t iseed, int ivalue, uint32_t dwBuff)
 {
 	const bool tmpIsHellfire = gbIsHellfire;
@@ -3539,7 +3726,28 @@ void RecreateItem(const Player &player, Item &item, _item_indexes idx, uint16_t
 	const bool pregen = (icreateinfo & CF_PREGEN) != 0;
 	auto uidOffset = static_cast<int>((item.dwBuff & CF_UIDOFFSET) >> 1);
 
-	SetupAllItems(player, item, idx, iseed, level, uper, onlygood, pregen, uidOffset, forceNotUnique);
+	const RecreateItemKey key {
+		iseed,
+		dwBuff,
+		icreateinfo,
+		static_cast<int16_t>(idx),
+		static_cast<uint8_t>((gbIsMultiplayer ? 1 : 0) | (gbIsSpawn ? 2 : 0)),
+	};
+	RecreateItemCacheEntry &entry = GetRecreateItemCacheEntry(key);
+	if (entry.valid && entry.key == key) {
+		RecreateItemStats.hits++;
+		item = entry.item;
+		SetRndSeed(entry.rngState);
+	} else {
+		RecreateItemStats.misses++;
+		SetupAllItems(player, item, idx, iseed, level, uper, onlygood, pregen, uidOffset, forceNotUnique);
+		if (!DependsOnPlayerStats(item)) {
+			entry.key = key;
+			entry.valid = true;
+			entry.rngState = GetLCGEngineState();
+			entry.item = item;
+		}
+	}
 	SetupItem(item);
 	gbIsHellfire = tmpIsHellfire;
 }
@@ -16,6 +16,8 @@
 #include "itemdat.h"
 #include "levels/dun_tile.hpp"
 #include "monster.h"
+#include "utils/attributes.h"
+#include "utils/enum_traits.h"
 #include "utils/is_of.hpp"
 #include "utils/string_or_view.hpp"
 
@@ -179,6 +181,24 @@ enum icreateinfo_flag2 {
 	// clang-format on
 };
 
+/**
+ * @brief Groups of derived player stats that CalcPlrInv recomputes independently of each other.
+ *
+ * A group is only recomputed when it is marked as changed. Recomputing a group marks the groups that depend on it
+ * whenever its results actually differ, so callers only need to name the group their change affects directly.
+ */
+enum class PlayerStatGroup : uint8_t {
+	None = 0,
+	/** @brief Which equipped items are usable (_iStatFlag), depends on the equipped items and base attributes */
+	Equipment = 1 << 0,
+	/** @brief Bonuses from usable equipped items and everything derived from them, also depends on level, rage, life and mana */
+	ItemBonuses = 1 << 1,
+	/** @brief Requirement flags of inventory, belt and stash items and the scroll spells, depends on the final attributes and spell levels */
+	Carried = 1 << 2,
+	All = Equipment | ItemBonuses | Carried,
+};
+use_enum_as_flags(PlayerStatGroup);
+
 // All item animation frames have this width.
 constexpr int ItemAnimWidth = 96;
 
@@ -483,11 +503,11 @@ struct CornerStoneStruct {
 };
 
 /** Contains the items on ground in the current game. */
-extern Item Items[MAXITEMS + 1];
+extern DVL_API_FOR_TEST Item Items[MAXITEMS + 1];
 extern uint8_t ActiveItems[MAXITEMS];
-extern uint8_t ActiveItemCount;
+extern DVL_API_FOR_TEST uint8_t ActiveItemCount;
 /** Contains the location of dropped items. */
-extern int8_t dItem[MAXDUNX][MAXDUNY];
+extern DVL_API_FOR_TEST int8_t dItem[MAXDUNX][MAXDUNY];
 extern bool ShowUniqueItemInfoBox;
 extern CornerStoneStruct CornerStone;
 extern DVL_API_FOR_TEST bool UniqueItemFlags[128];
@@ -498,7 +518,13 @@ void ClearUniqueItemFlags();
 void InitItemGFX();
 void InitItems();
 void CalcPlrItemVals(Player &player, bool Loadgfx);
-void CalcPlrInv(Player &player, bool Loadgfx);
+/**
+ * @brief Updates the derived stats of the player after something affecting them changed
+ * @param player The player to update
+ * @param Loadgfx Reload the player graphics if the equipped weapon or armor type changed
+ * @param changed Stat groups affected by the change, in addition to groups already marked as stale on the player
+ */
+void CalcPlrInv(Player &player, bool Loadgfx, PlayerStatGroup changed = PlayerStatGroup::All);
 void InitializeItem(Item &item, _item_indexes itemData);
 void GenerateNewSeed(Item &item);
 int GetGoldCursor(int value);
@@ -530,7 +556,22 @@ void SpawnItem(Monster &monster, Point position, bool sendmsg, bool spawn = fals
 void CreateRndItem(Point position, bool onlygood, bool sendmsg, bool delta);
 void CreateRndUseful(Point position, bool sendmsg);
 void CreateTypeItem(Point position, bool onlygood, ItemType itemType, int imisc, bool sendmsg, bool delta, bool spawn = false);
+/**
+ * @brief Regenerates an item from the values it was packed with.
+ *
+ * Dungeon items are served from a bounded cache when the same packed values were recreated before,
+ * so `item` is expected to be default-initialized.
+ */
 void RecreateItem(const Player &player, Item &item, _item_indexes idx, uint16_t icreateinfo, uint32_t iseed, int ivalue, uint32_t dwBuff);
+
+struct RecreateItemCacheStats {
+	uint32_t hits;
+	uint32_t misses;
+};
+
+/** @brief Returns how many RecreateItem calls were served from the cache since it was last cleared. */
+RecreateItemCacheStats GetRecreateItemCacheStats();
+void ClearRecreateItemCache();
 void RecreateEar(Item &item, uint16_t ic, uint32_t iseed, uint8_t bCursval, std::string_view heroName);
 void CornerstoneSave();
 void CornerstoneLoad(Point position);
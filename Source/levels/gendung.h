@@ -135,7 +135,7 @@ extern WorldTilePosition dmaxPosition;
 extern DVL_API_FOR_TEST dungeon_type leveltype;
 /** Specifies the active dungeon level of the current game. */
 extern DVL_API_FOR_TEST uint8_t currlevel;
-extern bool setlevel;
+extern DVL_API_FOR_TEST bool setlevel;
 /** Specifies the active quest level of the current game. */
 extern _setlevels setlvlnum;
 /** Specifies the dungeon type of the active quest level of the current game. */
@@ -157,7 +157,7 @@ extern DVL_API_FOR_TEST uint8_t dLight[MAXDUNX][MAXDUNY];
 /** Precalculated static lights. dLight uses this as a base before applying lights. Per tile. */
 extern uint8_t dPreLight[MAXDUNX][MAXDUNY];
 /** Holds various information about dungeon tiles, @see DungeonFlag */
-extern DungeonFlag dFlags[MAXDUNX][MAXDUNY];
+extern DVL_API_FOR_TEST DungeonFlag dFlags[MAXDUNX][MAXDUNY];
 /** Contains the player numbers (players array indices) of the map. negative id indicates player moving. */
 extern int8_t dPlayer[MAXDUNX][MAXDUNY];
 /**
@@ -166,7 +166,7 @@ extern int8_t dPlayer[MAXDUNX][MAXDUNY];
  * (monsters array index) in the dungeon.
  * Negative id indicates monsters moving.
  */
-extern int16_t dMonster[MAXDUNX][MAXDUNY];
+extern DVL_API_FOR_TEST int16_t dMonster[MAXDUNX][MAXDUNY];
 /**
  * Contains the dead numbers (deads array indices) and dead direction of
  * the map, encoded as specified by the pseudo-code below.
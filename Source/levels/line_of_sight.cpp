@@ -0,0 +1,181 @@
+#include "levels/line_of_sight.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "levels/gendung.h"
+
+namespace devilution {
+
+namespace {
+
+using BitRow = std::array<uint64_t, 2>;
+static_assert(MAXDUNX <= 128 && MAXDUNY <= 128, "A row of the dungeon must fit into a BitRow");
+
+/**
+ * @brief Blocking tiles stored both by row and by column, so the tiles a line passes
+ * through along its major axis are always consecutive bits of a single BitRow.
+ */
+struct BlockingMask {
+	/** Bit x of rows[y] is set if tile (x, y) blocks. */
+	std::array<BitRow, MAXDUNY> rows;
+	/** Bit y of columns[x] is set if tile (x, y) blocks. */
+	std::array<BitRow, MAXDUNX> columns;
+
+	void build(TileProperties property)
+	{
+		rows = {};
+		columns = {};
+		for (int x = 0; x < MAXDUNX; x++) {
+			for (int y = 0; y < MAXDUNY; y++) {
+				if (!TileHasAny({ x, y }, property))
+					continue;
+				rows[y][x / 64] |= uint64_t { 1 } << (x % 64);
+				columns[x][y / 64] |= uint64_t { 1 } << (y % 64);
+			}
+		}
+	}
+};
+
+BlockingMask MissileMask;
+BlockingMask SolidMask;
+bool MasksStale = true;
+
+void RebuildIfStale()
+{
+	if (!MasksStale)
+		return;
+	MissileMask.build(TileProperties::BlockMissile);
+	SolidMask.build(TileProperties::Solid);
+	MasksStale = false;
+}
+
+/** @brief Checks if any of the bits first to last (inclusive) are set. */
+bool AnyInRange(const BitRow &bits, int first, int last)
+{
+	for (int word = first / 64; word <= last / 64; word++) {
+		const int low = std::max(first, word * 64) - word * 64;
+		const int high = std::min(last, word * 64 + 63) - word * 64;
+		const uint64_t mask = (~uint64_t { 0 } >> (63 - high)) & (~uint64_t { 0 } << low);
+		if ((bits[word] & mask) != 0)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Walks the same tiles as LineClear, but tests each run of tiles sharing a row (or column) at once.
+ *
+ * LineClear never checks the start point and ignores whether the end point blocks, so only the tiles strictly
+ * between the two are tested.
+ */
+bool IsLineClear(const BlockingMask &mask, Point startPoint, Point endPoint)
+{
+	assert(InDungeonBounds(startPoint) && InDungeonBounds(endPoint));
+	RebuildIfStale();
+
+	Point position = startPoint;
+
+	int dx = endPoint.x - position.x;
+	int dy = endPoint.y - position.y;
+	if (std::abs(dx) > std::abs(dy)) {
+		if (dx < 0) {
+			std::swap(position, endPoint);
+			dx = -dx;
+			dy = -dy;
+		}
+		int d;
+		int yincD;
+		int dincD;
+		int dincH;
+		if (dy > 0) {
+			d = 2 * dy - dx;
+			dincD = 2 * dy;
+			dincH = 2 * (dy - dx);
+			yincD = 1;
+		} else {
+			d = 2 * dy + dx;
+			dincD = 2 * dy;
+			dincH = 2 * (dx + dy);
+			yincD = -1;
+		}
+		int runStart = position.x + 1;
+		for (int step = 1; step < dx; step++) {
+			const int previousY = position.y;
+			if ((d <= 0) ^ (yincD < 0)) {
+				d += dincD;
+			} else {
+				d += dincH;
+				position.y += yincD;
+			}
+			position.x++;
+			if (position.y != previousY) {
+				if (position.x > runStart && AnyInRange(mask.rows[previousY], runStart, position.x - 1))
+					return false;
+				runStart = position.x;
+			}
+		}
+		return position.x < runStart || !AnyInRange(mask.rows[position.y], runStart, position.x);
+	}
+
+	if (dy < 0) {
+		std::swap(position, endPoint);
+		dy = -dy;
+		dx = -dx;
+	}
+	int d;
+	int xincD;
+	int dincD;
+	int dincH;
+	if (dx > 0) {
+		d = 2 * dx - dy;
+		dincD = 2 * dx;
+		dincH = 2 * (dx - dy);
+		xincD = 1;
+	} else {
+		d = 2 * dx + dy;
+		dincD = 2 * dx;
+		dincH = 2 * (dy + dx);
+		xincD = -1;
+	}
+	int runStart = position.y + 1;
+	for (int step = 1; step < dy; step++) {
+		const int previousX = position.x;
+		if ((d <= 0) ^ (xincD < 0)) {
+			d += dincD;
+		} else {
+			d += dincH;
+			position.x += xincD;
+		}
+		position.y++;
+		if (position.x != previousX) {
+			if (position.y > runStart && AnyInRange(mask.columns[previousX], runStart, position.y - 1))
+				return false;
+			runStart = position.y;
+		}
+	}
+	return position.y < runStart || !AnyInRange(mask.columns[position.x], runStart, position.y);
+}
+
+} // namespace
+
+void InvalidateLineOfSight()
+{
+	MasksStale = true;
+}
+
+bool IsMissileLineClear(Point startPoint, Point endPoint)
+{
+	return IsLineClear(MissileMask, startPoint, endPoint);
+}
+
+bool IsSolidLineClear(Point startPoint, Point endPoint)
+{
+	return IsLineClear(SolidMask, startPoint, endPoint);
+}
+
+} // namespace devilution
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "engine/point.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Marks the cached masks of blocking tiles as stale.
+ *
+ * The masks are rebuilt on the next query. Game code does not call this directly, CompileTileBitboards(),
+ * ClearTileBitboards() and InvalidateTileBitboards() forward to it.
+ */
+void InvalidateLineOfSight();
+
+/**
+ * @brief Returns the same result as LineClear(PosOkMissile, startPoint, endPoint), without stepping through predicates.
+ *
+ * Both points must be inside the dungeon.
+ */
+[[nodiscard]] bool IsMissileLineClear(Point startPoint, Point endPoint);
+
+/**
+ * @brief Returns the same result as LineClear(IsTileNotSolid, startPoint, endPoint), without stepping through predicates.
+ *
+ * Both points must be inside the dungeon.
+ */
+[[nodiscard]] bool IsSolidLineClear(Point startPoint, Point endPoint);
+
+} // namespace devilution
@@ -4,16 +4,90 @@
 #include "engine/path.h"
 #include "engine/point.hpp"
 #include "gendung.h"
+#include "levels/line_of_sight.hpp"
 #include "objects.h"
+#include "utils/bitset2d.hpp"
 
 namespace devilution {
 
+namespace {
+
+/** @brief The answers of the movement checks for every tile of the current level, one bit per tile. */
+struct TileBitboards {
+	Bitset2d<MAXDUNX, MAXDUNY> solid;
+	Bitset2d<MAXDUNX, MAXDUNY> blockMissile;
+	/** Not solid and not blocked by a solid object */
+	Bitset2d<MAXDUNX, MAXDUNY> walkable;
+	Bitset2d<MAXDUNX, MAXDUNY> door;
+};
+
+TileBitboards Bitboards;
+bool BitboardsEnabled = false;
+bool BitboardsStale = true;
+
+void BuildTileBitboards()
+{
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			const Point position { x, y };
+			const bool solid = TileHasAny(position, TileProperties::Solid);
+			const Object *object = FindObjectAtPosition(position);
+			Bitboards.solid.set(x, y, solid);
+			Bitboards.blockMissile.set(x, y, TileHasAny(position, TileProperties::BlockMissile));
+			Bitboards.walkable.set(x, y, !solid && (object == nullptr || !object->_oSolidFlag));
+			Bitboards.door.set(x, y, object != nullptr && object->isDoor());
+		}
+	}
+	BitboardsStale = false;
+}
+
+/** @brief Returns the bitboards of the current level, or nullptr while the level arrays have to be read directly. */
+const TileBitboards *GetTileBitboards()
+{
+	if (!BitboardsEnabled)
+		return nullptr;
+	if (BitboardsStale)
+		BuildTileBitboards();
+	return &Bitboards;
+}
+
+} // namespace
+
+void CompileTileBitboards()
+{
+	BitboardsEnabled = true;
+	BuildTileBitboards();
+	InvalidateLineOfSight();
+}
+
+void ClearTileBitboards()
+{
+	BitboardsEnabled = false;
+	BitboardsStale = true;
+	InvalidateLineOfSight();
+}
+
+void InvalidateTileBitboards()
+{
+	BitboardsStale = true;
+	InvalidateLineOfSight();
+}
+
+void RefreshTileBitboards()
+{
+	GetTileBitboards();
+}
+
 bool IsTileNotSolid(Point position)
 {
 	if (!InDungeonBounds(position)) {
 		return false;
 	}
 
+	const TileBitboards *bitboards = GetTileBitboards();
+	if (bitboards != nullptr)
+		return !bitboards->solid.test(position.x, position.y);
+
 	return !TileHasAny(position, TileProperties::Solid);
 }
 
@@ -23,11 +97,33 @@ bool IsTileSolid(Point position)
 		return false;
 	}
 
+	const TileBitboards *bitboards = GetTileBitboards();
+	if (bitboards != nullptr)
+		return bitboards->solid.test(position.x, position.y);
+
 	return TileHasAny(position, TileProperties::Solid);
 }
 
+bool IsTileBlockingMissiles(Point position)
+{
+	const TileBitboards *bitboards = GetTileBitboards();
+	if (bitboards != nullptr && InDungeonBounds(position))
+		return bitboards->blockMissile.test(position.x, position.y);
+
+	return TileHasAny(position, TileProperties::BlockMissile);
+}
+
 bool IsTileWalkable(Point position, bool ignoreDoors)
 {
+	const TileBitboards *bitboards = GetTileBitboards();
+	if (bitboards != nullptr) {
+		if (!InDungeonBounds(position))
+			return false;
+		if (ignoreDoors && bitboards->door.test(position.x, position.y))
+			return true;
+		return bitboards->walkable.test(position.x, position.y);
+	}
+
 	Object *object = FindObjectAtPosition(position);
 	if (object != nullptr) {
 		if (ignoreDoors && object->isDoor()) {
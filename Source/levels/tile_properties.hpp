@@ -4,9 +4,42 @@
 
 namespace devilution {
 
+/**
+ * @brief Builds bitboards of the tile properties used by the movement checks below and starts using them.
+ *
+ * Call once level generation is done. Until then the checks read dPiece, SOLData and dObject directly.
+ * This also marks the line of sight masks as stale, see InvalidateLineOfSight().
+ */
+void CompileTileBitboards();
+
+/**
+ * @brief Stops using the bitboards, for the time a new level is being generated.
+ */
+void ClearTileBitboards();
+
+/**
+ * @brief Marks the bitboards as stale, they are rebuilt on the next query.
+ *
+ * Call whenever dPiece, dObject or the solid flag of an object change after the level was generated.
+ * The line of sight masks are invalidated along with the bitboards.
+ */
+void InvalidateTileBitboards();
+
+/**
+ * @brief Rebuilds stale bitboards right away instead of on the next query.
+ *
+ * The checks below may then be called from several threads at once, as long as nothing invalidates the bitboards meanwhile.
+ */
+void RefreshTileBitboards();
+
 [[nodiscard]] bool IsTileNotSolid(Point position);
 [[nodiscard]] bool IsTileSolid(Point position);
 
+/**
+ * @brief Checks if the dungeon piece at the position stops missiles
+ */
+[[nodiscard]] bool IsTileBlockingMissiles(Point position);
+
 /**
  * @brief Checks the position is solid or blocked by an object
  */
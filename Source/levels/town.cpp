@@ -7,6 +7,7 @@
 #include "engine/world_tile.hpp"
 #include "game_mode.hpp"
 #include "levels/drlg_l1.h"
+#include "levels/tile_properties.hpp"
 #include "levels/trigs.h"
 #include "multi.h"
 #include "player.h"
@@ -329,6 +330,7 @@ void TownOpenHive()
 	dPiece[85][64] = 15;
 	dPiece[86][60] = 16;
 	dPiece[86][61] = 17;
+	InvalidateTileBitboards();
 }
 
 void TownOpenGrave()
@@ -346,6 +348,7 @@ void TownOpenGrave()
 	dPiece[37][24] = 0x539;
 	dPiece[35][21] = 0x53a;
 	dPiece[34][21] = 0x53b;
+	InvalidateTileBitboards();
 }
 
 void CleanTownFountain()
@@ -353,6 +356,7 @@ void CleanTownFountain()
 	if (!pMegaTiles)
 		return;
 	FillTile(60, 70, 71);
+	InvalidateTileBitboards();
 }
 
 void CreateTown(lvl_entry entry)
@@ -5,11 +5,13 @@
  */
 #include "loadsave.h"
 
+#include <cassert>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <numeric>
+#include <span>
 #include <string>
 
 #include <SDL.h>
@@ -28,6 +30,7 @@
 #include "game_mode.hpp"
 #include "inv.h"
 #include "levels/dun_tile.hpp"
+#include "levels/tile_properties.hpp"
 #include "lighting.h"
 #include "menu.h"
 #include "missiles.h"
@@ -55,6 +58,12 @@ namespace {
 constexpr size_t MaxMissilesForSaveGame = 125;
 constexpr size_t PlayerWalkPathSizeForSaveGame = 25;
 
+const int DiabloItemSaveSize = 368;
+const int HellfireItemSaveSize = 372;
+constexpr size_t MonsterSaveSize = 216;
+constexpr size_t MissileSaveSize = 176;
+constexpr size_t ObjectSaveSize = 120;
+
 uint8_t giNumberQuests;
 uint8_t giNumberOfSmithPremiumItems;
 
@@ -96,37 +105,49 @@ void TerminateUtf8(char *str, size_t maxLength)
 	str[utf8Length] = '\0';
 }
 
-class LoadHelper {
-	std::unique_ptr<std::byte[]> m_buffer_;
+/**
+ * @brief Reads fields from a decoded save file.
+ *
+ * The checked variant returns 0 for anything past the end of the data. The unchecked variant is used
+ * for records whose size was validated up front, see LoadHelper::NextRecord.
+ */
+template <bool Checked>
+class BasicLoadHelper {
+protected:
+	const std::byte *m_data_ = nullptr;
 	size_t m_cur_ = 0;
-	size_t m_size_;
+	size_t m_size_ = 0;
 
 	template <class T>
 	T Next()
 	{
 		const auto size = sizeof(T);
-		if (!IsValid(size))
-			return 0;
+		if constexpr (Checked) {
+			if (!IsValid(size))
+				return 0;
+		} else {
+			assert(m_cur_ + size <= m_size_);
+		}
 
 		T value;
-		memcpy(&value, &m_buffer_[m_cur_], size);
+		memcpy(&value, &m_data_[m_cur_], size);
 		m_cur_ += size;
 
 		return value;
 	}
 
 public:
-	LoadHelper(std::optional<SaveReader> archive, const char *szFileName)
+	BasicLoadHelper() = default;
+
+	BasicLoadHelper(const std::byte *data, size_t size)
+	    : m_data_(data)
+	    , m_size_(size)
 	{
-		if (archive)
-			m_buffer_ = ReadArchive(*archive, szFileName, &m_size_);
-		else
-			m_buffer_ = nullptr;
 	}
 
-	bool IsValid(size_t size = 1)
+	bool IsValid(size_t size = 1) const
 	{
-		return m_buffer_ != nullptr
+		return m_data_ != nullptr
 		    && m_size_ >= (m_cur_ + size);
 	}
 
@@ -148,10 +169,14 @@ public:
 
 	void NextBytes(void *bytes, size_t size)
 	{
-		if (!IsValid(size))
-			return;
+		if constexpr (Checked) {
+			if (!IsValid(size))
+				return;
+		} else {
+			assert(m_cur_ + size <= m_size_);
+		}
 
-		memcpy(bytes, &m_buffer_[m_cur_], size);
+		memcpy(bytes, &m_data_[m_cur_], size);
 		m_cur_ += size;
 	}
 
@@ -186,8 +211,68 @@ public:
 	}
 };
 
+/** @brief A fixed size record of a save file, the bounds were checked when it was taken. */
+using LoadRecord = BasicLoadHelper<false>;
+
+class LoadHelper : public BasicLoadHelper<true> {
+	std::unique_ptr<std::byte[]> m_buffer_;
+	/** @brief Zero filled copy of a record that runs past the end of the file */
+	std::unique_ptr<std::byte[]> m_padded_;
+	size_t m_paddedSize_ = 0;
+
+public:
+	LoadHelper(std::optional<SaveReader> archive, const char *szFileName)
+	{
+		if (archive) {
+			m_buffer_ = ReadArchive(*archive, szFileName, &m_size_);
+			m_data_ = m_buffer_.get();
+		}
+	}
+
+	/** @brief Reads from data that is already decoded, without taking a copy. */
+	explicit LoadHelper(std::span<const std::byte> data)
+	    : BasicLoadHelper(data.data(), data.size())
+	{
+	}
+
+	/**
+	 * @brief Returns the next `size` bytes as a record and moves past them.
+	 *
+	 * The fields of the record are read without further bounds checks. If the file ends early the
+	 * missing bytes read as 0. The record stays valid until the next call.
+	 */
+	LoadRecord NextRecord(size_t size)
+	{
+		const size_t start = m_cur_;
+		m_cur_ += size;
+		if (m_data_ != nullptr && m_size_ >= m_cur_)
+			return { &m_data_[start], size };
+
+		if (m_paddedSize_ < size) {
+			m_padded_ = std::make_unique<std::byte[]>(size);
+			m_paddedSize_ = size;
+		}
+		std::memset(m_padded_.get(), 0, size);
+		if (m_data_ != nullptr && start < m_size_)
+			memcpy(m_padded_.get(), &m_data_[start], m_size_ - start);
+		return { m_padded_.get(), size };
+	}
+};
+
+/** @brief Reads a dungeon grid, which is saved row by row, checking the bounds once for the whole grid. */
+template <class TSource, class TDesired>
+void LoadGridLE(LoadHelper &file, TDesired (&grid)[MAXDUNX][MAXDUNY])
+{
+	LoadRecord record = file.NextRecord(sizeof(TSource) * MAXDUNX * MAXDUNY);
+	for (int j = 0; j < MAXDUNY; j++) {
+		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
+			grid[i][j] = record.NextLE<TSource>();
+	}
+}
+
 class SaveHelper {
-	SaveWriter &m_mpqWriter;
+	SaveWriter *m_mpqWriter = nullptr;
+	SaveSnapshot *m_snapshot = nullptr;
 	const char *m_szFileName_;
 	std::unique_ptr<std::byte[]> m_buffer_;
 	size_t m_cur_ = 0;
@@ -195,7 +280,15 @@ class SaveHelper {
 
 public:
 	SaveHelper(SaveWriter &mpqWriter, const char *szFileName, size_t bufferLen)
-	    : m_mpqWriter(mpqWriter)
+	    : m_mpqWriter(&mpqWriter)
+	    , m_szFileName_(szFileName)
+	    , m_buffer_(new std::byte[codec_get_encoded_len(bufferLen)])
+	    , m_capacity_(bufferLen)
+	{
+	}
+
+	SaveHelper(SaveSnapshot &snapshot, const char *szFileName, size_t bufferLen)
+	    : m_snapshot(&snapshot)
 	    , m_szFileName_(szFileName)
 	    , m_buffer_(new std::byte[codec_get_encoded_len(bufferLen)])
 	    , m_capacity_(bufferLen)
@@ -245,10 +338,15 @@ public:
 
 	~SaveHelper()
 	{
+		if (m_snapshot != nullptr) {
+			// The buffer has room for the encoded data, whoever writes the snapshot encodes it in place
+			m_snapshot->files.push_back({ m_szFileName_, std::move(m_buffer_), m_cur_ });
+			return;
+		}
 		const auto encodedLen = codec_get_encoded_len(m_cur_);
 		const char *const password = pfile_get_password();
 		codec_encode(m_buffer_.get(), m_cur_, encodedLen, password);
-		m_mpqWriter.WriteFile(m_szFileName_, m_buffer_.get(), encodedLen);
+		m_mpqWriter->WriteFile(m_szFileName_, m_buffer_.get(), encodedLen);
 	}
 };
 
@@ -263,7 +361,7 @@ struct LevelConversionData {
 	MonsterConversionData monsterConversionData[MaxMonsters];
 };
 
-[[nodiscard]] bool LoadItemData(LoadHelper &file, Item &item)
+[[nodiscard]] bool LoadItemData(LoadRecord &file, Item &item)
 {
 	item._iSeed = file.NextLE<uint32_t>();
 	item._iCreateInfo = file.NextLE<uint16_t>();
@@ -377,9 +475,15 @@ struct LevelConversionData {
 	return true;
 }
 
+LoadRecord NextItemRecord(LoadHelper &file)
+{
+	return file.NextRecord(gbIsHellfireSaveGame ? HellfireItemSaveSize : DiabloItemSaveSize);
+}
+
 void LoadAndValidateItemData(LoadHelper &file, Item &item)
 {
-	const bool success = LoadItemData(file, item);
+	LoadRecord record = NextItemRecord(file);
+	const bool success = LoadItemData(record, item);
 	if (!success) {
 		item.clear();
 		return;
@@ -658,7 +762,7 @@ void LoadPlayer(LoadHelper &file, Player &player)
 
 bool gbSkipSync = false;
 
-[[nodiscard]] bool LoadMonster(LoadHelper *file, Monster &monster, MonsterConversionData *monsterConversionData = nullptr)
+[[nodiscard]] bool LoadMonster(LoadRecord *file, Monster &monster, MonsterConversionData *monsterConversionData = nullptr)
 {
 	monster.levelType = file->NextLE<int32_t>();
 	monster.mode = static_cast<MonsterMode>(file->NextLE<int32_t>());
@@ -788,7 +892,8 @@ void LoadMonsters(LoadHelper &file, ankerl::unordered_dense::set<unsigned> &remo
 		MonsterConversionData *monsterConversionData = nullptr;
 		if (levelConversionData != nullptr)
 			monsterConversionData = &levelConversionData->monsterConversionData[ActiveMonsters[i]];
-		const bool valid = LoadMonster(&file, monster, monsterConversionData);
+		LoadRecord record = file.NextRecord(MonsterSaveSize);
+		const bool valid = LoadMonster(&record, monster, monsterConversionData);
 		if (!valid) {
 			Monsters[ActiveMonsters[i]] = {};
 			removedMonsterIds.insert(ActiveMonsters[i]);
@@ -834,7 +939,7 @@ void SyncPackSize(Monster &leader)
 	}
 }
 
-void LoadMissile(LoadHelper *file)
+void LoadMissile(LoadRecord *file)
 {
 	Missile missile = {};
 	missile._mitype = static_cast<MissileID>(file->NextLE<int32_t>());
@@ -927,7 +1032,7 @@ _object_id ConvertFromHellfireObject(_object_id type)
 	return type;
 }
 
-void LoadObject(LoadHelper &file, Object &object)
+void LoadObject(LoadRecord &file, Object &object)
 {
 	object._otype = ConvertFromHellfireObject(static_cast<_object_id>(file.NextLE<int32_t>()));
 	object.position.x = file.NextLE<int32_t>();
@@ -1080,7 +1185,8 @@ void LoadMatchingItems(LoadHelper &file, const Player &player, const int n, Item
 
 	for (int i = 0; i < n; i++) {
 		Item &unpackedItem = pItem[i];
-		const bool success = LoadItemData(file, heroItem);
+		LoadRecord record = NextItemRecord(file);
+		const bool success = LoadItemData(record, heroItem);
 		if (!success) {
 			heroItem.clear();
 			unpackedItem = Item();
@@ -1892,7 +1998,8 @@ void LoadAdditionalMissiles()
 	}
 	auto missileCountAdditional = file.NextLE<uint32_t>();
 	for (uint32_t i = 0U; i < missileCountAdditional; i++) {
-		LoadMissile(&file);
+		LoadRecord record = file.NextRecord(MissileSaveSize);
+		LoadMissile(&record);
 	}
 }
 
@@ -1923,7 +2030,8 @@ void LoadLevelSeeds()
 	}
 }
 
-void SaveLevel(SaveWriter &saveWriter, LevelConversionData *levelConversionData)
+template <typename Destination>
+void SaveLevel(Destination &destination, LevelConversionData *levelConversionData)
 {
 	Player &myPlayer = *MyPlayer;
 
@@ -1934,7 +2042,7 @@ void SaveLevel(SaveWriter &saveWriter, LevelConversionData *levelConversionData)
 
 	char szName[MaxMpqPathSize];
 	GetTempLevelNames(szName);
-	SaveHelper file(saveWriter, szName, 256 * 1024);
+	SaveHelper file(destination, szName, 256 * 1024);
 
 	if (leveltype != DTYPE_TOWN) {
 		for (int j = 0; j < MAXDUNY; j++) {
@@ -2005,19 +2113,20 @@ void SaveLevel(SaveWriter &saveWriter, LevelConversionData *levelConversionData)
 tl::expected<void, std::string> LoadLevel(LevelConversionData *levelConversionData)
 {
 	char szName[MaxMpqPathSize];
-	std::optional<SaveReader> archive = OpenSaveArchive(gSaveNumber);
 	GetTempLevelNames(szName);
-	if (!archive || !archive->HasFile(szName))
-		GetPermLevelNames(szName);
-	LoadHelper file(std::move(archive), szName);
+	const std::span<const std::byte> cachedLevelFile = pfile_cached_level_file(szName);
+	std::optional<SaveReader> archive;
+	if (cachedLevelFile.empty()) {
+		archive = OpenSaveArchive(gSaveNumber);
+		if (!archive || !archive->HasFile(szName))
+			GetPermLevelNames(szName);
+	}
+	LoadHelper file = cachedLevelFile.empty() ? LoadHelper(std::move(archive), szName) : LoadHelper(cachedLevelFile);
 	if (!file.IsValid())
 		return tl::make_unexpected(std::string(_("Unable to open save file archive")));
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dCorpse[i][j] = file.NextLE<int8_t>();
-		}
+		LoadGridLE<int8_t>(file, dCorpse);
 		MoveLightsToCorpses();
 	}
 
@@ -2038,8 +2147,11 @@ tl::expected<void, std::string> LoadLevel(LevelConversionData *levelConversionDa
 			objectId = file.NextLE<int8_t>();
 		for (int &objectId : AvailableObjects)
 			objectId = file.NextLE<int8_t>();
-		for (int i = 0; i < ActiveObjectCount; i++)
-			LoadObject(file, Objects[ActiveObjects[i]]);
+		for (int i = 0; i < ActiveObjectCount; i++) {
+			LoadRecord record = file.NextRecord(ObjectSaveSize);
+			LoadObject(record, Objects[ActiveObjects[i]]);
+		}
+		WakeAllObjects();
 		if (!gbSkipSync) {
 			for (int i = 0; i < ActiveObjectCount; i++)
 				SyncObjectAnim(Objects[ActiveObjects[i]]);
@@ -2048,36 +2160,34 @@ tl::expected<void, std::string> LoadLevel(LevelConversionData *levelConversionDa
 
 	LoadDroppedItems(file, savedItemCount);
 
+	LoadRecord flags = file.NextRecord(MAXDUNX * MAXDUNY);
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dFlags[i][j] = static_cast<DungeonFlag>(file.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
+			dFlags[i][j] = static_cast<DungeonFlag>(flags.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
 	}
 
 	// skip dItem indexes, this gets populated in LoadDroppedItems
 	file.Skip<uint8_t>(MAXDUNX * MAXDUNY);
 
 	if (leveltype != DTYPE_TOWN) {
+		LoadRecord monsters = file.NextRecord(sizeof(int32_t) * MAXDUNX * MAXDUNY);
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
 			{
-				dMonster[i][j] = file.NextBE<int32_t>();
+				dMonster[i][j] = monsters.NextBE<int32_t>();
 				if (dMonster[i][j] > 0 && removedMonsterIds.contains(std::abs(dMonster[i][j]) - 1)) {
 					dMonster[i][j] = 0;
 				}
 			}
 		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
-		}
+		LoadGridLE<int8_t>(file, dObject);
+		InvalidateTileBitboards();
 		file.Skip<uint8_t>(MAXDUNY * MAXDUNX); // dLight
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dPreLight[i][j] = file.NextLE<uint8_t>();
-		}
+		LoadGridLE<uint8_t>(file, dPreLight);
+		LoadRecord automap = file.NextRecord(DMAXX * DMAXY);
 		for (int j = 0; j < DMAXY; j++) {
 			for (int i = 0; i < DMAXX; i++) { // NOLINT(modernize-loop-convert)
-				const auto automapView = static_cast<MapExplorationType>(file.NextLE<uint8_t>());
+				const auto automapView = static_cast<MapExplorationType>(automap.NextLE<uint8_t>());
 				AutomapView[i][j] = automapView == MAP_EXP_OLD ? MAP_EXP_SELF : automapView;
 			}
 		}
@@ -2103,9 +2213,6 @@ tl::expected<void, std::string> LoadLevel(LevelConversionData *levelConversionDa
 	return {};
 }
 
-const int DiabloItemSaveSize = 368;
-const int HellfireItemSaveSize = 372;
-
 bool IsStashSizeValid(size_t stashSize, uint32_t pages, uint32_t itemCount)
 {
 	const size_t itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
@@ -2369,9 +2476,9 @@ void LoadHotkeys()
 	myPlayer._pRSplType = static_cast<SpellType>(file.NextLE<uint8_t>());
 }
 
-void SaveHotkeys(SaveWriter &saveWriter, const Player &player)
+void SaveHotkeys(SaveSnapshot &snapshot, const Player &player)
 {
-	SaveHelper file(saveWriter, "hotkeys", HotkeysSize());
+	SaveHelper file(snapshot, "hotkeys", HotkeysSize());
 
 	// Write the number of spell hotkeys
 	file.WriteLE<uint8_t>(static_cast<uint8_t>(NumHotkeys));
@@ -2557,8 +2664,10 @@ tl::expected<void, std::string> LoadGame(bool firstflag)
 		file.Skip<int8_t>(MaxMissilesForSaveGame);
 		// Skip AvailableMissiles
 		file.Skip<int8_t>(MaxMissilesForSaveGame);
-		for (int i = 0; i < tmpNummissiles; i++)
-			LoadMissile(&file);
+		for (int i = 0; i < tmpNummissiles; i++) {
+			LoadRecord record = file.NextRecord(MissileSaveSize);
+			LoadMissile(&record);
+		}
 		// For petrified monsters, the data in missile.var1 must be used to
 		// load the appropriate animation data for the monster in missile.var2
 		for (size_t i = 0; i < ActiveMonsterCount; i++)
@@ -2567,8 +2676,11 @@ tl::expected<void, std::string> LoadGame(bool firstflag)
 			objectId = file.NextLE<int8_t>();
 		for (int &objectId : AvailableObjects)
 			objectId = file.NextLE<int8_t>();
-		for (int i = 0; i < ActiveObjectCount; i++)
-			LoadObject(file, Objects[ActiveObjects[i]]);
+		for (int i = 0; i < ActiveObjectCount; i++) {
+			LoadRecord record = file.NextRecord(ObjectSaveSize);
+			LoadObject(record, Objects[ActiveObjects[i]]);
+		}
+		WakeAllObjects();
 		for (int i = 0; i < ActiveObjectCount; i++)
 			SyncObjectAnim(Objects[ActiveObjects[i]]);
 
@@ -2596,44 +2708,36 @@ tl::expected<void, std::string> LoadGame(bool firstflag)
 		uniqueItemFlag = file.NextBool8();
 
 	file.Skip<uint8_t>(MAXDUNY * MAXDUNX); // dLight
+	LoadRecord flags = file.NextRecord(MAXDUNX * MAXDUNY);
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dFlags[i][j] = static_cast<DungeonFlag>(file.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
-	}
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dPlayer[i][j] = file.NextLE<int8_t>();
+			dFlags[i][j] = static_cast<DungeonFlag>(flags.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
 	}
+	LoadGridLE<int8_t>(file, dPlayer);
 
 	// skip dItem indexes, this gets populated in LoadDroppedItems
 	file.Skip<uint8_t>(MAXDUNX * MAXDUNY);
 
 	if (leveltype != DTYPE_TOWN) {
+		LoadRecord monsters = file.NextRecord(sizeof(int32_t) * MAXDUNX * MAXDUNY);
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
 			{
-				dMonster[i][j] = file.NextBE<int32_t>();
+				dMonster[i][j] = monsters.NextBE<int32_t>();
 				if (dMonster[i][j] > 0 && removedMonsterIds.contains(std::abs(dMonster[i][j]) - 1)) {
 					dMonster[i][j] = 0;
 				}
 			}
 		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dCorpse[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
-		}
+		LoadGridLE<int8_t>(file, dCorpse);
+		LoadGridLE<int8_t>(file, dObject);
+		InvalidateTileBitboards();
 		file.Skip<uint8_t>(MAXDUNY * MAXDUNX); // dLight
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dPreLight[i][j] = file.NextLE<uint8_t>();
-		}
+		LoadGridLE<uint8_t>(file, dPreLight);
+		LoadRecord automap = file.NextRecord(DMAXX * DMAXY);
 		for (int j = 0; j < DMAXY; j++) {
 			for (int i = 0; i < DMAXX; i++) { // NOLINT(modernize-loop-convert)
-				const auto automapView = static_cast<MapExplorationType>(file.NextLE<uint8_t>());
+				const auto automapView = static_cast<MapExplorationType>(automap.NextLE<uint8_t>());
 				AutomapView[i][j] = automapView == MAP_EXP_OLD ? MAP_EXP_SELF : automapView;
 			}
 		}
@@ -2685,10 +2789,10 @@ tl::expected<void, std::string> LoadGame(bool firstflag)
 	return {};
 }
 
-void SaveHeroItems(SaveWriter &saveWriter, Player &player)
+void SaveHeroItems(SaveSnapshot &snapshot, Player &player)
 {
 	const size_t itemCount = static_cast<size_t>(NUM_INVLOC) + InventoryGridCells + MaxBeltItems;
-	SaveHelper file(saveWriter, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
+	SaveHelper file(snapshot, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
 
 	file.WriteLE<uint8_t>(gbIsHellfire ? 1 : 0);
 
@@ -2700,7 +2804,7 @@ void SaveHeroItems(SaveWriter &saveWriter, Player &player)
 		SaveItem(file, item);
 }
 
-void SaveStash(SaveWriter &stashWriter)
+void SaveStash(SaveSnapshot &snapshot)
 {
 	const char *filename;
 	if (!gbIsMultiplayer)
@@ -2711,7 +2815,7 @@ void SaveStash(SaveWriter &stashWriter)
 	const int itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
 
 	SaveHelper file(
-	    stashWriter,
+	    snapshot,
 	    filename,
 	    sizeof(uint8_t)
 	        + sizeof(uint32_t)
@@ -2936,6 +3040,11 @@ void SaveLevel(SaveWriter &saveWriter)
 	SaveLevel(saveWriter, nullptr);
 }
 
+void SaveLevel(SaveSnapshot &snapshot)
+{
+	SaveLevel(snapshot, nullptr);
+}
+
 tl::expected<void, std::string> LoadLevel()
 {
 	return LoadLevel(nullptr);
@@ -1165,7 +1165,7 @@ void InitMissiles()
 		for (auto &missile : Missiles) {
 			if (missile._mitype == MissileID::Infravision) {
 				if (missile.sourcePlayer() == MyPlayer)
-					CalcPlrItemVals(myPlayer, true);
+					CalcPlrInv(myPlayer, true, PlayerStatGroup::ItemBonuses);
 			}
 		}
 	}
@@ -1176,7 +1176,7 @@ void InitMissiles()
 		for (auto &missile : Missiles) {
 			if (missile._mitype == MissileID::Rage) {
 				if (missile.sourcePlayer() == MyPlayer) {
-					CalcPlrItemVals(myPlayer, true);
+					CalcPlrInv(myPlayer, true, PlayerStatGroup::ItemBonuses);
 					ApplyPlrDamage(DamageType::Physical, myPlayer, missile._midam, 1);
 				}
 			}
@@ -1422,7 +1422,7 @@ void AddStealMana(Missile &missile, AddMissileParameter & /*parameter*/)
 
 		player._pMana = 0;
 		player._pManaBase = player._pMana + player._pMaxManaBase - player._pMaxMana;
-		CalcPlrInv(player, false);
+		CalcPlrInv(player, false, PlayerStatGroup::ItemBonuses);
 		RedrawComponent(PanelDrawComponent::Mana);
 		PlaySfxLoc(SfxID::Pig, *trappedPlayerPosition);
 	}
@@ -2543,7 +2543,7 @@ void AddRage(Missile &missile, AddMissileParameter &parameter)
 	missile.var1 = missile.duration;
 
 	player._pSpellFlags |= SpellFlag::RageActive;
-	CalcPlrItemVals(player, true);
+	CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 	player.Say(HeroSpeech::Aaaaargh);
 }
 
@@ -3804,7 +3804,7 @@ void ProcessInfravision(Missile &missile)
 	player._pInfraFlag = true;
 	if (missile.duration == 0) {
 		missile._miDelFlag = true;
-		CalcPlrItemVals(player, true);
+		CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 	}
 }
 
@@ -3894,7 +3894,7 @@ void ProcessRage(Missile &missile)
 		missile._miDelFlag = true;
 	}
 
-	CalcPlrItemVals(player, true);
+	CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 
 	// Prevent the player from dying as a result of recalculating their current life
 	if ((player._pHitPoints >> 6) <= 0)
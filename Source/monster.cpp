@@ -21,6 +21,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -60,6 +61,7 @@
 #include "levels/dun_tile.hpp"
 #include "levels/gendung.h"
 #include "levels/gendung_defs.hpp"
+#include "levels/line_of_sight.hpp"
 #include "levels/themes.h"
 #include "levels/tile_properties.hpp"
 #include "levels/trigs.h"
@@ -90,6 +92,7 @@
 #include "utils/is_of.hpp"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/parallel_for.hpp"
 #include "utils/pointer_value_union.hpp"
 #include "utils/static_vector.hpp"
 #include "utils/status_macros.hpp"
@@ -106,6 +109,7 @@ size_t LevelMonsterTypeCount;
 Monster Monsters[MaxMonsters];
 unsigned ActiveMonsters[MaxMonsters];
 size_t ActiveMonsterCount;
+
 /** Tracks the total number of monsters killed per monster_id. */
 int MonsterKillCounts[NUM_MAX_MTYPES];
 bool sgbSaveSoundOn;
@@ -663,6 +667,52 @@ DVL_ALWAYS_INLINE bool IsRanged(Monster &monster)
 	return IsAnyOf(monster.ai, MonsterAIID::SkeletonRanged, MonsterAIID::GoatRanged, MonsterAIID::Succubus, MonsterAIID::LazarusSuccubus);
 }
 
+/**
+ * @brief Active monsters flagged as golems, berserk ones included, in ActiveMonsters order.
+ *
+ * Monsters that are neither golems nor berserk only ever pick one of these as an enemy, so UpdateEnemy walks this
+ * list instead of every active monster. It is built when ProcessMonsters starts and dropped before monsters are
+ * deleted again. While monsters are processed, ActiveMonsters only grows at the end and no monster becomes a golem,
+ * so appending new arrivals keeps both the contents and the order of the full scan.
+ */
+struct GolemRoster {
+	std::vector<unsigned> ids;
+	/** @brief Number of entries of ActiveMonsters already looked at */
+	size_t scanned = 0;
+	bool valid = false;
+};
+
+GolemRoster Golems;
+
+void BuildGolemRoster()
+{
+	Golems.ids.clear();
+	Golems.scanned = 0;
+	Golems.valid = true;
+}
+
+void DropGolemRoster()
+{
+	Golems.valid = false;
+}
+
+/** @brief Returns the golems in ActiveMonsters order, or nullptr if the roster is not available right now. */
+const std::vector<unsigned> *GetGolemRoster()
+{
+	if (!Golems.valid)
+		return nullptr;
+	if (ActiveMonsterCount < Golems.scanned) {
+		Golems.valid = false;
+		return nullptr;
+	}
+	for (; Golems.scanned < ActiveMonsterCount; Golems.scanned++) {
+		const unsigned monsterId = ActiveMonsters[Golems.scanned];
+		if ((Monsters[monsterId].flags & MFLAG_GOLEM) != 0)
+			Golems.ids.push_back(monsterId);
+	}
+	return &Golems.ids;
+}
+
 void UpdateEnemy(Monster &monster)
 {
 	WorldTilePosition target;
@@ -690,19 +740,18 @@ void UpdateEnemy(Monster &monster)
 			}
 		}
 	}
-	for (size_t i = 0; i < ActiveMonsterCount; i++) {
-		const unsigned monsterId = ActiveMonsters[i];
+	const auto considerMonster = [&](unsigned monsterId) {
 		Monster &otherMonster = Monsters[monsterId];
 		if (&otherMonster == &monster)
-			continue;
+			return;
 		if ((otherMonster.hitPoints >> 6) <= 0)
-			continue;
+			return;
 		if (otherMonster.position.tile == GolemHoldingCell)
-			continue;
+			return;
 		if (otherMonster.talkMsg != TEXT_NONE && M_Talker(otherMonster))
-			continue;
+			return;
 		if (isPlayerMinion && otherMonster.isPlayerMinion()) // prevent golems from fighting each other
-			continue;
+			return;
 
 		const int dist = otherMonster.position.tile.WalkingDistance(position);
 		if (((monster.flags & MFLAG_GOLEM) == 0
@@ -712,7 +761,7 @@ void UpdateEnemy(Monster &monster)
 		    || ((monster.flags & MFLAG_GOLEM) == 0
 		        && (monster.flags & MFLAG_BERSERK) == 0
 		        && (otherMonster.flags & MFLAG_GOLEM) == 0)) {
-			continue;
+			return;
 		}
 		const bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
 		if ((sameroom && !bestsameroom)
@@ -724,6 +773,15 @@ void UpdateEnemy(Monster &monster)
 			bestDist = dist;
 			bestsameroom = sameroom;
 		}
+	};
+
+	const std::vector<unsigned> *golems = (monster.flags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0 ? GetGolemRoster() : nullptr;
+	if (golems != nullptr) {
+		for (const unsigned monsterId : *golems)
+			considerMonster(monsterId);
+	} else {
+		for (size_t i = 0; i < ActiveMonsterCount; i++)
+			considerMonster(ActiveMonsters[i]);
 	}
 	if (menemy != -1) {
 		monster.flags &= ~MFLAG_NO_ENEMY;
@@ -1588,6 +1646,8 @@ Monster *AddSkeleton(Point position, Direction dir, bool inMap)
 
 bool IsLineNotSolid(Point startPoint, Point endPoint)
 {
+	if (InDungeonBounds(startPoint) && InDungeonBounds(endPoint))
+		return IsSolidLineClear(startPoint, endPoint);
 	return LineClear(IsTileNotSolid, startPoint, endPoint);
 }
 
@@ -1732,6 +1792,71 @@ bool IsTileAccessible(const Monster &monster, Point position)
 	return IsTileSafe(monster, position);
 }
 
+/**
+ * @brief A path search done ahead of the monster AI, together with the answer to every tile check it made.
+ *
+ * FindPath only depends on its endpoints and on these answers, so the result still holds as long as the live level
+ * gives the same answers.
+ */
+struct PathPlan {
+	struct AccessibleCheck {
+		Point position;
+		bool accessible;
+	};
+	struct StepCheck {
+		Point from;
+		Point to;
+		bool canStep;
+	};
+
+	bool searched = false;
+	Point start;
+	Point destination;
+	/** First step of the path, or -1 if no path was found */
+	int8_t firstStep;
+	std::vector<AccessibleCheck> accessibleChecks;
+	std::vector<StepCheck> stepChecks;
+};
+
+/** Path searches done by PlanMonsterPaths, indexed by monster id */
+std::array<PathPlan, MaxMonsters> PathPlans;
+/** Monsters that have a path search in PathPlans this game tick */
+std::vector<size_t> PlannedMonsters;
+
+/** Planning paths ahead only pays off once there are enough searches to spread across threads */
+constexpr size_t MinPlannedMonsters = 4;
+/** Threads running PlanPath, kept around between game ticks */
+WorkerPool PathPlanWorkers;
+
+#ifdef BUILD_TESTING
+std::optional<bool> ForcedPathPlanning;
+#endif
+
+/**
+ * @brief Returns the result of the path search from PlanMonsterPaths, or nullptr if it does not apply anymore.
+ *
+ * The search applies if it went between the same points and every check it made still gives the same answer.
+ */
+const PathPlan *TakePathPlan(const Monster &monster)
+{
+	PathPlan &plan = PathPlans[monster.getId()];
+	if (!plan.searched)
+		return nullptr;
+	plan.searched = false;
+
+	if (plan.start != monster.position.tile || plan.destination != monster.enemyPosition)
+		return nullptr;
+	for (const PathPlan::AccessibleCheck &check : plan.accessibleChecks) {
+		if (IsTileAccessible(monster, check.position) != check.accessible)
+			return nullptr;
+	}
+	for (const PathPlan::StepCheck &check : plan.stepChecks) {
+		if (CanStep(check.from, check.to) != check.canStep)
+			return nullptr;
+	}
+	return &plan;
+}
+
 bool AiPlanWalk(Monster &monster)
 {
 	int8_t path[MaxPathLengthMonsters];
@@ -1739,7 +1864,12 @@ bool AiPlanWalk(Monster &monster)
 	/** Maps from walking path step to facing direction. */
 	const Direction plr2monst[9] = { Direction::South, Direction::NorthEast, Direction::NorthWest, Direction::SouthEast, Direction::SouthWest, Direction::North, Direction::East, Direction::South, Direction::West };
 
-	if (FindPath(CanStep, [&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path, MaxPathLengthMonsters) == 0) {
+	const PathPlan *plan = TakePathPlan(monster);
+	if (plan != nullptr) {
+		if (plan->firstStep == -1)
+			return false;
+		path[0] = plan->firstStep;
+	} else if (FindPath(CanStep, [&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path, MaxPathLengthMonsters) == 0) {
 		return false;
 	}
 
@@ -1810,6 +1940,129 @@ bool AiPlanPath(Monster &monster)
 	return false;
 }
 
+/**
+ * @brief Returns where ProcessMonsters is going to look for the monster's enemy, as far as can be told before the AI runs.
+ */
+Point PredictEnemyPosition(const Monster &monster)
+{
+	if ((monster.flags & MFLAG_NO_ENEMY) != 0)
+		return monster.enemyPosition;
+	if ((monster.flags & MFLAG_TARGETS_MONSTER) != 0)
+		return Monsters[monster.enemy].position.future;
+	return Players[monster.enemy].position.future;
+}
+
+/**
+ * @brief Checks whether AiPlanPath is likely to search for a path for the monster this game tick.
+ */
+bool MayPlanWalk(const Monster &monster)
+{
+	if (monster.pathCount < 4)
+		return false;
+	if (monster.type().type == MT_GOLEM)
+		return (monster.flags & MFLAG_NO_ENEMY) == 0;
+
+	return (monster.flags & MFLAG_SEARCH) != 0
+	    && monster.activeForTicks != 0
+	    && monster.mode == MonsterMode::Stand
+	    && IsAnyOf(monster.goal, MonsterGoal::Normal, MonsterGoal::Move, MonsterGoal::Attack)
+	    && monster.position.tile != GolemHoldingCell;
+}
+
+/**
+ * @brief Runs the path search of AiPlanPath for the monster and records every tile check it makes.
+ *
+ * Only reads the level, so it can run for several monsters at once.
+ */
+void PlanPath(PathPlan &plan, const Monster &monster)
+{
+	plan.start = monster.position.tile;
+	plan.destination = PredictEnemyPosition(monster);
+	plan.accessibleChecks.clear();
+	plan.stepChecks.clear();
+
+	const bool clear = LineClear(
+	    [&monster](Point position) { return (IsTileWalkable(position) && IsTileSafe(monster, position)); },
+	    plan.start,
+	    plan.destination);
+	if (clear && (monster.pathCount < 5 || monster.pathCount >= 8))
+		return;
+
+	int8_t path[MaxPathLengthMonsters];
+	const int pathLength = FindPath(
+	    [&plan](Point from, Point to) {
+		    const bool canStep = CanStep(from, to);
+		    plan.stepChecks.push_back({ from, to, canStep });
+		    return canStep;
+	    },
+	    [&plan, &monster](Point position) {
+		    const bool accessible = IsTileAccessible(monster, position);
+		    plan.accessibleChecks.push_back({ position, accessible });
+		    return accessible;
+	    },
+	    plan.start, plan.destination, path, MaxPathLengthMonsters);
+	plan.firstStep = pathLength == 0 ? -1 : path[0];
+	plan.searched = true;
+
+	// The search asks about most tiles several times, TakePathPlan only needs to check each answer once
+	const auto byPosition = [](const auto &a, const auto &b) {
+		return std::tie(a.position.x, a.position.y) < std::tie(b.position.x, b.position.y);
+	};
+	const auto samePosition = [](const auto &a, const auto &b) { return a.position == b.position; };
+	std::sort(plan.accessibleChecks.begin(), plan.accessibleChecks.end(), byPosition);
+	plan.accessibleChecks.erase(std::unique(plan.accessibleChecks.begin(), plan.accessibleChecks.end(), samePosition), plan.accessibleChecks.end());
+
+	const auto byStep = [](const auto &a, const auto &b) {
+		return std::tie(a.from.x, a.from.y, a.to.x, a.to.y) < std::tie(b.from.x, b.from.y, b.to.x, b.to.y);
+	};
+	const auto sameStep = [](const auto &a, const auto &b) { return a.from == b.from && a.to == b.to; };
+	std::sort(plan.stepChecks.begin(), plan.stepChecks.end(), byStep);
+	plan.stepChecks.erase(std::unique(plan.stepChecks.begin(), plan.stepChecks.end(), sameStep), plan.stepChecks.end());
+}
+
+/**
+ * @brief Searches the paths the monster AI is likely to need this game tick on all cores.
+ *
+ * The AI still runs in order afterwards and only uses a search if it still holds (see TakePathPlan), so the outcome is
+ * the same as when the AI does all the searches itself.
+ * Checking the searches again is serial, so this is only built in with DEVILUTIONX_MONSTER_PATH_PLANNING.
+ */
+void PlanMonsterPaths()
+{
+	for (const size_t monsterId : PlannedMonsters)
+		PathPlans[monsterId].searched = false;
+	PlannedMonsters.clear();
+
+	bool forced = false;
+#ifdef BUILD_TESTING
+	if (ForcedPathPlanning && !*ForcedPathPlanning)
+		return;
+	forced = ForcedPathPlanning.has_value();
+#endif
+#ifndef DEVILUTIONX_MONSTER_PATH_PLANNING
+	if (!forced)
+		return;
+#endif
+	if (!forced && GetHardwareConcurrency() <= 1)
+		return;
+
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const Monster &monster = Monsters[ActiveMonsters[i]];
+		if (MayPlanWalk(monster))
+			PlannedMonsters.push_back(ActiveMonsters[i]);
+	}
+	if (!forced && PlannedMonsters.size() < MinPlannedMonsters) {
+		PlannedMonsters.clear();
+		return;
+	}
+
+	RefreshTileBitboards();
+	PathPlanWorkers.run(PlannedMonsters.size(), [](size_t i) {
+		const size_t monsterId = PlannedMonsters[i];
+		PlanPath(PathPlans[monsterId], Monsters[monsterId]);
+	});
+}
+
 void AiAvoidance(Monster &monster)
 {
 	if (monster.mode != MonsterMode::Stand || monster.activeForTicks == 0) {
@@ -4123,8 +4376,10 @@ void RemoveEnemyReferences(const Player &player)
 void ProcessMonsters()
 {
 	DeleteMonsterList();
+	BuildGolemRoster();
 
 	assert(ActiveMonsterCount <= MaxMonsters);
+	PlanMonsterPaths();
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
 		Monster &monster = Monsters[ActiveMonsters[i]];
 		FollowTheLeader(monster);
@@ -4199,6 +4454,7 @@ void ProcessMonsters()
 		}
 	}
 
+	DropGolemRoster();
 	DeleteMonsterList();
 }
 
@@ -4249,11 +4505,13 @@ bool DirOK(const Monster &monster, Direction mdir)
 
 bool PosOkMissile(Point position)
 {
-	return !TileHasAny(position, TileProperties::BlockMissile);
+	return !IsTileBlockingMissiles(position);
 }
 
 bool LineClearMissile(Point startPoint, Point endPoint)
 {
+	if (InDungeonBounds(startPoint) && InDungeonBounds(endPoint))
+		return IsMissileLineClear(startPoint, endPoint);
 	return LineClear(PosOkMissile, startPoint, endPoint);
 }
 
@@ -4810,6 +5068,13 @@ void decode_enemy(Monster &monster, uint8_t enemyId)
 	}
 }
 
+#ifdef BUILD_TESTING
+void TestForceMonsterPathPlanning(std::optional<bool> planned)
+{
+	ForcedPathPlanning = planned;
+}
+#endif
+
 [[nodiscard]] size_t Monster::getId() const
 {
 	return std::distance<const Monster *>(&Monsters[0], this);
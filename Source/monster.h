@@ -10,6 +10,7 @@
 
 #include <array>
 #include <functional>
+#include <optional>
 #include <string>
 
 #include <expected.hpp>
@@ -27,6 +28,7 @@
 #include "monstdat.h"
 #include "spelldat.h"
 #include "textdat.h"
+#include "utils/attributes.h"
 #include "utils/language.h"
 
 namespace devilution {
@@ -479,9 +481,9 @@ struct Monster { // note: missing field _mAFNum
 };
 
 extern size_t LevelMonsterTypeCount;
-extern Monster Monsters[MaxMonsters];
-extern unsigned ActiveMonsters[MaxMonsters];
-extern size_t ActiveMonsterCount;
+extern DVL_API_FOR_TEST Monster Monsters[MaxMonsters];
+extern DVL_API_FOR_TEST unsigned ActiveMonsters[MaxMonsters];
+extern DVL_API_FOR_TEST size_t ActiveMonsterCount;
 extern int MonsterKillCounts[NUM_MAX_MTYPES];
 extern bool sgbSaveSoundOn;
 
@@ -571,4 +573,11 @@ bool CanTalkToMonst(const Monster &monster);
 uint8_t encode_enemy(Monster &monster);
 void decode_enemy(Monster &monster, uint8_t enemyId);
 
+#ifdef BUILD_TESTING
+/**
+ * @brief Makes ProcessMonsters always (true) or never (false) plan paths ahead of the AI, std::nullopt restores the default.
+ */
+void TestForceMonsterPathPlanning(std::optional<bool> planned);
+#endif
+
 } // namespace devilution
@@ -0,0 +1,313 @@
+#include "mpq/mpq_mapping.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <libmpq/mpq.h>
+
+#include "encrypt.h"
+#include "utils/file_util.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__DJGPP__) && !defined(__3DS__) && !defined(__vita__) && !defined(__SWITCH__) && !defined(__amigaos__)
+#define DVL_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32) && !defined(__UWP__) && !defined(DEVILUTIONX_WINDOWS_NO_WCHAR)
+#define DVL_HAS_WIN32_FILE_MAPPING
+// Suppress definitions of `min` and `max` macros by <windows.h>:
+#define NOMINMAX 1
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+namespace devilution {
+
+namespace {
+
+constexpr uint32_t FlagImplode = MpqBlockEntry::CompressPkZip;
+constexpr uint32_t FlagEncrypted = 0x00010000;
+constexpr uint32_t FlagFixKey = 0x00020000;
+constexpr uint32_t SupportedFlags = MpqBlockEntry::FlagExists | FlagImplode | FlagEncrypted | FlagFixKey;
+
+/** @brief The table Storm uses for both hashing names and encrypting data. */
+constexpr std::array<uint32_t, 0x500> CryptTable = []() {
+	std::array<uint32_t, 0x500> table {};
+	uint32_t seed = 0x00100001;
+	for (uint32_t index1 = 0; index1 < 0x100; index1++) {
+		for (uint32_t i = 0, index2 = index1; i < 5; i++, index2 += 0x100) {
+			seed = (seed * 125 + 3) % 0x2AAAAB;
+			const uint32_t high = (seed & 0xFFFF) << 0x10;
+			seed = (seed * 125 + 3) % 0x2AAAAB;
+			table[index2] = high | (seed & 0xFFFF);
+		}
+	}
+	return table;
+}();
+
+/** @brief Hash type used to derive the encryption key of a file from its name. */
+constexpr uint32_t FileKeyHashType = 3;
+
+constexpr uint32_t HashString(std::string_view str, uint32_t hashType)
+{
+	uint32_t seed1 = 0x7FED7FED;
+	uint32_t seed2 = 0xEEEEEEEE;
+	for (const char c : str) {
+		uint32_t ch = static_cast<uint8_t>(c);
+		if (ch >= 'a' && ch <= 'z')
+			ch -= 'a' - 'A';
+		seed1 = CryptTable[hashType * 0x100 + ch] ^ (seed1 + seed2);
+		seed2 = ch + seed1 + seed2 + (seed2 << 5) + 3;
+	}
+	return seed1;
+}
+
+static_assert(HashString("(hash table)", FileKeyHashType) == LIBMPQ_HASH_TABLE_HASH_KEY);
+static_assert(HashString("(block table)", FileKeyHashType) == LIBMPQ_BLOCK_TABLE_HASH_KEY);
+
+/**
+ * @brief Copies a table out of the mapping and decrypts it.
+ * @return false if the table lies outside of the file
+ */
+template <typename T>
+bool ReadTable(const std::byte *data, size_t size, uint32_t offset, uint32_t count, uint32_t key, std::unique_ptr<T[]> &table)
+{
+	const size_t tableSize = static_cast<size_t>(count) * sizeof(T);
+	if (offset > size || tableSize > size - offset)
+		return false;
+	table = std::make_unique<T[]>(count);
+	memcpy(table.get(), data + offset, tableSize);
+	libmpq__decrypt_block(reinterpret_cast<uint32_t *>(table.get()), static_cast<uint32_t>(tableSize), key);
+	return true;
+}
+
+/**
+ * @brief Maps the whole file read-only.
+ * @return nullptr if the platform cannot map files or the file cannot be opened
+ */
+const std::byte *MapFile(const char *path, size_t &size)
+{
+#if defined(DVL_HAS_MMAP)
+	const int fd = ::open(path, O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+	struct ::stat statResult;
+	void *data = MAP_FAILED;
+	if (::fstat(fd, &statResult) == 0 && statResult.st_size > 0) {
+		size = static_cast<size_t>(statResult.st_size);
+		data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// The mapping stays valid after the descriptor is closed.
+	::close(fd);
+	return data != MAP_FAILED ? static_cast<const std::byte *>(data) : nullptr;
+#elif defined(DVL_HAS_WIN32_FILE_MAPPING)
+	const std::unique_ptr<wchar_t[]> pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr)
+		return nullptr;
+	const HANDLE file = ::CreateFileW(pathUtf16.get(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER fileSize;
+	HANDLE fileMapping = nullptr;
+	if (::GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+		size = static_cast<size_t>(fileSize.QuadPart);
+		fileMapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	::CloseHandle(file);
+	if (fileMapping == nullptr)
+		return nullptr;
+	// The view keeps the mapping object alive.
+	const void *data = ::MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	::CloseHandle(fileMapping);
+	return static_cast<const std::byte *>(data);
+#else
+	return nullptr;
+#endif
+}
+
+void UnmapFile(const std::byte *data, size_t size)
+{
+#if defined(DVL_HAS_MMAP)
+	::munmap(const_cast<std::byte *>(data), size);
+#elif defined(DVL_HAS_WIN32_FILE_MAPPING)
+	::UnmapViewOfFile(data);
+#endif
+}
+
+} // namespace
+
+std::unique_ptr<MpqMapping> MpqMapping::Open(const char *path)
+{
+	// The tables are decrypted in place as native words.
+	if constexpr (std::endian::native != std::endian::little)
+		return nullptr;
+
+	size_t size = 0;
+	const std::byte *data = MapFile(path, size);
+	if (data == nullptr)
+		return nullptr;
+
+	std::unique_ptr<MpqMapping> mapping { new MpqMapping() };
+	mapping->data_ = data;
+	mapping->size_ = size;
+	if (size < sizeof(MpqFileHeader))
+		return nullptr;
+
+	MpqFileHeader header;
+	memcpy(&header, mapping->data_, sizeof(header));
+	if (header.signature != MpqFileHeader::DiabloSignature || header.version != 0 || header.blockSizeFactor > 16)
+		return nullptr;
+	if (header.hashEntriesCount == 0 || !std::has_single_bit(header.hashEntriesCount))
+		return nullptr;
+	mapping->blockSize_ = 512U << header.blockSizeFactor;
+	mapping->hashCount_ = header.hashEntriesCount;
+	mapping->blockCount_ = header.blockEntriesCount;
+
+	if (!ReadTable(mapping->data_, mapping->size_, header.hashEntriesOffset, header.hashEntriesCount, LIBMPQ_HASH_TABLE_HASH_KEY, mapping->hashTable_))
+		return nullptr;
+	if (!ReadTable(mapping->data_, mapping->size_, header.blockEntriesOffset, header.blockEntriesCount, LIBMPQ_BLOCK_TABLE_HASH_KEY, mapping->blockTable_))
+		return nullptr;
+
+	for (uint32_t i = 0; i < mapping->blockCount_; i++) {
+		const MpqBlockEntry &block = mapping->blockTable_[i];
+		if ((block.flags & MpqBlockEntry::FlagExists) == 0)
+			continue;
+		// Multi-algorithm compression, single unit files, sector checksums and the like are left to libmpq.
+		if ((block.flags & ~SupportedFlags) != 0)
+			return nullptr;
+		if (block.offset > mapping->size_ || block.packedSize > mapping->size_ - block.offset)
+			return nullptr;
+	}
+
+	return mapping;
+}
+
+MpqMapping::~MpqMapping()
+{
+	if (data_ != nullptr)
+		UnmapFile(data_, size_);
+}
+
+std::optional<uint32_t> MpqMapping::FindFile(const MpqFileHash &fileHash) const
+{
+	const uint32_t mask = hashCount_ - 1;
+	for (uint32_t i = 0, index = fileHash[0] & mask; i < hashCount_; i++, index = (index + 1) & mask) {
+		const MpqHashEntry &entry = hashTable_[index];
+		if (entry.block == MpqHashEntry::NullBlock)
+			break;
+		if (entry.hashA == fileHash[1] && entry.hashB == fileHash[2] && IsValidFile(entry.block))
+			return entry.block;
+	}
+	return std::nullopt;
+}
+
+bool MpqMapping::IsValidFile(uint32_t fileNumber) const
+{
+	return fileNumber < blockCount_ && (blockTable_[fileNumber].flags & MpqBlockEntry::FlagExists) != 0;
+}
+
+uint32_t MpqMapping::GetNumBlocks(uint32_t fileNumber) const
+{
+	return (blockTable_[fileNumber].unpackedSize + blockSize_ - 1) / blockSize_;
+}
+
+uint32_t MpqMapping::GetBlockSize(uint32_t fileNumber, uint32_t blockNumber) const
+{
+	const uint32_t unpackedSize = blockTable_[fileNumber].unpackedSize;
+	const uint32_t start = blockNumber * blockSize_;
+	if (start >= unpackedSize)
+		return 0;
+	return std::min(unpackedSize - start, blockSize_);
+}
+
+uint32_t MpqMapping::GetFileKey(uint32_t fileNumber, std::string_view filename) const
+{
+	const MpqBlockEntry &block = blockTable_[fileNumber];
+	if ((block.flags & FlagEncrypted) == 0)
+		return 0;
+
+	const size_t separator = filename.find_last_of("\\/");
+	if (separator != std::string_view::npos)
+		filename.remove_prefix(separator + 1);
+
+	uint32_t key = HashString(filename, FileKeyHashType);
+	if ((block.flags & FlagFixKey) != 0)
+		key = (key + block.offset) ^ block.unpackedSize;
+	return key;
+}
+
+int32_t MpqMapping::ReadSectorOffsets(uint32_t fileNumber, uint32_t key, std::vector<uint32_t> &offsets) const
+{
+	const MpqBlockEntry &block = blockTable_[fileNumber];
+	const uint32_t numBlocks = GetNumBlocks(fileNumber);
+	offsets.resize(numBlocks + 1);
+
+	// Stored files have no offset table, their sectors simply follow each other.
+	if ((block.flags & FlagImplode) == 0) {
+		for (uint32_t i = 0; i < numBlocks; i++)
+			offsets[i] = i * blockSize_;
+		offsets[numBlocks] = block.unpackedSize;
+		return block.unpackedSize <= block.packedSize ? 0 : LIBMPQ_ERROR_FORMAT;
+	}
+
+	const size_t tableSize = offsets.size() * sizeof(uint32_t);
+	if (tableSize > block.packedSize)
+		return LIBMPQ_ERROR_FORMAT;
+	memcpy(offsets.data(), data_ + block.offset, tableSize);
+	if (key != 0)
+		libmpq__decrypt_block(offsets.data(), static_cast<uint32_t>(tableSize), key - 1);
+
+	for (uint32_t i = 0; i < numBlocks; i++) {
+		if (offsets[i] > offsets[i + 1] || offsets[i + 1] - offsets[i] > blockSize_)
+			return LIBMPQ_ERROR_FORMAT;
+	}
+	if (offsets[0] < tableSize || offsets[numBlocks] > block.packedSize)
+		return LIBMPQ_ERROR_FORMAT;
+	return 0;
+}
+
+int32_t MpqMapping::ReadBlock(uint32_t fileNumber, uint32_t key, const std::vector<uint32_t> &offsets, uint32_t blockNumber,
+    uint8_t *out, size_t outSize, std::vector<uint8_t> &scratch) const
+{
+	if (blockNumber + 1 >= offsets.size())
+		return LIBMPQ_ERROR_EXIST;
+	const uint32_t unpackedSize = GetBlockSize(fileNumber, blockNumber);
+	if (outSize < unpackedSize)
+		return LIBMPQ_ERROR_SIZE;
+
+	const uint32_t packedSize = offsets[blockNumber + 1] - offsets[blockNumber];
+	const std::byte *src = data_ + blockTable_[fileNumber].offset + offsets[blockNumber];
+	const bool stored = packedSize == unpackedSize;
+
+	// Only encrypted sectors need a copy, everything else is decoded straight out of the mapping.
+	const size_t sectorScratch = key != 0 ? (packedSize + 7) & ~size_t { 7 } : 0;
+	const size_t scratchSize = sectorScratch + (stored ? 0 : PkwareWorkBufferSize);
+	if (scratch.size() < scratchSize)
+		scratch.resize(scratchSize);
+	if (key != 0) {
+		memcpy(scratch.data(), src, packedSize);
+		libmpq__decrypt_block(reinterpret_cast<uint32_t *>(scratch.data()), packedSize, key + blockNumber);
+		src = reinterpret_cast<const std::byte *>(scratch.data());
+	}
+
+	if (stored) {
+		memcpy(out, src, packedSize);
+		return 0;
+	}
+
+	auto *workBuf = reinterpret_cast<std::byte *>(scratch.data() + sectorScratch);
+	if (PkwareDecompress(src, packedSize, reinterpret_cast<std::byte *>(out), unpackedSize, workBuf) != unpackedSize)
+		return LIBMPQ_ERROR_UNPACK;
+	return 0;
+}
+
+} // namespace devilution
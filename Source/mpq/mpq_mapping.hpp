@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "mpq/mpq_common.hpp"
+
+namespace devilution {
+
+/**
+ * @brief A read-only MPQ archive mapped into memory.
+ *
+ * Keeps the decrypted hash and block tables and decodes sectors straight out of the mapping.
+ * All methods are const and only write to buffers owned by the caller, so a single mapping
+ * can be shared by any number of readers.
+ */
+class MpqMapping {
+public:
+	/**
+	 * @brief Maps the archive at `path`.
+	 *
+	 * Returns nullptr if the platform cannot map files, the file cannot be opened, or the archive uses
+	 * anything other than stored or PKWare imploded sectors. Callers fall back to libmpq in that case.
+	 */
+	static std::unique_ptr<MpqMapping> Open(const char *path);
+
+	MpqMapping(const MpqMapping &) = delete;
+	MpqMapping &operator=(const MpqMapping &) = delete;
+
+	~MpqMapping();
+
+	/** @brief Returns the block index of the file, which the mapped reader uses as the file number. */
+	[[nodiscard]] std::optional<uint32_t> FindFile(const MpqFileHash &fileHash) const;
+
+	[[nodiscard]] bool IsValidFile(uint32_t fileNumber) const;
+
+	[[nodiscard]] uint32_t GetUnpackedFileSize(uint32_t fileNumber) const
+	{
+		return blockTable_[fileNumber].unpackedSize;
+	}
+
+	[[nodiscard]] uint32_t GetNumBlocks(uint32_t fileNumber) const;
+
+	[[nodiscard]] uint32_t GetBlockSize(uint32_t fileNumber, uint32_t blockNumber) const;
+
+	[[nodiscard]] uint32_t GetMaxBlockSize() const
+	{
+		return blockSize_;
+	}
+
+	/** @brief Returns the encryption key of the file, derived from its name, or 0 if the file is not encrypted. */
+	[[nodiscard]] uint32_t GetFileKey(uint32_t fileNumber, std::string_view filename) const;
+
+	/**
+	 * @brief Reads the start of each sector relative to the file, plus the end of the last sector.
+	 * @return Error code
+	 */
+	int32_t ReadSectorOffsets(uint32_t fileNumber, uint32_t key, std::vector<uint32_t> &offsets) const;
+
+	/**
+	 * @brief Decodes a single sector into `out`.
+	 * @param offsets Sector offsets returned by ReadSectorOffsets
+	 * @param scratch Grown as needed, holds decrypted sectors and the PKWare work buffer
+	 * @return Error code
+	 */
+	int32_t ReadBlock(uint32_t fileNumber, uint32_t key, const std::vector<uint32_t> &offsets, uint32_t blockNumber,
+	    uint8_t *out, size_t outSize, std::vector<uint8_t> &scratch) const;
+
+private:
+	MpqMapping() = default;
+
+	const std::byte *data_ = nullptr;
+	size_t size_ = 0;
+	uint32_t blockSize_ = 0;
+	std::unique_ptr<MpqHashEntry[]> hashTable_;
+	uint32_t hashCount_ = 0;
+	std::unique_ptr<MpqBlockEntry[]> blockTable_;
+	uint32_t blockCount_ = 0;
+};
+
+} // namespace devilution
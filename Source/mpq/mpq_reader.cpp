@@ -2,15 +2,26 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string_view>
 
 #include <libmpq/mpq.h>
 
+#include "mpq/mpq_mapping.hpp"
+
 namespace devilution {
 
-std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
+std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error, bool memoryMap)
 {
+	if (memoryMap) {
+		std::shared_ptr<const MpqMapping> mapping = MpqMapping::Open(path);
+		if (mapping != nullptr) {
+			error = 0;
+			return MpqArchive { std::string(path), std::move(mapping) };
+		}
+	}
+
 	mpq_archive_s *archive;
 	error = libmpq__archive_open(&archive, path, -1);
 	if (error != 0) {
@@ -23,6 +34,11 @@ std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
 
 std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
 {
+	if (mapping_ != nullptr) {
+		error = 0;
+		return MpqArchive { path_, mapping_ };
+	}
+
 	mpq_archive_s *copy;
 	error = libmpq__archive_dup(archive_, path_.c_str(), &copy);
 	if (error != 0)
@@ -43,6 +59,9 @@ MpqArchive &MpqArchive::operator=(MpqArchive &&other) noexcept
 	archive_ = other.archive_;
 	other.archive_ = nullptr;
 	tmp_buf_ = std::move(other.tmp_buf_);
+	mapping_ = std::move(other.mapping_);
+	sectorOffsets_ = std::move(other.sectorOffsets_);
+	mappedFiles_ = std::move(other.mappedFiles_);
 	return *this;
 }
 
@@ -54,11 +73,21 @@ MpqArchive::~MpqArchive()
 
 bool MpqArchive::GetFileNumber(MpqFileHash fileHash, uint32_t &fileNumber)
 {
+	if (mapping_ != nullptr) {
+		const std::optional<uint32_t> found = mapping_->FindFile(fileHash);
+		if (!found)
+			return false;
+		fileNumber = *found;
+		return true;
+	}
 	return libmpq__file_number_from_hash(archive_, fileHash[0], fileHash[1], fileHash[2], &fileNumber) == 0;
 }
 
 std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error)
 {
+	if (mapping_ != nullptr)
+		return ReadMappedFile(filename, fileSize, error);
+
 	std::unique_ptr<std::byte[]> result;
 	std::uint32_t fileNumber;
 	error = libmpq__file_number_s(archive_, filename.data(), filename.size(), &fileNumber);
@@ -98,8 +127,47 @@ std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std
 	return result;
 }
 
+std::unique_ptr<std::byte[]> MpqArchive::ReadMappedFile(std::string_view filename, std::size_t &fileSize, int32_t &error)
+{
+	std::unique_ptr<std::byte[]> result;
+	const std::optional<uint32_t> fileNumber = mapping_->FindFile(CalculateMpqFileHash(filename));
+	if (!fileNumber) {
+		error = LIBMPQ_ERROR_EXIST;
+		return result;
+	}
+
+	const uint32_t key = mapping_->GetFileKey(*fileNumber, filename);
+	error = mapping_->ReadSectorOffsets(*fileNumber, key, sectorOffsets_);
+	if (error != 0)
+		return result;
+
+	const uint32_t unpackedSize = mapping_->GetUnpackedFileSize(*fileNumber);
+	result = std::make_unique<std::byte[]>(unpackedSize);
+	auto *out = reinterpret_cast<uint8_t *>(result.get());
+	const uint32_t numBlocks = mapping_->GetNumBlocks(*fileNumber);
+	for (uint32_t blockNumber = 0; blockNumber < numBlocks; blockNumber++) {
+		const uint32_t blockSize = mapping_->GetBlockSize(*fileNumber, blockNumber);
+		error = mapping_->ReadBlock(*fileNumber, key, sectorOffsets_, blockNumber, out, blockSize, tmp_buf_);
+		if (error != 0) {
+			result = nullptr;
+			return result;
+		}
+		out += blockSize;
+	}
+
+	fileSize = unpackedSize;
+	return result;
+}
+
 int32_t MpqArchive::ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, size_t outSize)
 {
+	if (mapping_ != nullptr) {
+		const auto it = mappedFiles_.find(fileNumber);
+		if (it == mappedFiles_.end())
+			return LIBMPQ_ERROR_OPEN;
+		return mapping_->ReadBlock(fileNumber, it->second.key, it->second.sectorOffsets, blockNumber, out, outSize, tmp_buf_);
+	}
+
 	std::vector<std::uint8_t> &tmpBuf = GetTemporaryBuffer(outSize);
 	return libmpq__block_read_with_temporary_buffer(
 	    archive_, fileNumber, blockNumber, out, static_cast<libmpq__off_t>(outSize),
@@ -109,6 +177,15 @@ int32_t MpqArchive::ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t
 
 std::size_t MpqArchive::GetUnpackedFileSize(uint32_t fileNumber, int32_t &error)
 {
+	if (mapping_ != nullptr) {
+		if (!mapping_->IsValidFile(fileNumber)) {
+			error = LIBMPQ_ERROR_EXIST;
+			return 0;
+		}
+		error = 0;
+		return mapping_->GetUnpackedFileSize(fileNumber);
+	}
+
 	libmpq__off_t unpackedSize;
 	error = libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize);
 	return static_cast<size_t>(unpackedSize);
@@ -116,6 +193,15 @@ std::size_t MpqArchive::GetUnpackedFileSize(uint32_t fileNumber, int32_t &error)
 
 uint32_t MpqArchive::GetNumBlocks(uint32_t fileNumber, int32_t &error)
 {
+	if (mapping_ != nullptr) {
+		if (!mapping_->IsValidFile(fileNumber)) {
+			error = LIBMPQ_ERROR_EXIST;
+			return 0;
+		}
+		error = 0;
+		return mapping_->GetNumBlocks(fileNumber);
+	}
+
 	uint32_t numBlocks;
 	error = libmpq__file_blocks(archive_, fileNumber, &numBlocks);
 	return numBlocks;
@@ -123,17 +209,50 @@ uint32_t MpqArchive::GetNumBlocks(uint32_t fileNumber, int32_t &error)
 
 int32_t MpqArchive::OpenBlockOffsetTable(uint32_t fileNumber, std::string_view filename)
 {
+	if (mapping_ != nullptr) {
+		if (!mapping_->IsValidFile(fileNumber))
+			return LIBMPQ_ERROR_EXIST;
+		const auto it = mappedFiles_.find(fileNumber);
+		if (it != mappedFiles_.end()) {
+			++it->second.refCount;
+			return 0;
+		}
+		MappedFile file { mapping_->GetFileKey(fileNumber, filename), {}, 1 };
+		const int32_t error = mapping_->ReadSectorOffsets(fileNumber, file.key, file.sectorOffsets);
+		if (error == 0)
+			mappedFiles_.emplace(fileNumber, std::move(file));
+		return error;
+	}
+
 	return libmpq__block_open_offset_with_filename_s(archive_, fileNumber, filename.data(), filename.size());
 }
 
 int32_t MpqArchive::CloseBlockOffsetTable(uint32_t fileNumber)
 {
+	if (mapping_ != nullptr) {
+		const auto it = mappedFiles_.find(fileNumber);
+		if (it == mappedFiles_.end())
+			return LIBMPQ_ERROR_OPEN;
+		if (--it->second.refCount == 0)
+			mappedFiles_.erase(it);
+		return 0;
+	}
+
 	return libmpq__block_close_offset(archive_, fileNumber);
 }
 
 // Requires the block offset table to be open
 std::size_t MpqArchive::GetBlockSize(uint32_t fileNumber, uint32_t blockNumber, int32_t &error)
 {
+	if (mapping_ != nullptr) {
+		if (mappedFiles_.find(fileNumber) == mappedFiles_.end()) {
+			error = LIBMPQ_ERROR_OPEN;
+			return 0;
+		}
+		error = 0;
+		return mapping_->GetBlockSize(fileNumber, blockNumber);
+	}
+
 	libmpq__off_t blockSize;
 	error = libmpq__block_size_unpacked(archive_, fileNumber, blockNumber, &blockSize);
 	return static_cast<size_t>(blockSize);
@@ -141,6 +260,9 @@ std::size_t MpqArchive::GetBlockSize(uint32_t fileNumber, uint32_t blockNumber,
 
 bool MpqArchive::HasFile(std::string_view filename) const
 {
+	if (mapping_ != nullptr)
+		return mapping_->FindFile(CalculateMpqFileHash(filename)).has_value();
+
 	std::uint32_t fileNumber;
 	const int32_t error = libmpq__file_number_s(archive_, filename.data(), filename.size(), &fileNumber);
 	return error == 0;
@@ -6,6 +6,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -17,11 +18,19 @@ using mpq_archive_s = struct mpq_archive;
 
 namespace devilution {
 
+class MpqMapping;
+
 class MpqArchive {
 public:
 	// If the file does not exist, returns nullopt without an error.
-	static std::optional<MpqArchive> Open(const char *path, int32_t &error);
-
+	// With `memoryMap`, read-only archives are served from a memory mapping where the platform and
+	// archive allow it, and through libmpq otherwise. Must not be used for archives that get written to.
+	static std::optional<MpqArchive> Open(const char *path, int32_t &error, bool memoryMap = false);
+
+	// Returns a handle with its own read state for use on another thread.
+	// Clones of a memory mapped archive share the mapping and the decrypted tables, so they are cheap
+	// to create and any number of threads can decode files from the same archive at once.
+	// Cloning a memory mapped archive is itself safe while other threads read from it.
 	std::optional<MpqArchive> Clone(int32_t &error);
 
 	static const char *ErrorMessage(int32_t errorCode);
@@ -30,6 +39,9 @@ public:
 	    : path_(std::move(other.path_))
 	    , archive_(other.archive_)
 	    , tmp_buf_(std::move(other.tmp_buf_))
+	    , mapping_(std::move(other.mapping_))
+	    , sectorOffsets_(std::move(other.sectorOffsets_))
+	    , mappedFiles_(std::move(other.mappedFiles_))
 	{
 		other.archive_ = nullptr;
 	}
@@ -60,12 +72,21 @@ public:
 	bool HasFile(std::string_view filename) const;
 
 private:
+	std::unique_ptr<std::byte[]> ReadMappedFile(std::string_view filename, std::size_t &fileSize, int32_t &error);
+
 	MpqArchive(std::string path, mpq_archive_s *archive)
 	    : path_(std::move(path))
 	    , archive_(archive)
 	{
 	}
 
+	MpqArchive(std::string path, std::shared_ptr<const MpqMapping> mapping)
+	    : path_(std::move(path))
+	    , archive_(nullptr)
+	    , mapping_(std::move(mapping))
+	{
+	}
+
 	std::vector<std::uint8_t> &GetTemporaryBuffer(std::size_t size)
 	{
 		if (tmp_buf_.size() < size)
@@ -76,6 +97,18 @@ private:
 	std::string path_;
 	mpq_archive_s *archive_;
 	std::vector<std::uint8_t> tmp_buf_;
+
+	// Set instead of `archive_` when the archive is memory mapped.
+	std::shared_ptr<const MpqMapping> mapping_;
+	std::vector<uint32_t> sectorOffsets_;
+
+	struct MappedFile {
+		uint32_t key;
+		std::vector<uint32_t> sectorOffsets;
+		uint32_t refCount;
+	};
+	// Files with an open block offset table, by file number.
+	std::unordered_map<uint32_t, MappedFile> mappedFiles_;
 };
 
 } // namespace devilution
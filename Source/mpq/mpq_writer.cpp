@@ -2,10 +2,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
+#include <SDL.h>
 #include <SDL_endian.h>
 #include <libmpq/mpq.h>
 
@@ -14,6 +21,8 @@
 #include "utils/file_util.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/parallel_for.hpp"
+#include "utils/sdl_mutex.h"
 #include "utils/str_cat.hpp"
 
 namespace devilution {
@@ -61,6 +70,47 @@ constexpr uint32_t BlockSize = 512 << BlockSizeFactor; // 4096
 // Sometimes we can end up with smaller blocks.
 constexpr uint32_t MinBlockSize = 1024;
 
+// Files with fewer sectors are not worth starting worker threads for.
+constexpr uint32_t MinParallelSectors = 8;
+
+// The archive is compacted on close once this share of it is unused space...
+constexpr uint32_t CompactFreeSpacePercent = 25;
+// ...and there is at least this much to gain.
+constexpr uint32_t MinCompactFreeSpace = 64 * 1024;
+
+#ifdef BUILD_TESTING
+std::optional<uint32_t> CompactionCrashAfterFiles;
+#endif
+
+// Files written by the writers of this process, for archives that are not open right now.
+struct WrittenArchive {
+	// Size and tables of the archive when it was closed, to notice that it was replaced or copied over since.
+	uint32_t size;
+	uint64_t tablesDigest;
+	MpqWriter::WrittenFiles files;
+};
+
+// By archive path. Writers for different archives may open and close on different threads, e.g. autosaves.
+SdlMutex WrittenArchivesMutex;
+std::unordered_map<std::string, WrittenArchive> WrittenArchives;
+
+constexpr uint64_t DigestBasis = 14695981039346656037ULL;
+
+uint64_t Digest(const std::byte *data, size_t size, uint64_t hash = DigestBasis)
+{
+	// 64-bit FNV-1a
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<uint8_t>(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool SameBlock(const MpqBlockEntry &a, const MpqBlockEntry &b)
+{
+	return a.offset == b.offset && a.packedSize == b.packedSize && a.unpackedSize == b.unpackedSize && a.flags == b.flags;
+}
+
 void ByteSwapHdr(MpqFileHeader *hdr)
 {
 	hdr->signature = SDL_SwapLE32(hdr->signature);
@@ -124,6 +174,7 @@ MpqWriter::MpqWriter(const char *path)
 	}
 
 	name_ = path;
+	openTicks_ = SDL_GetTicks();
 
 	if (blockTable_ == nullptr || hashTable_ == nullptr) {
 		MpqFileHeader fhdr;
@@ -155,6 +206,8 @@ MpqWriter::MpqWriter(const char *path)
 			libmpq__decrypt_block(reinterpret_cast<uint32_t *>(hashTable_.get()), fhdr.hashEntriesCount * sizeof(MpqHashEntry), LIBMPQ_HASH_TABLE_HASH_KEY);
 		}
 
+		TakeWrittenFiles();
+
 #ifndef CAN_SEEKP_BEYOND_EOF
 		if (!stream_.Seekp(0, SEEK_SET))
 			goto on_error;
@@ -166,7 +219,7 @@ MpqWriter::MpqWriter(const char *path)
 		// Write garbage header and tables because some platforms cannot `Seekp` beyond EOF.
 		// The data is incorrect at this point, it will be overwritten on Close.
 		if (isNewFile)
-			WriteHeaderAndTables();
+			WriteHeaderAndTables(stream_);
 #endif
 	}
 	return;
@@ -180,16 +233,170 @@ MpqWriter::~MpqWriter()
 		return;
 	LogVerbose("Closing {}", name_);
 
+	if (!modified_) {
+		stream_.Close();
+		StoreWrittenFiles();
+		if (bytesSkipped_ != 0)
+			LogVerbose("Save {} unchanged, skipped {} bytes", name_, bytesSkipped_);
+		return;
+	}
+
+	if (CompactIfFragmented()) {
+		StoreWrittenFiles();
+		Log("Saved {} in {} ms: {} bytes written, {} unchanged bytes skipped", name_, SDL_GetTicks() - openTicks_, bytesWritten_, bytesSkipped_);
+		return;
+	}
+
 	bool result = true;
-	if (!(stream_.Seekp(0, SEEK_SET) && WriteHeaderAndTables()))
+	if (!(stream_.Seekp(0, SEEK_SET) && WriteHeaderAndTables(stream_)))
 		result = false;
+	bytesWritten_ += sizeof(MpqFileHeader) + BlockEntrySize + HashEntrySize;
 	stream_.Close();
 	if (result && size_ != 0) {
 		LogVerbose("ResizeFile(\"{}\", {})", name_, size_);
 		result = ResizeFile(name_.c_str(), size_);
 	}
-	if (!result)
+	if (result)
+		StoreWrittenFiles();
+	else
 		LogVerbose("Closing failed {}", name_);
+	Log("Saved {} in {} ms: {} bytes written, {} unchanged bytes skipped", name_, SDL_GetTicks() - openTicks_, bytesWritten_, bytesSkipped_);
+}
+
+bool MpqWriter::IsUnchanged(std::string_view filename, uint64_t digest, size_t size) const
+{
+	const uint32_t hIdx = FetchHandle(filename);
+	if (hIdx == HashEntryNotFound)
+		return false;
+
+	const auto file = writtenFiles_.find(std::string(filename));
+	if (file == writtenFiles_.end())
+		return false;
+
+	// Also compare the block in case the archive was replaced behind our back
+	const MpqBlockEntry &block = blockTable_[hashTable_[hIdx].block];
+	return file->second.digest == digest && block.unpackedSize == size && SameBlock(file->second.block, block);
+}
+
+uint64_t MpqWriter::TablesDigest() const
+{
+	const uint64_t digest = Digest(reinterpret_cast<const std::byte *>(blockTable_.get()), BlockEntrySize);
+	return Digest(reinterpret_cast<const std::byte *>(hashTable_.get()), HashEntrySize, digest);
+}
+
+void MpqWriter::TakeWrittenFiles()
+{
+	const std::lock_guard<SdlMutex> lock(WrittenArchivesMutex);
+	const auto archive = WrittenArchives.find(name_);
+	if (archive == WrittenArchives.end())
+		return;
+	// Taken even if the archive changed on disk, so another writer opening it meanwhile cannot use the entry either
+	WrittenArchive writtenArchive = std::move(archive->second);
+	WrittenArchives.erase(archive);
+	if (writtenArchive.size != size_ || writtenArchive.tablesDigest != TablesDigest()) {
+		LogVerbose("{} changed since it was last written, not skipping unchanged files", name_);
+		return;
+	}
+	writtenFiles_ = std::move(writtenArchive.files);
+}
+
+void MpqWriter::StoreWrittenFiles()
+{
+	const uint64_t tablesDigest = TablesDigest();
+	const std::lock_guard<SdlMutex> lock(WrittenArchivesMutex);
+	WrittenArchives[name_] = WrittenArchive { size_, tablesDigest, std::move(writtenFiles_) };
+}
+
+#ifdef BUILD_TESTING
+void MpqWriter::TestCrashNextCompaction(uint32_t files)
+{
+	CompactionCrashAfterFiles = files;
+}
+#endif
+
+bool MpqWriter::CompactIfFragmented()
+{
+	uint32_t freeSpace = 0;
+	std::vector<MpqBlockEntry *> blocks;
+	MpqBlockEntry *block = blockTable_.get();
+	for (unsigned i = 0; i < BlockEntriesCount; ++i, ++block) {
+		if (IsAllocatedUnusedBlock(block))
+			freeSpace += block->packedSize;
+		else if ((block->flags & MpqBlockEntry::FlagExists) != 0)
+			blocks.push_back(block);
+	}
+	if (freeSpace < MinCompactFreeSpace || freeSpace < static_cast<uint64_t>(size_) * CompactFreeSpacePercent / 100)
+		return false;
+
+	// Moving the files around in place would overwrite data the tables on disk still point to until they are rewritten,
+	// so the compacted archive goes to a copy that only replaces the archive once it is complete.
+	const std::string tempPath = name_ + ".tmp";
+	LoggedFStream temp;
+	if (!temp.Open(tempPath.c_str(), "wb"))
+		return false;
+
+	const std::unique_ptr<MpqBlockEntry[]> oldBlockTable { new MpqBlockEntry[BlockEntriesCount] };
+	memcpy(oldBlockTable.get(), blockTable_.get(), BlockEntrySize);
+	const uint32_t oldSize = size_;
+
+	block = blockTable_.get();
+	for (unsigned i = 0; i < BlockEntriesCount; ++i, ++block) {
+		if (IsAllocatedUnusedBlock(block))
+			memset(block, 0, sizeof(*block));
+	}
+	std::sort(blocks.begin(), blocks.end(), [](const MpqBlockEntry *a, const MpqBlockEntry *b) { return a->offset < b->offset; });
+	std::vector<uint32_t> oldOffsets;
+	oldOffsets.reserve(blocks.size());
+	uint32_t end = MpqHashEntryOffset + HashEntrySize;
+	for (MpqBlockEntry *fileBlock : blocks) {
+		oldOffsets.push_back(fileBlock->offset);
+		fileBlock->offset = end;
+		end += fileBlock->packedSize;
+	}
+	size_ = end;
+
+	bool ok = WriteHeaderAndTables(temp);
+	std::vector<char> buffer;
+	for (size_t i = 0; ok && i < blocks.size(); i++) {
+#ifdef BUILD_TESTING
+		if (CompactionCrashAfterFiles && i == *CompactionCrashAfterFiles) {
+			CompactionCrashAfterFiles = std::nullopt;
+			temp.Close();
+			stream_.Close();
+			writtenFiles_.clear();
+			return true;
+		}
+#endif
+		buffer.resize(blocks[i]->packedSize);
+		ok = stream_.Seekp(oldOffsets[i], SEEK_SET) && stream_.Read(buffer.data(), buffer.size())
+		    && temp.Write(buffer.data(), buffer.size());
+	}
+	ok = temp.Close() && ok;
+	if (ok) {
+		stream_.Close();
+		ok = devilution::RenameFile(tempPath.c_str(), name_.c_str());
+		if (!ok && !stream_.Open(name_.c_str(), "r+b"))
+			app_fatal(StrCat(_("Failed to open archive for writing."), "\n", name_));
+	}
+	if (!ok) {
+		LogError("Compacting {} failed", name_);
+		RemoveFile(tempPath.c_str());
+		memcpy(blockTable_.get(), oldBlockTable.get(), BlockEntrySize);
+		size_ = oldSize;
+		return false;
+	}
+	bytesWritten_ += end;
+	LogVerbose("Compacted {} from {} to {} bytes", name_, oldSize, end);
+
+	for (auto it = writtenFiles_.begin(); it != writtenFiles_.end();) {
+		const uint32_t hIdx = FetchHandle(it->first);
+		if (hIdx == HashEntryNotFound) {
+			it = writtenFiles_.erase(it);
+			continue;
+		}
+		it->second.block = blockTable_[hashTable_[hIdx].block];
+		++it;
+	}
 }
 
 uint32_t MpqWriter::FetchHandle(std::string_view filename) const
@@ -205,6 +412,7 @@ void MpqWriter::InitDefaultMpqHeader(MpqFileHeader *hdr)
 	hdr->blockSizeFactor = BlockSizeFactor;
 	hdr->version = 0;
 	size_ = MpqHashEntryOffset + HashEntrySize;
+	modified_ = true;
 }
 
 bool MpqWriter::IsValidMpqHeader(MpqFileHeader *hdr) const
@@ -337,9 +545,9 @@ uint32_t MpqWriter::GetHashIndex(MpqFileHash fileHash) const // NOLINT(bugprone-
 	return HashEntryNotFound;
 }
 
-bool MpqWriter::WriteHeaderAndTables()
+bool MpqWriter::WriteHeaderAndTables(LoggedFStream &stream)
 {
-	return WriteHeader() && WriteBlockTable() && WriteHashTable();
+	return WriteHeader(stream) && WriteBlockTable(stream) && WriteHashTable(stream);
 }
 
 MpqBlockEntry *MpqWriter::AddFile(std::string_view filename, MpqBlockEntry *block, uint32_t blockIndex)
@@ -383,13 +591,38 @@ bool MpqWriter::WriteFileContents(const std::byte *fileData, uint32_t fileSize,
 	block->unpackedSize = fileSize;
 	block->flags = MpqBlockEntry::FlagExists | MpqBlockEntry::CompressPkZip;
 
-	// We populate the table of sector offsets while we write the data.
-	// We can't pre-populate it because we don't know the compressed sector sizes yet.
+	// The block is assembled in a staging buffer: the table of sector offsets followed by the sectors.
+	// Each sector is compressed in its own BlockSize slot so that sectors can be compressed in parallel,
+	// compression never grows a sector so the slots are then packed together in place.
+	const std::unique_ptr<std::byte[]> staging { new std::byte[offsetTableByteSize + static_cast<size_t>(numSectors) * BlockSize] };
+	const std::unique_ptr<uint32_t[]> sectorSizes { new uint32_t[numSectors] };
+	std::byte *const sectors = &staging[offsetTableByteSize];
+	const auto compressSector = [&](size_t sector) {
+		std::byte *sectorData = &sectors[sector * BlockSize];
+		const uint32_t len = std::min<uint32_t>(fileSize - static_cast<uint32_t>(sector * BlockSize), BlockSize);
+		memcpy(sectorData, &fileData[sector * BlockSize], len);
+		sectorSizes[sector] = PkwareCompress(sectorData, len);
+	};
+	if (parallelCompression_ && numSectors >= MinParallelSectors) {
+		ParallelFor(numSectors, compressSector);
+	} else {
+		for (size_t sector = 0; sector < numSectors; sector++)
+			compressSector(sector);
+	}
+
 	// First offset is the start of the first sector, last offset is the end of the last sector.
-	const std::unique_ptr<uint32_t[]> offsetTable { new uint32_t[numSectors + 1] };
+	uint32_t destSize = offsetTableByteSize;
+	for (uint32_t sector = 0; sector <= numSectors; sector++) {
+		const uint32_t offset = SDL_SwapLE32(destSize);
+		memcpy(&staging[sector * sizeof(uint32_t)], &offset, sizeof(offset));
+		if (sector == numSectors)
+			break;
+		memmove(&staging[destSize], &sectors[sector * BlockSize], sectorSizes[sector]);
+		destSize += sectorSizes[sector];
+	}
 
 #ifdef CAN_SEEKP_BEYOND_EOF
-	if (!stream_.Seekp(block->offset + offsetTableByteSize, SEEK_SET))
+	if (!stream_.Seekp(block->offset, SEEK_SET))
 		return false;
 #else
 	// Ensure we do not Seekp beyond EOF by filling the missing space.
@@ -397,45 +630,19 @@ bool MpqWriter::WriteFileContents(const std::byte *fileData, uint32_t fileSize,
 	if (!stream_.Seekp(0, SEEK_END) || !stream_.Tellp(&stream_end))
 		return false;
 	const std::uintmax_t cur_size = stream_end - streamBegin_;
-	if (cur_size < block->offset + offsetTableByteSize) {
-		if (cur_size < block->offset) {
-			std::unique_ptr<char[]> filler { new char[block->offset - cur_size] };
-			if (!stream_.Write(filler.get(), block->offset - cur_size))
-				return false;
-		}
-		if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
+	if (cur_size < block->offset) {
+		std::unique_ptr<char[]> filler { new char[block->offset - cur_size] };
+		if (!stream_.Write(filler.get(), block->offset - cur_size))
 			return false;
 	} else {
-		if (!stream_.Seekp(block->offset + offsetTableByteSize, SEEK_SET))
+		if (!stream_.Seekp(block->offset, SEEK_SET))
 			return false;
 	}
 #endif
 
-	uint32_t destSize = offsetTableByteSize;
-	std::byte mpqBuf[BlockSize];
-	size_t curSector = 0;
-	while (true) {
-		uint32_t len = std::min<uint32_t>(fileSize, BlockSize);
-		memcpy(mpqBuf, fileData, len);
-		fileData += len;
-		len = PkwareCompress(mpqBuf, len);
-		if (!stream_.Write(reinterpret_cast<const char *>(&mpqBuf[0]), len))
-			return false;
-		offsetTable[curSector++] = SDL_SwapLE32(destSize);
-		destSize += len; // compressed length
-		if (fileSize <= BlockSize)
-			break;
-
-		fileSize -= BlockSize;
-	}
-
-	offsetTable[numSectors] = SDL_SwapLE32(destSize);
-	if (!stream_.Seekp(block->offset, SEEK_SET))
-		return false;
-	if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
-		return false;
-	if (!stream_.Seekp(destSize - offsetTableByteSize, SEEK_CUR))
+	if (!stream_.Write(reinterpret_cast<const char *>(staging.get()), destSize))
 		return false;
+	bytesWritten_ += destSize;
 
 	if (destSize < block->packedSize) {
 		const uint32_t remainingBlockSize = block->packedSize - destSize;
@@ -448,7 +655,7 @@ bool MpqWriter::WriteFileContents(const std::byte *fileData, uint32_t fileSize,
 	return true;
 }
 
-bool MpqWriter::WriteHeader()
+bool MpqWriter::WriteHeader(LoggedFStream &stream)
 {
 	MpqFileHeader fhdr;
 
@@ -464,21 +671,21 @@ bool MpqWriter::WriteHeader()
 	fhdr.blockEntriesCount = BlockEntriesCount;
 	ByteSwapHdr(&fhdr);
 
-	return stream_.Write(reinterpret_cast<const char *>(&fhdr), sizeof(fhdr));
+	return stream.Write(reinterpret_cast<const char *>(&fhdr), sizeof(fhdr));
 }
 
-bool MpqWriter::WriteBlockTable()
+bool MpqWriter::WriteBlockTable(LoggedFStream &stream)
 {
 	libmpq__encrypt_block(reinterpret_cast<uint32_t *>(blockTable_.get()), BlockEntrySize, LIBMPQ_BLOCK_TABLE_HASH_KEY);
-	const bool success = stream_.Write(reinterpret_cast<const char *>(blockTable_.get()), BlockEntrySize);
+	const bool success = stream.Write(reinterpret_cast<const char *>(blockTable_.get()), BlockEntrySize);
 	libmpq__decrypt_block(reinterpret_cast<uint32_t *>(blockTable_.get()), BlockEntrySize, LIBMPQ_BLOCK_TABLE_HASH_KEY);
 	return success;
 }
 
-bool MpqWriter::WriteHashTable()
+bool MpqWriter::WriteHashTable(LoggedFStream &stream)
 {
 	libmpq__encrypt_block(reinterpret_cast<uint32_t *>(hashTable_.get()), HashEntrySize, LIBMPQ_HASH_TABLE_HASH_KEY);
-	const bool success = stream_.Write(reinterpret_cast<const char *>(hashTable_.get()), HashEntrySize);
+	const bool success = stream.Write(reinterpret_cast<const char *>(hashTable_.get()), HashEntrySize);
 	libmpq__decrypt_block(reinterpret_cast<uint32_t *>(hashTable_.get()), HashEntrySize, LIBMPQ_HASH_TABLE_HASH_KEY);
 	return success;
 }
@@ -497,6 +704,9 @@ void MpqWriter::RemoveHashEntry(std::string_view filename)
 	const uint32_t blockSize = block->packedSize;
 	memset(block, 0, sizeof(*block));
 	AllocBlock(blockOffset, blockSize);
+	modified_ = true;
+
+	writtenFiles_.erase(std::string(filename));
 }
 
 void MpqWriter::RemoveHashEntries(bool (*fnGetName)(uint8_t, char *))
@@ -512,12 +722,20 @@ bool MpqWriter::WriteFile(std::string_view filename, const std::byte *data, size
 {
 	MpqBlockEntry *blockEntry;
 
+	const uint64_t digest = Digest(data, size);
+	if (IsUnchanged(filename, digest, size)) {
+		bytesSkipped_ += size;
+		return true;
+	}
+
 	RemoveHashEntry(filename);
 	blockEntry = AddFile(filename, nullptr, 0);
+	modified_ = true;
 	if (!WriteFileContents(data, static_cast<uint32_t>(size), blockEntry)) {
 		RemoveHashEntry(filename);
 		return false;
 	}
+	writtenFiles_[std::string(filename)] = WrittenFile { digest, *blockEntry };
 	return true;
 }
 
@@ -533,6 +751,16 @@ void MpqWriter::RenameFile(std::string_view name, std::string_view newName) // N
 	MpqBlockEntry *blockEntry = &blockTable_[block];
 	hashEntry->block = MpqHashEntry::DeletedBlock;
 	AddFile(newName, blockEntry, block);
+	modified_ = true;
+
+	const auto file = writtenFiles_.find(std::string(name));
+	if (file == writtenFiles_.end()) {
+		writtenFiles_.erase(std::string(newName));
+		return;
+	}
+	const WrittenFile writtenFile = file->second;
+	writtenFiles_.erase(file);
+	writtenFiles_[std::string(newName)] = writtenFile;
 }
 
 bool MpqWriter::HasFile(std::string_view name) const
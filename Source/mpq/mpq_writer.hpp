@@ -7,7 +7,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 #include "mpq/mpq_common.hpp"
 #include "utils/logged_fstream.hpp"
@@ -15,6 +17,12 @@
 namespace devilution {
 class MpqWriter {
 public:
+	struct WrittenFile {
+		uint64_t digest;
+		MpqBlockEntry block;
+	};
+	using WrittenFiles = std::unordered_map<std::string, WrittenFile>;
+
 	explicit MpqWriter(const char *path);
 	explicit MpqWriter(const std::string &path)
 	    : MpqWriter(path.c_str())
@@ -31,6 +39,23 @@ public:
 	bool WriteFile(std::string_view filename, const std::byte *data, size_t size);
 	void RenameFile(std::string_view name, std::string_view newName);
 
+	/**
+	 * @brief Compress the sectors of large files on worker threads, enabled by default.
+	 *
+	 * The archive is byte-identical either way.
+	 */
+	void SetParallelCompression(bool enabled)
+	{
+		parallelCompression_ = enabled;
+	}
+
+#ifdef BUILD_TESTING
+	/**
+	 * @brief Makes the next compaction stop after copying the given number of files, as if the game crashed there.
+	 */
+	static void TestCrashNextCompaction(uint32_t files);
+#endif
+
 private:
 	bool IsValidMpqHeader(MpqFileHeader *hdr) const;
 	uint32_t GetHashIndex(MpqFileHash fileHash) const;
@@ -49,17 +74,41 @@ private:
 	// Returns the file offset that is followed by empty space of at least the given size.
 	uint32_t FindFreeBlock(uint32_t size);
 
-	bool WriteHeaderAndTables();
-	bool WriteHeader();
-	bool WriteBlockTable();
-	bool WriteHashTable();
+	bool WriteHeaderAndTables(LoggedFStream &stream);
+	bool WriteHeader(LoggedFStream &stream);
+	bool WriteBlockTable(LoggedFStream &stream);
+	bool WriteHashTable(LoggedFStream &stream);
 	void InitDefaultMpqHeader(MpqFileHeader *hdr);
 
+	// Returns true if the files were last written by this process and have not changed since.
+	bool IsUnchanged(std::string_view filename, uint64_t digest, size_t size) const;
+
+	uint64_t TablesDigest() const;
+
+	// Picks up what earlier writers of this archive wrote, unless the archive changed on disk since they closed it.
+	void TakeWrittenFiles();
+
+	// Hands what was written on to the next writer of this archive.
+	void StoreWrittenFiles();
+
+	// Writes a copy of the archive without its unused space and puts it in place of the archive, if enough of it is unused.
+	// Returns true if the copy replaced the archive, which is then closed.
+	bool CompactIfFragmented();
+
 	LoggedFStream stream_;
 	std::string name_;
 	uint32_t size_ {};
 	std::unique_ptr<MpqHashEntry[]> hashTable_;
 	std::unique_ptr<MpqBlockEntry[]> blockTable_;
+	bool parallelCompression_ = true;
+	// Files written to this archive by this process, by file name.
+	// Used to skip rewriting files whose contents did not change, e.g. the hero on every autosave.
+	WrittenFiles writtenFiles_;
+	// Whether anything changed since the archive was opened, the tables are only rewritten if so.
+	bool modified_ = false;
+	uint32_t openTicks_ = 0;
+	size_t bytesWritten_ = 0;
+	size_t bytesSkipped_ = 0;
 
 // Amiga cannot Seekp beyond EOF.
 // See https://github.com/bebbo/libnix/issues/30
@@ -5,11 +5,13 @@
  */
 #include "msg.h"
 
+#include <atomic>
 #include <climits>
 #include <cmath>
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <fmt/format.h>
@@ -36,6 +38,7 @@
 #include "missiles.h"
 #include "monster.h"
 #include "monsters/validation.hpp"
+#include "multi.h"
 #include "nthread.h"
 #include "objects.h"
 #include "options.h"
@@ -52,6 +55,9 @@
 #include "towners.h"
 #include "utils/is_of.hpp"
 #include "utils/language.h"
+#include "utils/lz4_block.hpp"
+#include "utils/parallel_for.hpp"
+#include "utils/sdl_thread.h"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
 #include "utils/utf8.hpp"
@@ -231,6 +237,12 @@ struct DLevel {
 	ankerl::unordered_dense::map<WorldTilePosition, DObjectStr> object;
 	ankerl::unordered_dense::map<size_t, DSpawnedMonster> spawnedMonsters;
 	DMonsterStr monster[MaxMonsters];
+	/** @brief Changes every time the level is modified, see MarkDeltaLevelChanged */
+	uint32_t revision = 0;
+	/** @brief Revision of the level that compressedExport was generated from */
+	uint32_t compressedRevision = 0;
+	/** @brief Compressed CMD_DLEVEL payload, reused for late joiners while the level is unchanged */
+	std::vector<std::byte> compressedExport;
 };
 
 #pragma pack(push, 1)
@@ -271,6 +283,8 @@ uint32_t sgdwOwnerWait;
 uint32_t sgdwRecvOffset;
 int sgnCurrMegaPlayer;
 ankerl::unordered_dense::map<uint8_t, DLevel> DeltaLevels;
+/** @brief Source of DLevel::revision, shared by all levels so a recreated level never matches a stale export */
+uint32_t sgdwDeltaRevision;
 uint8_t sbLastCmd;
 
 /**
@@ -320,7 +334,11 @@ uint8_t GetLevelForMultiplayer(uint8_t level, bool isSetLevel)
 	return level;
 }
 
-/** @brief Gets a delta level. */
+/**
+ * @brief Gets a delta level, creating it if needed.
+ *
+ * Callers that modify the level have to call MarkDeltaLevelChanged afterwards.
+ */
 DLevel &GetDeltaLevel(uint8_t level)
 {
 	auto keyIt = DeltaLevels.find(level);
@@ -329,6 +347,7 @@ DLevel &GetDeltaLevel(uint8_t level)
 	DLevel &deltaLevel = DeltaLevels[level];
 	memset(&deltaLevel.item, 0xFF, sizeof(deltaLevel.item));
 	memset(&deltaLevel.monster, 0xFF, sizeof(deltaLevel.monster));
+	deltaLevel.revision = ++sgdwDeltaRevision;
 	return deltaLevel;
 }
 
@@ -339,6 +358,12 @@ DLevel &GetDeltaLevel(const Player &player)
 	return GetDeltaLevel(level);
 }
 
+/** @brief Gives the level a new revision, so a compressed export of its previous state is not reused. */
+void MarkDeltaLevelChanged(DLevel &deltaLevel)
+{
+	deltaLevel.revision = ++sgdwDeltaRevision;
+}
+
 Point GetItemPosition(Point position)
 {
 	if (CanPut(position))
@@ -749,35 +774,138 @@ const std::byte *DeltaImportJunk(const std::byte *src, const std::byte *end)
 	return src;
 }
 
+/** @brief Marker byte at the start of a level delta, tells how the rest of it is compressed. */
+enum class DeltaCompression : uint8_t {
+	None,
+	PkWare,
+	Lz4,
+};
+
 uint32_t CompressData(std::byte *buffer, std::byte *end)
 {
+	if (sgGameInitInfo.bLz4Deltas != 0) {
+		const size_t size = end - buffer - 1;
+		const size_t bound = Lz4CompressBound(size);
+		const std::unique_ptr<std::byte[]> compressed { new std::byte[bound] };
+		const size_t lz4Size = Lz4CompressBlock(buffer + 1, size, compressed.get(), bound);
+		if (lz4Size == 0 || lz4Size >= size) {
+			*buffer = static_cast<std::byte>(DeltaCompression::None);
+			return static_cast<uint32_t>(size + 1);
+		}
+		memcpy(buffer + 1, compressed.get(), lz4Size);
+		*buffer = static_cast<std::byte>(DeltaCompression::Lz4);
+		return static_cast<uint32_t>(lz4Size + 1);
+	}
+
 #ifdef USE_PKWARE
 	const auto size = static_cast<uint32_t>(end - buffer - 1);
 	const uint32_t pkSize = PkwareCompress(buffer + 1, size);
 
-	*buffer = size != pkSize ? std::byte { 1 } : std::byte { 0 };
+	*buffer = static_cast<std::byte>(size != pkSize ? DeltaCompression::PkWare : DeltaCompression::None);
 
 	return pkSize + 1;
 #else
-	*buffer = std::byte { 0 };
+	*buffer = static_cast<std::byte>(DeltaCompression::None);
 	return end - buffer;
 #endif
 }
 
+/** @brief A single CMD_DLEVEL, CMD_DLEVEL_JUNK or CMD_DLEVEL_END message queued for a joining player. */
+struct DeltaExportChunk {
+	_cmd_id cmd;
+	uint8_t level;
+	/** @brief Revision of the delta level the payload was serialized from */
+	uint32_t revision;
+	/** @brief Whether the payload still has to go through CompressData */
+	bool compress = false;
+	std::atomic_bool ready = false;
+	std::vector<std::byte> payload;
+};
+
+/**
+ * @brief Delta snapshot for a joining player.
+ *
+ * The snapshot is serialized on the game thread, then compressed on worker threads
+ * while the game keeps running. Finished chunks are sent in order by DeltaExportProcess.
+ */
+struct DeltaExport {
+	DeltaExport(uint8_t pnum, size_t chunkCount)
+	    : pnum(pnum)
+	    , chunkCount(chunkCount)
+	    , chunks(new DeltaExportChunk[chunkCount])
+	{
+	}
+
+	~DeltaExport()
+	{
+		cancelled = true;
+		worker.join();
+	}
+
+	DeltaExport(const DeltaExport &) = delete;
+	DeltaExport &operator=(const DeltaExport &) = delete;
+
+	uint8_t pnum;
+	size_t chunkCount;
+	std::unique_ptr<DeltaExportChunk[]> chunks;
+	/** @brief Indices of the chunks that have to be compressed by the worker */
+	std::vector<size_t> pending;
+	size_t chunksSent = 0;
+	std::atomic_bool cancelled = false;
+	SdlThread worker;
+};
+
+std::list<DeltaExport> DeltaExports;
+
+int SDLCALL CompressDeltaExport(void *data)
+{
+	auto &deltaExport = *static_cast<DeltaExport *>(data);
+	ParallelFor(deltaExport.pending.size(), [&deltaExport](size_t i) {
+		DeltaExportChunk &chunk = deltaExport.chunks[deltaExport.pending[i]];
+		if (!deltaExport.cancelled) {
+			const uint32_t size = CompressData(chunk.payload.data(), chunk.payload.data() + chunk.payload.size());
+			chunk.payload.resize(size);
+		}
+		chunk.ready = true;
+	});
+	return 0;
+}
+
+/** @brief Keeps the compressed payload of a level around until the level changes again. */
+void CacheDeltaExport(DeltaExportChunk &chunk)
+{
+	auto levelIt = DeltaLevels.find(chunk.level);
+	if (levelIt == DeltaLevels.end() || levelIt->second.revision != chunk.revision)
+		return;
+
+	DLevel &deltaLevel = levelIt->second;
+	deltaLevel.compressedExport = std::move(chunk.payload);
+	deltaLevel.compressedRevision = chunk.revision;
+}
+
 void DeltaImportData(_cmd_id cmd, uint32_t recvOffset, int pnum)
 {
 	size_t deltaSize = recvOffset;
 
+	if (sgRecvBuf[0] == static_cast<std::byte>(DeltaCompression::Lz4)) {
+		const std::unique_ptr<std::byte[]> decompressed { new std::byte[sizeof(sgRecvBuf) - 1] };
+		deltaSize = recvOffset > 1 ? Lz4DecompressBlock(&sgRecvBuf[1], recvOffset - 1, decompressed.get(), sizeof(sgRecvBuf) - 1) : 0;
+		if (deltaSize == 0) {
+			Log("LZ4 decompression failure, dropping player {}", pnum);
+			SNetDropPlayer(pnum, LEAVE_DROP);
+			return;
+		}
+		memcpy(&sgRecvBuf[1], decompressed.get(), deltaSize);
+	} else if (sgRecvBuf[0] != static_cast<std::byte>(DeltaCompression::None)) {
 #ifdef USE_PKWARE
-	if (sgRecvBuf[0] != std::byte { 0 }) {
 		deltaSize = PkwareDecompress(&sgRecvBuf[1], static_cast<uint32_t>(deltaSize), sizeof(sgRecvBuf) - 1);
 		if (deltaSize == 0) {
 			Log("PKWare decompression failure, dropping player {}", pnum);
 			SNetDropPlayer(pnum, LEAVE_DROP);
 			return;
 		}
-	}
 #endif
+	}
 
 	const std::byte *src = &sgRecvBuf[1];
 	const std::byte *end = src + deltaSize;
@@ -791,6 +919,7 @@ void DeltaImportData(_cmd_id cmd, uint32_t recvOffset, int pnum)
 		src = DeltaImportObjects(src, end, deltaLevel.object);
 		src = DeltaImportMonster(src, end, deltaLevel.monster);
 		src = DeltaImportSpawnedMonsters(src, end, deltaLevel.spawnedMonsters);
+		MarkDeltaLevelChanged(deltaLevel);
 	} else {
 		Log("Received invalid deltas, dropping player {}", pnum);
 		SNetDropPlayer(pnum, LEAVE_DROP);
@@ -880,6 +1009,7 @@ void DeltaLoadMonsters(const DLevel &deltaLevel)
 
 void DeltaLoadObjects(DLevel &deltaLevel)
 {
+	const size_t objectDeltaCount = deltaLevel.object.size();
 	for (auto it = deltaLevel.object.begin(); it != deltaLevel.object.end();) {
 		Object *object = FindObjectAtPosition(it->first);
 		if (object == nullptr) {
@@ -906,6 +1036,8 @@ void DeltaLoadObjects(DLevel &deltaLevel)
 			break;
 		}
 	}
+	if (deltaLevel.object.size() != objectDeltaCount)
+		MarkDeltaLevelChanged(deltaLevel);
 
 	for (int i = 0; i < ActiveObjectCount; i++) {
 		Object &object = Objects[ActiveObjects[i]];
@@ -1009,18 +1141,26 @@ void DeltaLeaveSync(uint8_t bLevel)
 
 	DLevel &deltaLevel = GetDeltaLevel(bLevel);
 
+	bool changed = false;
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
 		const unsigned ma = ActiveMonsters[i];
 		Monster &monster = Monsters[ma];
 		if (monster.hitPoints == 0)
 			continue;
 		DMonsterStr &delta = deltaLevel.monster[ma];
-		delta.position = monster.position.tile;
-		delta.menemy = encode_enemy(monster);
-		delta.hitPoints = monster.hitPoints;
-		delta.mactive = monster.activeForTicks;
-		delta.mWhoHit = monster.whoHit;
+		DMonsterStr updated = delta;
+		updated.position = monster.position.tile;
+		updated.menemy = encode_enemy(monster);
+		updated.hitPoints = monster.hitPoints;
+		updated.mactive = monster.activeForTicks;
+		updated.mWhoHit = monster.whoHit;
+		if (memcmp(&updated, &delta, sizeof(delta)) != 0) {
+			delta = updated;
+			changed = true;
+		}
 	}
+	if (changed)
+		MarkDeltaLevelChanged(deltaLevel);
 	LocalLevels.insert_or_assign(bLevel, AutomapView);
 }
 
@@ -1029,8 +1169,9 @@ void DeltaSyncObject(WorldTilePosition position, _cmd_id bCmd, const Player &pla
 	if (!gbIsMultiplayer)
 		return;
 
-	auto &objectDeltas = GetDeltaLevel(player).object;
-	objectDeltas[position].bCmd = bCmd;
+	DLevel &deltaLevel = GetDeltaLevel(player);
+	deltaLevel.object[position].bCmd = bCmd;
+	MarkDeltaLevelChanged(deltaLevel);
 }
 
 bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
@@ -1051,10 +1192,12 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 		}
 		if (item.bCmd == TCmdPItem::FloorItem) {
 			item.bCmd = TCmdPItem::PickedUpItem;
+			MarkDeltaLevelChanged(deltaLevel);
 			return true;
 		}
 		if (item.bCmd == TCmdPItem::DroppedItem) {
 			item.bCmd = CMD_INVALID;
+			MarkDeltaLevelChanged(deltaLevel);
 			return true;
 		}
 
@@ -1087,6 +1230,7 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 				delta.item.dwBuff = message.item.dwBuff;
 				delta.item.wToHit = message.item.wToHit;
 			}
+			MarkDeltaLevelChanged(deltaLevel);
 			break;
 		}
 	}
@@ -1120,6 +1264,7 @@ void DeltaPutItem(const TCmdPItem &message, Point position, const Player &player
 			item.bCmd = TCmdPItem::DroppedItem;
 			item.x = position.x;
 			item.y = position.y;
+			MarkDeltaLevelChanged(deltaLevel);
 			return;
 		}
 	}
@@ -2597,6 +2742,7 @@ size_t OnSpawnMonster(const TCmdSpawnMonster &message, const Player &player)
 	deltaMonster.hitPoints = -1;
 	deltaMonster.menemy = 0;
 	deltaMonster.mactive = 0;
+	MarkDeltaLevelChanged(deltaLevel);
 
 	if (player.isOnActiveLevel() && &player != MyPlayer)
 		InitializeSpawnedMonster(position, message.dir, typeIndex, monsterId, message.seed, golemOwnerPlayerId, golemSpellLevel);
@@ -2742,7 +2888,20 @@ void run_delta_info()
 
 void DeltaExportData(uint8_t pnum)
 {
+	DeltaExport &deltaExport = DeltaExports.emplace_back(pnum, DeltaLevels.size() + 2);
+	size_t chunkIndex = 0;
+
 	for (const auto &[levelNum, deltaLevel] : DeltaLevels) {
+		DeltaExportChunk &chunk = deltaExport.chunks[chunkIndex++];
+		chunk.cmd = CMD_DLEVEL;
+		chunk.level = levelNum;
+		chunk.revision = deltaLevel.revision;
+		if (deltaLevel.compressedRevision == deltaLevel.revision && !deltaLevel.compressedExport.empty()) {
+			chunk.payload = deltaLevel.compressedExport;
+			chunk.ready = true;
+			continue;
+		}
+
 		const size_t bufferSize = 1U                                                            /* marker byte, always 0 */
 		    + sizeof(uint8_t)                                                                   /* level id */
 		    + sizeof(deltaLevel.item)                                                           /* items spawned during dungeon generation which have been picked up, and items dropped by a player during a game */
@@ -2751,32 +2910,69 @@ void DeltaExportData(uint8_t pnum)
 		    + sizeof(deltaLevel.monster)                                                        /* latest monster state */
 		    + sizeof(uint16_t)                                                                  /* spawned monster count */
 		    + (sizeof(uint16_t) + sizeof(DSpawnedMonster)) * deltaLevel.spawnedMonsters.size(); /* spawned monsters */
-		const std::unique_ptr<std::byte[]> dst { new std::byte[bufferSize] };
+		chunk.payload.resize(bufferSize);
 
-		std::byte *dstEnd = &dst.get()[1];
+		std::byte *dst = chunk.payload.data();
+		std::byte *dstEnd = &dst[1];
 		*dstEnd = static_cast<std::byte>(levelNum);
 		dstEnd += sizeof(uint8_t);
 		dstEnd = DeltaExportItem(dstEnd, deltaLevel.item);
 		dstEnd = DeltaExportObject(dstEnd, deltaLevel.object);
 		dstEnd = DeltaExportMonster(dstEnd, deltaLevel.monster);
 		dstEnd = DeltaExportSpawnedMonsters(dstEnd, deltaLevel.spawnedMonsters);
-		const uint32_t size = CompressData(dst.get(), dstEnd);
-		multi_send_zero_packet(pnum, CMD_DLEVEL, dst.get(), size);
-	}
+		chunk.payload.resize(dstEnd - dst);
+		chunk.compress = true;
+		deltaExport.pending.push_back(chunkIndex - 1);
+	}
+
+	DeltaExportChunk &junk = deltaExport.chunks[chunkIndex++];
+	junk.cmd = CMD_DLEVEL_JUNK;
+	junk.payload.resize(sizeof(DJunk) + 1);
+	std::byte *dstEnd = DeltaExportJunk(&junk.payload[1]);
+	junk.payload.resize(dstEnd - junk.payload.data());
+	junk.compress = true;
+	deltaExport.pending.push_back(chunkIndex - 1);
+
+	DeltaExportChunk &end = deltaExport.chunks[chunkIndex++];
+	end.cmd = CMD_DLEVEL_END;
+	end.payload.push_back(std::byte { 0 });
+	end.ready = true;
+
+	deltaExport.worker = SdlThread(CompressDeltaExport, &deltaExport);
+	DeltaExportProcess();
+}
+
+void DeltaExportProcess()
+{
+	for (auto it = DeltaExports.begin(); it != DeltaExports.end();) {
+		DeltaExport &deltaExport = *it;
+		while (deltaExport.chunksSent < deltaExport.chunkCount) {
+			DeltaExportChunk &chunk = deltaExport.chunks[deltaExport.chunksSent];
+			if (!chunk.ready)
+				break;
+			multi_send_zero_packet(deltaExport.pnum, chunk.cmd, chunk.payload.data(), static_cast<uint32_t>(chunk.payload.size()));
+			if (chunk.cmd == CMD_DLEVEL && chunk.compress)
+				CacheDeltaExport(chunk);
+			chunk.payload = {};
+			deltaExport.chunksSent++;
+		}
 
-	std::byte dst[sizeof(DJunk) + 1];
-	std::byte *dstEnd = &dst[1];
-	dstEnd = DeltaExportJunk(dstEnd);
-	const uint32_t size = CompressData(dst, dstEnd);
-	multi_send_zero_packet(pnum, CMD_DLEVEL_JUNK, dst, size);
+		if (deltaExport.chunksSent == deltaExport.chunkCount)
+			it = DeltaExports.erase(it);
+		else
+			++it;
+	}
+}
 
-	std::byte src[1] = { static_cast<std::byte>(0) };
-	multi_send_zero_packet(pnum, CMD_DLEVEL_END, src, 1);
+void DeltaExportCancel(uint8_t pnum)
+{
+	DeltaExports.remove_if([pnum](const DeltaExport &deltaExport) { return deltaExport.pnum == pnum; });
 }
 
 void delta_init()
 {
 	memset(&sgJunk, 0xFF, sizeof(sgJunk));
+	DeltaExports.clear();
 	DeltaLevels.clear();
 	LocalLevels.clear();
 }
@@ -2792,9 +2988,11 @@ void delta_kill_monster(const Monster &monster, Point position, const Player &pl
 	if (!gbIsMultiplayer)
 		return;
 
-	DMonsterStr *pD = &GetDeltaLevel(player).monster[monster.getId()];
+	DLevel &deltaLevel = GetDeltaLevel(player);
+	DMonsterStr *pD = &deltaLevel.monster[monster.getId()];
 	pD->position = position;
 	pD->hitPoints = 0;
+	MarkDeltaLevelChanged(deltaLevel);
 }
 
 void delta_monster_hp(const Monster &monster, const Player &player)
@@ -2802,9 +3000,12 @@ void delta_monster_hp(const Monster &monster, const Player &player)
 	if (!gbIsMultiplayer)
 		return;
 
-	DMonsterStr *pD = &GetDeltaLevel(player).monster[monster.getId()];
-	if (SDL_SwapLE32(pD->hitPoints) > monster.hitPoints)
+	DLevel &deltaLevel = GetDeltaLevel(player);
+	DMonsterStr *pD = &deltaLevel.monster[monster.getId()];
+	if (SDL_SwapLE32(pD->hitPoints) > monster.hitPoints) {
 		pD->hitPoints = SDL_SwapLE32(monster.hitPoints);
+		MarkDeltaLevelChanged(deltaLevel);
+	}
 }
 
 void delta_sync_monster(const TSyncMonster &monsterSync, uint8_t level)
@@ -2814,16 +3015,23 @@ void delta_sync_monster(const TSyncMonster &monsterSync, uint8_t level)
 
 	assert(level <= MaxMultiplayerLevels);
 
-	DMonsterStr &monster = GetDeltaLevel(level).monster[monsterSync._mndx];
+	DLevel &deltaLevel = GetDeltaLevel(level);
+	DMonsterStr &monster = deltaLevel.monster[monsterSync._mndx];
 	if (monster.hitPoints == 0)
 		return;
 
-	monster.position.x = monsterSync._mx;
-	monster.position.y = monsterSync._my;
-	monster.mactive = UINT8_MAX;
-	monster.menemy = monsterSync._menemy;
-	monster.hitPoints = monsterSync._mhitpoints;
-	monster.mWhoHit = monsterSync.mWhoHit;
+	DMonsterStr updated = monster;
+	updated.position.x = monsterSync._mx;
+	updated.position.y = monsterSync._my;
+	updated.mactive = UINT8_MAX;
+	updated.menemy = monsterSync._menemy;
+	updated.hitPoints = monsterSync._mhitpoints;
+	updated.mWhoHit = monsterSync.mWhoHit;
+	// Most sync messages repeat what the delta already holds, keep the cached export for those
+	if (memcmp(&updated, &monster, sizeof(monster)) == 0)
+		return;
+	monster = updated;
+	MarkDeltaLevelChanged(deltaLevel);
 }
 
 void DeltaSyncJunk()
@@ -2884,6 +3092,7 @@ void DeltaAddItem(int ii)
 		delta.x = Items[ii].position.x;
 		delta.y = Items[ii].position.y;
 		PrepareItemForNetwork(Items[ii], delta);
+		MarkDeltaLevelChanged(deltaLevel);
 		return;
 	}
 }
@@ -3480,4 +3689,15 @@ size_t ParseCmd(uint8_t pnum, const TCmd *pCmd, size_t maxCmdSize)
 	return HandleCmd(OnLevelData, player, pCmd, maxCmdSize);
 }
 
+#ifdef BUILD_TESTING
+bool TestIsDeltaExportCached(uint8_t level)
+{
+	auto levelIt = DeltaLevels.find(level);
+	if (levelIt == DeltaLevels.end())
+		return false;
+	const DLevel &deltaLevel = levelIt->second;
+	return deltaLevel.compressedRevision == deltaLevel.revision && !deltaLevel.compressedExport.empty();
+}
+#endif
+
 } // namespace devilution
@@ -13,6 +13,7 @@
 #include "objects.h"
 #include "portal.h"
 #include "quests.h"
+#include "utils/enum_traits.h"
 
 namespace devilution {
 
@@ -704,6 +705,39 @@ struct TPktHdr {
 	uint16_t wLen;
 };
 
+/**
+ * @brief Groups of TPktHdr fields that are present after a TPktDeltaHdr.
+ */
+enum class PktHdrFields : uint8_t {
+	// clang-format off
+	None         = 0,
+	Position     = 1 << 0, // px, py
+	Target       = 1 << 1, // targx, targy
+	HitPoints    = 1 << 2, // php
+	MaxHitPoints = 1 << 3, // pmhp
+	Mana         = 1 << 4, // mana
+	MaxMana      = 1 << 5, // maxmana
+	BaseStats    = 1 << 6, // bstr, bmag, bdex
+	All          = Position | Target | HitPoints | MaxHitPoints | Mana | MaxMana | BaseStats,
+	/** @brief All fields are present and replace the keyframe stored for the sending player. */
+	Keyframe     = 1 << 7,
+	// clang-format on
+};
+use_enum_as_flags(PktHdrFields);
+
+/**
+ * @brief Replacement for TPktHdr used when the game was created with GameData::bDeltaPlayerHeader.
+ *
+ * The field groups flagged in bFields follow in TPktHdr declaration order, all other
+ * fields keep the value of the last keyframe received from the same player.
+ */
+struct TPktDeltaHdr {
+	/** @brief Id of the referenced keyframe with the high bit set, so it can't be mistaken for TPktHdr::px. */
+	uint8_t bKeyframe;
+	PktHdrFields bFields;
+	uint16_t wLen;
+};
+
 struct TPkt {
 	TPktHdr hdr;
 	std::byte body[493];
@@ -720,6 +754,10 @@ void msg_send_drop_pkt(uint8_t pnum, int reason);
 bool msg_wait_resync();
 void run_delta_info();
 void DeltaExportData(uint8_t pnum);
+/** @brief Sends the level deltas that finished compressing to joining players. */
+void DeltaExportProcess();
+/** @brief Drops any level deltas still queued for the given player. */
+void DeltaExportCancel(uint8_t pnum);
 void DeltaSyncJunk();
 void delta_init();
 void DeltaClearLevel(uint8_t level);
@@ -759,4 +797,9 @@ void delta_close_portal(const Player &player);
 bool ValidateCmdSize(size_t requiredCmdSize, size_t maxCmdSize, size_t playerId);
 size_t ParseCmd(uint8_t pnum, const TCmd *pCmd, size_t maxCmdSize);
 
+#ifdef BUILD_TESTING
+/** @brief Returns whether DeltaExportData would send the level's cached compressed export instead of compressing it again. */
+bool TestIsDeltaExportCached(uint8_t level);
+#endif
+
 } // namespace devilution
@@ -53,6 +53,7 @@ bool gbSelectProvider;
 int sglTimeoutStart;
 uint32_t sgdwPlayerLeftReasonTbl[MAX_PLRS];
 uint32_t sgdwGameLoops;
+uint32_t sgbSentThisCycle;
 /**
  * Specifies the maximum number of players in a game, where 1
  * represents a single player game and 4 represents a multi player game.
@@ -105,7 +106,212 @@ constexpr uint16_t HeaderCheckVal =
     LoadLE16("ip");
 #endif
 
-uint32_t sgbSentThisCycle;
+/** Number of broadcast packets after which the local player sends a new keyframe. */
+constexpr uint8_t DeltaHeaderKeyframeInterval = 32;
+/** TPktDeltaHdr::bKeyframe of packets that don't carry any player data. */
+constexpr uint8_t NoKeyframe = 0xFF;
+
+/** Last keyframe broadcast by the local player, the base of all following delta headers. */
+TPktHdr sgKeyframeHdr;
+uint8_t sgbKeyframeId;
+uint8_t sgbPacketsSinceKeyframe;
+
+struct ReceivedKeyframe {
+	bool valid;
+	uint8_t id;
+	TPktHdr hdr;
+};
+
+/** Last keyframe received from each player. */
+ReceivedKeyframe sgReceivedKeyframes[MAX_PLRS];
+
+void InitDeltaHeaders()
+{
+	sgbKeyframeId = 0;
+	sgbPacketsSinceKeyframe = DeltaHeaderKeyframeInterval;
+	for (ReceivedKeyframe &keyframe : sgReceivedKeyframes)
+		keyframe.valid = false;
+}
+
+/**
+ * @brief Calls the visitor with the offset and size of every TPktHdr field that belongs to one of the given groups, in the order they are sent.
+ */
+template <typename Visitor>
+void VisitHeaderFields(PktHdrFields fields, Visitor &&visit)
+{
+#define VISIT_FIELD(field) visit(offsetof(TPktHdr, field), sizeof(TPktHdr::field))
+	if (HasAnyOf(fields, PktHdrFields::Position)) {
+		VISIT_FIELD(px);
+		VISIT_FIELD(py);
+	}
+	if (HasAnyOf(fields, PktHdrFields::Target)) {
+		VISIT_FIELD(targx);
+		VISIT_FIELD(targy);
+	}
+	if (HasAnyOf(fields, PktHdrFields::HitPoints))
+		VISIT_FIELD(php);
+	if (HasAnyOf(fields, PktHdrFields::MaxHitPoints))
+		VISIT_FIELD(pmhp);
+	if (HasAnyOf(fields, PktHdrFields::Mana))
+		VISIT_FIELD(mana);
+	if (HasAnyOf(fields, PktHdrFields::MaxMana))
+		VISIT_FIELD(maxmana);
+	if (HasAnyOf(fields, PktHdrFields::BaseStats)) {
+		VISIT_FIELD(bstr);
+		VISIT_FIELD(bmag);
+		VISIT_FIELD(bdex);
+	}
+#undef VISIT_FIELD
+}
+
+size_t GetHeaderFieldsSize(PktHdrFields fields)
+{
+	size_t size = 0;
+	VisitHeaderFields(fields, [&](size_t /*offset*/, size_t fieldSize) { size += fieldSize; });
+	return size;
+}
+
+size_t WriteHeaderFields(PktHdrFields fields, const TPktHdr &hdr, std::byte *data)
+{
+	size_t size = 0;
+	VisitHeaderFields(fields, [&](size_t offset, size_t fieldSize) {
+		memcpy(&data[size], reinterpret_cast<const std::byte *>(&hdr) + offset, fieldSize);
+		size += fieldSize;
+	});
+	return size;
+}
+
+void ReadHeaderFields(PktHdrFields fields, TPktHdr &hdr, const std::byte *data)
+{
+	size_t size = 0;
+	VisitHeaderFields(fields, [&](size_t offset, size_t fieldSize) {
+		memcpy(reinterpret_cast<std::byte *>(&hdr) + offset, &data[size], fieldSize);
+		size += fieldSize;
+	});
+}
+
+/**
+ * @brief Determines which field groups of a header differ from the given base.
+ */
+PktHdrFields GetChangedHeaderFields(const TPktHdr &hdr, const TPktHdr &base)
+{
+	PktHdrFields fields = PktHdrFields::None;
+	if (hdr.px != base.px || hdr.py != base.py)
+		fields |= PktHdrFields::Position;
+	if (hdr.targx != base.targx || hdr.targy != base.targy)
+		fields |= PktHdrFields::Target;
+	if (hdr.php != base.php)
+		fields |= PktHdrFields::HitPoints;
+	if (hdr.pmhp != base.pmhp)
+		fields |= PktHdrFields::MaxHitPoints;
+	if (hdr.mana != base.mana)
+		fields |= PktHdrFields::Mana;
+	if (hdr.maxmana != base.maxmana)
+		fields |= PktHdrFields::MaxMana;
+	if (hdr.bstr != base.bstr || hdr.bmag != base.bmag || hdr.bdex != base.bdex)
+		fields |= PktHdrFields::BaseStats;
+	return fields;
+}
+
+/**
+ * @brief Replaces the full header of a packet by a TPktDeltaHdr if the game uses delta player headers.
+ *
+ * Keyframes are only sent with broadcasts so all players share the same base for the following deltas.
+ *
+ * @param pkt Packet consisting of a complete TPktHdr and the body
+ * @param len Length of the packet including the full header
+ * @param playerId Receiver of the packet
+ * @param hasPlayerData Whether the header was filled by NetReceivePlayerData()
+ * @return Length of the packet to send
+ */
+size_t EncodePacketHeader(TPkt &pkt, size_t len, uint8_t playerId, bool hasPlayerData = true)
+{
+	// Messages to ourselves never reach the network so there is nothing to save
+	if (sgGameInitInfo.bDeltaPlayerHeader == 0 || playerId == MyPlayerId)
+		return len;
+
+	TPktDeltaHdr deltaHdr;
+	deltaHdr.bKeyframe = NoKeyframe;
+	deltaHdr.bFields = PktHdrFields::None;
+	if (hasPlayerData) {
+		if (playerId == SNPLAYER_OTHERS && sgbPacketsSinceKeyframe >= DeltaHeaderKeyframeInterval) {
+			sgbKeyframeId = (sgbKeyframeId + 1) % (NoKeyframe & 0x7F);
+			sgbPacketsSinceKeyframe = 0;
+			sgKeyframeHdr = pkt.hdr;
+			deltaHdr.bFields = PktHdrFields::All | PktHdrFields::Keyframe;
+		} else {
+			deltaHdr.bFields = GetChangedHeaderFields(pkt.hdr, sgKeyframeHdr);
+		}
+		if (playerId == SNPLAYER_OTHERS)
+			sgbPacketsSinceKeyframe++;
+		deltaHdr.bKeyframe = 0x80 | sgbKeyframeId;
+	}
+
+	std::byte fields[sizeof(TPktHdr)];
+	const size_t fieldsSize = WriteHeaderFields(deltaHdr.bFields, pkt.hdr, fields);
+	const size_t hdrSize = sizeof(deltaHdr) + fieldsSize;
+	const size_t bodySize = len - sizeof(TPktHdr);
+	deltaHdr.wLen = SDL_SwapLE16(static_cast<uint16_t>(hdrSize + bodySize));
+
+	auto *data = reinterpret_cast<std::byte *>(&pkt);
+	memmove(&data[hdrSize], pkt.body, bodySize);
+	memcpy(data, &deltaHdr, sizeof(deltaHdr));
+	memcpy(&data[sizeof(deltaHdr)], fields, fieldsSize);
+	return hdrSize + bodySize;
+}
+
+/**
+ * @brief Restores the full header of a received packet.
+ * @param playerId Sender of the packet
+ * @param data Received packet
+ * @param size Size of the received packet
+ * @param hdr Receives the full header
+ * @param hasPlayerData Set to false if the header doesn't contain usable player data
+ * @return Size of the header in the packet, 0 if the packet is invalid
+ */
+size_t DecodePacketHeader(uint8_t playerId, const std::byte *data, size_t size, TPktHdr &hdr, bool &hasPlayerData)
+{
+	hasPlayerData = true;
+	if (size == 0)
+		return 0;
+	if ((static_cast<uint8_t>(data[0]) & 0x80) == 0) {
+		if (size < sizeof(TPktHdr))
+			return 0;
+		memcpy(&hdr, data, sizeof(hdr));
+		if (hdr.wCheck != HeaderCheckVal || SDL_SwapLE16(hdr.wLen) != size)
+			return 0;
+		return sizeof(TPktHdr);
+	}
+
+	TPktDeltaHdr deltaHdr;
+	if (sgGameInitInfo.bDeltaPlayerHeader == 0 || size < sizeof(deltaHdr))
+		return 0;
+	memcpy(&deltaHdr, data, sizeof(deltaHdr));
+	if (SDL_SwapLE16(deltaHdr.wLen) != size)
+		return 0;
+	const size_t hdrSize = sizeof(deltaHdr) + GetHeaderFieldsSize(deltaHdr.bFields);
+	if (hdrSize > size)
+		return 0;
+
+	ReceivedKeyframe &keyframe = sgReceivedKeyframes[playerId];
+	const uint8_t keyframeId = deltaHdr.bKeyframe & 0x7F;
+	const bool isKeyframe = HasAnyOf(deltaHdr.bFields, PktHdrFields::Keyframe);
+	if (isKeyframe) {
+		if (!HasAllOf(deltaHdr.bFields, PktHdrFields::All))
+			return 0;
+		ReadHeaderFields(deltaHdr.bFields, hdr, &data[sizeof(deltaHdr)]);
+		keyframe.valid = true;
+		keyframe.id = keyframeId;
+		keyframe.hdr = hdr;
+	} else if (deltaHdr.bKeyframe != NoKeyframe && keyframe.valid && keyframe.id == keyframeId) {
+		hdr = keyframe.hdr;
+		ReadHeaderFields(deltaHdr.bFields, hdr, &data[sizeof(deltaHdr)]);
+	} else {
+		// Without the matching keyframe only the body of the packet can be used
+		hasPlayerData = false;
+	}
+	return hdrSize;
+}
 
 void BufferInit(TBuffer *pBuf)
 {
@@ -222,7 +428,8 @@ void SendPacket(uint8_t playerId, const std::byte *packet, size_t size)
 	const size_t sizeWithheader = size + sizeof(pkt.hdr);
 	pkt.hdr.wLen = SDL_SwapLE16(static_cast<uint16_t>(sizeWithheader));
 	memcpy(pkt.body, packet, size);
-	if (!SNetSendMessage(playerId, &pkt.hdr, sizeWithheader))
+	const size_t len = EncodePacketHeader(pkt, sizeWithheader, playerId);
+	if (!SNetSendMessage(playerId, &pkt.hdr, len))
 		nthread_terminate_game("SNetSendMessage0");
 }
 
@@ -255,7 +462,10 @@ void ParseTurn(uint8_t pnum, uint32_t turn)
 	if ((turn & 0x80000000) != 0)
 		HandleTurnUpperBit(pnum);
 	uint32_t absTurns = turn & 0x7FFFFFFF;
-	if (sgbSentThisCycle < gdwTurnsInTransit + absTurns) {
+	// Only resync once the other player's turn counter caught up with ours, i.e. when joining.
+	// Comparing against gdwTurnsInTransit would also fire right after the turn pacing grew the queue,
+	// before the extra turns are sent, and resetting sgdwGameLoops mid-game desyncs the game.
+	if (sgbSentThisCycle <= absTurns) {
 		if (absTurns >= 0x7FFFFFFF)
 			absTurns &= 0xFFFF;
 		sgbSentThisCycle = absTurns + gdwTurnsInTransit;
@@ -424,6 +634,8 @@ void HandleEvents(_SNETEVENT *pEvt)
 			gbSomebodyWonGameKludge = true;
 
 		sgbSendDeltaTbl[playerId] = false;
+		sgReceivedKeyframes[playerId].valid = false;
+		DeltaExportCancel(playerId);
 
 		if (gbDeltaSender == playerId)
 			gbDeltaSender = MAX_PLRS;
@@ -529,6 +741,8 @@ void InitGameInfo()
 	sgGameInitInfo.bCowQuest = *options.Gameplay.cowQuest ? 1 : 0;
 	sgGameInitInfo.bFriendlyFire = *options.Gameplay.friendlyFire ? 1 : 0;
 	sgGameInitInfo.fullQuests = (!gbIsMultiplayer || *options.Gameplay.multiplayerFullQuests) ? 1 : 0;
+	sgGameInitInfo.bDeltaPlayerHeader = *options.Network.deltaPlayerHeader ? 1 : 0;
+	sgGameInitInfo.bLz4Deltas = *options.Network.lz4Deltas ? 1 : 0;
 }
 
 void NetSendLoPri(uint8_t playerId, const std::byte *data, size_t size)
@@ -554,8 +768,9 @@ void NetSendHiPri(uint8_t playerId, const std::byte *data, size_t size)
 		destination = CopyBufferedPackets(destination, &highPriorityBuffer, &remainingSpace);
 		destination = CopyBufferedPackets(destination, &lowPriorityBuffer, &remainingSpace);
 		remainingSpace = sync_all_monsters(destination, remainingSpace);
-		const size_t len = gdwNormalMsgSize - remainingSpace;
+		size_t len = gdwNormalMsgSize - remainingSpace;
 		pkt.hdr.wLen = SDL_SwapLE16(static_cast<uint16_t>(len));
+		len = EncodePacketHeader(pkt, len, SNPLAYER_OTHERS);
 		if (!SNetSendMessage(SNPLAYER_OTHERS, &pkt.hdr, len))
 			nthread_terminate_game("SNetSendMessage");
 	}
@@ -571,7 +786,9 @@ void multi_send_msg_packet(uint32_t pmask, const std::byte *data, size_t size)
 	uint8_t playerID = 0;
 	for (uint32_t v = 1; playerID < Players.size(); playerID++, v <<= 1) {
 		if ((v & pmask) != 0) {
-			if (!SNetSendMessage(playerID, &pkt.hdr, len)) {
+			TPkt playerPkt = pkt;
+			const size_t playerLen = EncodePacketHeader(playerPkt, len, playerID);
+			if (!SNetSendMessage(playerID, &playerPkt.hdr, playerLen)) {
 				nthread_terminate_game("SNetSendMessage");
 				return;
 			}
@@ -615,6 +832,7 @@ bool multi_handle_delta()
 			DeltaExportData(i);
 		}
 	}
+	DeltaExportProcess();
 
 	sgbSentThisCycle = nthread_send_and_recv_turn(sgbSentThisCycle, 1);
 	bool received;
@@ -649,28 +867,33 @@ void multi_process_network_packets()
 	ProcessTmsgs();
 
 	uint8_t playerId = std::numeric_limits<uint8_t>::max();
-	TPktHdr *pkt;
+	void *data;
 	size_t dwMsgSize = 0;
-	while (SNetReceiveMessage(&playerId, (void **)&pkt, &dwMsgSize)) {
+	while (SNetReceiveMessage(&playerId, &data, &dwMsgSize)) {
 		dwRecCount++;
 		ClearPlayerLeftState();
-		if (dwMsgSize < sizeof(TPktHdr))
-			continue;
 		if (playerId >= Players.size())
 			continue;
-		if (pkt->wCheck != HeaderCheckVal)
-			continue;
-		if (SDL_SwapLE16(pkt->wLen) != dwMsgSize)
+		TPktHdr hdr;
+		bool hasPlayerData;
+		const size_t hdrSize = DecodePacketHeader(playerId, static_cast<const std::byte *>(data), dwMsgSize, hdr, hasPlayerData);
+		if (hdrSize == 0)
 			continue;
+		const std::byte *body = static_cast<const std::byte *>(data) + hdrSize;
 		Player &player = Players[playerId];
 		if (!IsNetPlayerValid(player)) {
-			const _cmd_id cmd = *(const _cmd_id *)(pkt + 1);
+			const _cmd_id cmd = *(const _cmd_id *)body;
 			if (gbBufferMsgs == 0 && IsNoneOf(cmd, CMD_SEND_PLRINFO, CMD_ACK_PLRINFO)) {
 				// Distrust all messages until
 				// player info is received
 				continue;
 			}
 		}
+		if (!hasPlayerData) {
+			HandleAllPackets(playerId, body, dwMsgSize - hdrSize);
+			continue;
+		}
+		const TPktHdr *pkt = &hdr;
 		const Point syncPosition = { pkt->px, pkt->py };
 		player.position.last = syncPosition;
 		if (&player != MyPlayer) {
@@ -712,7 +935,7 @@ void multi_process_network_packets()
 				}
 			}
 		}
-		HandleAllPackets(playerId, (const std::byte *)(pkt + 1), dwMsgSize - sizeof(TPktHdr));
+		HandleAllPackets(playerId, body, dwMsgSize - hdrSize);
 	}
 	CheckPlayerInfoTimeouts();
 }
@@ -741,8 +964,9 @@ void multi_send_zero_packet(uint8_t pnum, _cmd_id bCmd, const std::byte *data, s
 		const size_t dwMsg = sizeof(pkt.hdr) + sizeof(message) + dwBody;
 		assert(dwMsg <= 0x0ffff);
 		pkt.hdr.wLen = SDL_SwapLE16(static_cast<uint16_t>(dwMsg));
+		const size_t len = EncodePacketHeader(pkt, dwMsg, pnum, /*hasPlayerData=*/false);
 
-		if (!SNetSendMessage(pnum, &pkt, dwMsg)) {
+		if (!SNetSendMessage(pnum, &pkt, len)) {
 			nthread_terminate_game("SNetSendMessage2");
 			return;
 		}
@@ -758,6 +982,8 @@ void NetClose()
 	}
 
 	sgbNetInited = false;
+	for (uint8_t i = 0; i < MAX_PLRS; i++)
+		DeltaExportCancel(i);
 	nthread_cleanup();
 	tmsg_cleanup();
 	UnregisterNetEventHandlers();
@@ -798,6 +1024,7 @@ bool NetInit(bool bSinglePlayer)
 		BufferInit(&highPriorityBuffer);
 		BufferInit(&lowPriorityBuffer);
 		shareNextHighPriorityMessage = true;
+		InitDeltaHeaders();
 		sync_init();
 		nthread_start(sgbPlayerTurnBitTbl[MyPlayerId]);
 		tmsg_start();
@@ -880,6 +1107,8 @@ void recv_plrinfo(Player &player, const TCmdPlrInfoHdr &header, bool recv)
 	ResetPlayerGFX(player);
 	player.plractive = true;
 	gbActivePlayers++;
+	// Give the new player a base for our delta headers as soon as possible
+	sgbPacketsSinceKeyframe = DeltaHeaderKeyframeInterval;
 
 	std::string_view szEvent;
 	if (sgbPlayerTurnBitTbl[pnum]) {
@@ -22,7 +22,11 @@ struct Player;
 
 struct GameData {
 	int32_t size;
-	uint8_t reserved[4];
+	/** Send TPktDeltaHdr instead of the full TPktHdr with every packet */
+	uint8_t bDeltaPlayerHeader;
+	/** Compress level deltas for joining players with LZ4 instead of PKWare */
+	uint8_t bLz4Deltas;
+	uint8_t reserved[2];
 	uint32_t programid;
 	uint8_t versionMajor;
 	uint8_t versionMinor;
@@ -58,7 +62,10 @@ extern std::string GameName;
 extern std::string GamePassword;
 extern bool PublicGame;
 extern uint8_t gbDeltaSender;
-extern uint32_t player_state[MAX_PLRS];
+extern DVL_API_FOR_TEST uint32_t player_state[MAX_PLRS];
+extern DVL_API_FOR_TEST uint32_t sgdwGameLoops;
+/** Number of the next turn the local player sends */
+extern DVL_API_FOR_TEST uint32_t sgbSentThisCycle;
 extern bool IsLoopback;
 
 void InitGameInfo();
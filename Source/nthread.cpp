@@ -5,8 +5,13 @@
  */
 #include "nthread.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
+#include <optional>
 
 #include <SDL.h>
 
@@ -15,7 +20,9 @@
 #include "engine/demomode.h"
 #include "game_mode.hpp"
 #include "gmenu.h"
+#include "options.h"
 #include "storm/storm_net.hpp"
+#include "utils/log.hpp"
 #include "utils/sdl_mutex.h"
 #include "utils/sdl_thread.h"
 
@@ -32,36 +39,137 @@ uint8_t ProgressToNextGameTick = 0;
 
 namespace {
 
+/** @brief Upper bound for the adaptive turns in transit, limits the input delay on bad connections */
+constexpr uint32_t MaxTurnsInTransit = 8;
+/** @brief Number of round trip measurements the turn pacing takes into account */
+constexpr size_t LatencySampleCount = 16;
+/** @brief Number of turns in a row that have to allow a shorter queue before it is shortened */
+constexpr uint32_t TurnsBeforeDecrease = 16;
+/** @brief How often the network thread moves received messages into the queue for the game thread */
+constexpr uint32_t ReceivePumpInterval = 10;
+
+/** @brief Held by whichever thread is pumping turns, only contended while the game thread hands turn pumping back */
 SdlMutex MemCrit;
-bool nthread_should_run;
+std::atomic_bool nthread_should_run;
 int8_t sgbSyncCountdown;
 uint32_t turn_upper_bit;
 bool sgbTicsOutOfSync;
 int8_t sgbPacketCountdown;
-bool sgbThreadIsRunning;
+/** @brief Set while the game thread is busy loading and the network thread pumps the turns instead */
+std::atomic_bool sgbThreadIsRunning;
 SdlThread Thread;
+std::array<uint32_t, LatencySampleCount> LatencySamples;
+size_t sgnLatencySamples;
+size_t sgnNextLatencySample;
+uint32_t sgdwLatencyP90;
+uint32_t sgdwTurnsBelowTarget;
+bool sgbStalledSinceUpdate;
+uint32_t sgdwStallsThisMinute;
+uint32_t sgdwStallsLastMinute;
+uint32_t sgdwStallMinuteStart;
 
-void NthreadHandler()
+/** @brief Returns the longest round trip time to any other player, if any has been measured. */
+std::optional<uint32_t> GetLongestLatency()
+{
+	std::optional<uint32_t> longest;
+	for (size_t i = 0; i < Players.size(); i++) {
+		uint32_t latency;
+		if (i == MyPlayerId || !SNetGetLatency(static_cast<uint8_t>(i), &latency))
+			continue;
+		longest = std::max(longest.value_or(0), latency);
+	}
+	return longest;
+}
+
+/**
+ * @brief Sizes gdwTurnsInTransit from the measured round trip time.
+ *
+ * The queue grows as soon as the latency calls for it, but only shrinks once the latency
+ * has stayed low for a while without any stalls in between.
+ */
+void UpdateTurnPacing()
 {
-	if (!nthread_should_run) {
+	const uint32_t now = SDL_GetTicks();
+	if (now - sgdwStallMinuteStart >= 60000) {
+		sgdwStallsLastMinute = sgdwStallsThisMinute;
+		sgdwStallsThisMinute = 0;
+		sgdwStallMinuteStart = now;
+	}
+
+	const bool stalled = sgbStalledSinceUpdate;
+	sgbStalledSinceUpdate = false;
+
+	if (!gbIsMultiplayer || !*GetOptions().Network.adaptiveTurnPacing)
 		return;
+
+	const std::optional<uint32_t> latency = GetLongestLatency();
+	if (!latency)
+		return;
+
+	LatencySamples[sgnNextLatencySample] = *latency;
+	sgnNextLatencySample = (sgnNextLatencySample + 1) % LatencySampleCount;
+	sgnLatencySamples = std::min(sgnLatencySamples + 1, LatencySampleCount);
+
+	std::array<uint32_t, LatencySampleCount> sorted = LatencySamples;
+	const auto p90 = sorted.begin() + sgnLatencySamples * 9 / 10;
+	std::nth_element(sorted.begin(), p90, sorted.begin() + sgnLatencySamples);
+	sgdwLatencyP90 = *p90;
+
+	// A turn is consumed gdwTurnsInTransit turns after it was sent, that has to cover the trip to the other players
+	const uint32_t turnDuration = 4 * sgbNetUpdateRate * gnTickDelay;
+	const uint32_t delayNeeded = sgdwLatencyP90 / 2 + gnTickDelay;
+	const uint32_t target = std::clamp<uint32_t>((delayNeeded + turnDuration - 1) / turnDuration, 1, MaxTurnsInTransit);
+
+	uint32_t turnsInTransit = gdwTurnsInTransit;
+	if (target > turnsInTransit) {
+		turnsInTransit = target;
+		sgdwTurnsBelowTarget = 0;
+	} else if (target < turnsInTransit && !stalled) {
+		sgdwTurnsBelowTarget++;
+		if (sgdwTurnsBelowTarget >= TurnsBeforeDecrease) {
+			turnsInTransit--;
+			sgdwTurnsBelowTarget = 0;
+		}
+	} else {
+		sgdwTurnsBelowTarget = 0;
 	}
 
-	while (true) {
-		MemCrit.lock();
-		if (!nthread_should_run) {
-			MemCrit.unlock();
-			break;
+	if (turnsInTransit != gdwTurnsInTransit) {
+		Log("Turns in transit {} -> {} (round trip p90 {} ms, {} stalls/min)", gdwTurnsInTransit, turnsInTransit, sgdwLatencyP90, std::max(sgdwStallsLastMinute, sgdwStallsThisMinute));
+		gdwTurnsInTransit = turnsInTransit;
+	}
+}
+
+/**
+ * @brief Services the network independently of the frame rate.
+ *
+ * Received messages are handed to the game thread through the storm_net receive queue.
+ * Turns are only pumped here while the game thread is loading, see nthread_ignore_mutex.
+ */
+void NthreadHandler()
+{
+	uint32_t nextTurnTick = SDL_GetTicks();
+
+	while (nthread_should_run) {
+		DvlNet_PumpReceiveQueue();
+
+		if (sgbThreadIsRunning && static_cast<int32_t>(SDL_GetTicks() - nextTurnTick) >= 0) {
+			std::lock_guard<SdlMutex> lock(MemCrit);
+			// The game thread may have taken the turns back while we were waiting for the lock
+			if (sgbThreadIsRunning) {
+				nthread_send_and_recv_turn(0, 0);
+				int delta = gnTickDelay;
+				if (nthread_recv_turns())
+					delta = last_tick - SDL_GetTicks();
+				nextTurnTick = SDL_GetTicks() + std::max(delta, 0);
+			}
 		}
-		nthread_send_and_recv_turn(0, 0);
-		int delta = gnTickDelay;
-		if (nthread_recv_turns())
-			delta = last_tick - SDL_GetTicks();
-		MemCrit.unlock();
-		if (delta > 0)
-			SDL_Delay(delta);
-		if (!nthread_should_run)
-			return;
+
+		uint32_t sleep = ReceivePumpInterval;
+		if (sgbThreadIsRunning)
+			sleep = std::clamp<int32_t>(static_cast<int32_t>(nextTurnTick - SDL_GetTicks()), 0, ReceivePumpInterval);
+		if (sleep > 0)
+			SDL_Delay(sleep);
 	}
 }
 
@@ -116,6 +224,10 @@ bool nthread_recv_turns(bool *pfSendAsync)
 		return true;
 	}
 	if (!SNetReceiveTurns(MAX_PLRS, (char **)glpMsgTbl, gdwMsgLenTbl, &player_state[0])) {
+		if (sgbTicsOutOfSync) {
+			sgdwStallsThisMinute++;
+			sgbStalledSinceUpdate = true;
+		}
 		sgbTicsOutOfSync = false;
 		sgbSyncCountdown = 1;
 		sgbPacketCountdown = 1;
@@ -126,6 +238,7 @@ bool nthread_recv_turns(bool *pfSendAsync)
 		last_tick = SDL_GetTicks();
 	}
 	sgbSyncCountdown = 4;
+	UpdateTurnPacing();
 	multi_msg_countdown();
 	if (pfSendAsync != nullptr)
 		*pfSendAsync = true;
@@ -154,6 +267,14 @@ void nthread_start(bool setTurnUpperBit)
 	gdwTurnsInTransit = caps.defaultturnsintransit;
 	if (gdwTurnsInTransit == 0)
 		gdwTurnsInTransit = 1;
+	sgnLatencySamples = 0;
+	sgnNextLatencySample = 0;
+	sgdwLatencyP90 = 0;
+	sgdwTurnsBelowTarget = 0;
+	sgbStalledSinceUpdate = false;
+	sgdwStallsThisMinute = 0;
+	sgdwStallsLastMinute = 0;
+	sgdwStallMinuteStart = last_tick;
 	if (caps.defaultturnssec <= 20 && caps.defaultturnssec != 0)
 		sgbNetUpdateRate = 20 / caps.defaultturnssec;
 	else
@@ -176,7 +297,7 @@ void nthread_start(bool setTurnUpperBit)
 		gdwNormalMsgSize = largestMsgSize;
 	if (gbIsMultiplayer) {
 		sgbThreadIsRunning = false;
-		MemCrit.lock();
+		DvlNet_SetReceiveQueueEnabled(true);
 		nthread_should_run = true;
 		Thread = SdlThread { NthreadHandler };
 	}
@@ -189,10 +310,19 @@ void nthread_cleanup()
 	gdwNormalMsgSize = 0;
 	gdwLargestMsgSize = 0;
 	if (Thread.joinable() && Thread.get_id() != this_sdl_thread::get_id()) {
-		if (!sgbThreadIsRunning)
-			MemCrit.unlock();
 		Thread.join();
 	}
+	sgbThreadIsRunning = false;
+	DvlNet_SetReceiveQueueEnabled(false);
+}
+
+TurnPacingInfo nthread_get_turn_pacing()
+{
+	return {
+		gdwTurnsInTransit,
+		sgdwLatencyP90,
+		std::max(sgdwStallsLastMinute, sgdwStallsThisMinute),
+	};
 }
 
 void nthread_ignore_mutex(bool bStart)
@@ -200,11 +330,11 @@ void nthread_ignore_mutex(bool bStart)
 	if (!Thread.joinable())
 		return;
 
-	if (bStart)
-		MemCrit.unlock();
-	else
-		MemCrit.lock();
 	sgbThreadIsRunning = bStart;
+	if (!bStart) {
+		// Wait for a turn the network thread is still pumping
+		const std::lock_guard<SdlMutex> lock(MemCrit);
+	}
 }
 
 bool nthread_has_500ms_passed(bool *drawGame /*= nullptr*/)
@@ -12,16 +12,24 @@
 
 namespace devilution {
 
-extern uint8_t sgbNetUpdateRate;
-extern size_t gdwMsgLenTbl[MAX_PLRS];
-extern uint32_t gdwTurnsInTransit;
-extern uintptr_t glpMsgTbl[MAX_PLRS];
-extern uint32_t gdwLargestMsgSize;
+extern DVL_API_FOR_TEST uint8_t sgbNetUpdateRate;
+extern DVL_API_FOR_TEST size_t gdwMsgLenTbl[MAX_PLRS];
+extern DVL_API_FOR_TEST uint32_t gdwTurnsInTransit;
+extern DVL_API_FOR_TEST uintptr_t glpMsgTbl[MAX_PLRS];
+extern DVL_API_FOR_TEST uint32_t gdwLargestMsgSize;
 extern uint32_t gdwNormalMsgSize;
 /** @brief the progress as a fraction (see AnimationInfo::baseValueFraction) in time to the next game tick */
 extern DVL_API_FOR_TEST uint8_t ProgressToNextGameTick;
 extern int last_tick;
 
+/** @brief Decisions of the adaptive turn pacing, for display in the network info overlay */
+struct TurnPacingInfo {
+	uint32_t turnsInTransit;
+	/** @brief 90th percentile of the round trip time to the slowest player in milliseconds */
+	uint32_t latency;
+	uint32_t stallsPerMinute;
+};
+
 void nthread_terminate_game(const char *pszFcn);
 uint32_t nthread_send_and_recv_turn(uint32_t curTurn, int turnDelta);
 bool nthread_recv_turns(bool *pfSendAsync = nullptr);
@@ -29,6 +37,7 @@ void nthread_set_turn_upper_bit();
 void nthread_start(bool setTurnUpperBit);
 void nthread_cleanup();
 void nthread_ignore_mutex(bool bStart);
+TurnPacingInfo nthread_get_turn_pacing();
 
 /**
  * @brief Checks if it's time for the logic to advance
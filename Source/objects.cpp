@@ -10,6 +10,7 @@
 #include <string>
 
 #include <algorithm>
+#include <bitset>
 
 #include <expected.hpp>
 #include <fmt/core.h>
@@ -117,6 +118,85 @@ int numobjfiles;
 /** Tracks progress through the tome sequence that spawns Na-Krul (see OperateNakrulBook()) */
 int NaKrulTomeSequence;
 
+/** Objects that ProcessObjects still has to update every tick, indexed like Objects. */
+std::bitset<MAXOBJECTS> AwakeObjects;
+
+size_t GetObjectIndex(const Object &object)
+{
+	return static_cast<size_t>(&object - Objects);
+}
+
+/**
+ * @brief Checks if ProcessObjects would still change the object, so inert objects can be skipped until something wakes them.
+ */
+bool NeedsUpdate(const Object &object)
+{
+	if (object._oDelFlag)
+		return true;
+
+	switch (object._otype) {
+	case OBJ_L1LIGHT:
+	case OBJ_SKFIRE:
+	case OBJ_CANDLE1:
+	case OBJ_CANDLE2:
+	case OBJ_BOOKCANDLE:
+	case OBJ_STORYCANDLE:
+	case OBJ_L5CANDLE:
+	case OBJ_TORCHL:
+	case OBJ_TORCHR:
+	case OBJ_TORCHL2:
+	case OBJ_TORCHR2:
+		// Follows the player's distance while the light is dynamic
+		if (object._oVar1 != -1)
+			return true;
+		break;
+	case OBJ_CRUX1:
+	case OBJ_CRUX2:
+	case OBJ_CRUX3:
+	case OBJ_BARREL:
+	case OBJ_BARRELEX:
+	case OBJ_POD:
+	case OBJ_PODEX:
+	case OBJ_URN:
+	case OBJ_URNEX:
+	case OBJ_SHRINEL:
+	case OBJ_SHRINER:
+		// Once ObjectStopAnim has parked the last frame, every further tick leaves the object as it is
+		if (object._oAnimFrame == object._oAnimLen)
+			return object._oAnimDelay != 1000 || object._oAnimCnt != (object._oAnimFlag ? 1 : 0);
+		break;
+	case OBJ_L1LDOOR:
+	case OBJ_L1RDOOR:
+	case OBJ_L2LDOOR:
+	case OBJ_L2RDOOR:
+	case OBJ_L3LDOOR:
+	case OBJ_L3RDOOR:
+	case OBJ_L5LDOOR:
+	case OBJ_L5RDOOR:
+		if (object._oVar4 != DOOR_CLOSED)
+			return true;
+		break;
+	case OBJ_FLAMEHOLE:
+		if (object._oVar2 == 0 || object._oVar4 != 0)
+			return true;
+		break;
+	case OBJ_TRAPL:
+	case OBJ_TRAPR:
+		if (object._oVar4 == 0)
+			return true;
+		break;
+	case OBJ_MCIRCLE1:
+	case OBJ_MCIRCLE2:
+	case OBJ_BCROSS:
+	case OBJ_TBCROSS:
+		return true;
+	default:
+		break;
+	}
+
+	return object._oAnimFlag;
+}
+
 /** Specifies the X-coordinate delta between barrels. */
 int bxadd[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
 /** Specifies the Y-coordinate delta between barrels. */
@@ -329,6 +409,7 @@ void ClrAllObjects()
 		object = {};
 	}
 	ActiveObjectCount = 0;
+	AwakeObjects.reset();
 	for (int i = 0; i < MAXOBJECTS; i++) {
 		AvailableObjects[i] = i;
 	}
@@ -678,6 +759,7 @@ void SetupObject(Object &object, Point position, _object_id ot)
 	object._otype = ot;
 	object_graphic_id ofi = objectData.ofindex;
 	object.position = position;
+	AwakeObjects.set(GetObjectIndex(object));
 
 	if (!HeadlessMode) {
 		const auto &found = c_find(ObjFileList, ofi);
@@ -731,6 +813,7 @@ void AddCryptBook(_object_id ot, int v2, Point position)
 	SetupObject(object, position, ot);
 	AddCryptObject(object, v2);
 	ActiveObjectCount++;
+	InvalidateTileBitboards();
 }
 
 void AddCryptStoryBook(int s)
@@ -899,6 +982,8 @@ void DeleteObject(int oi, int i)
 	const Object &object = Objects[oi];
 	const Point position = object.position;
 	dObject[position.x][position.y] = 0;
+	AwakeObjects.reset(oi);
+	InvalidateTileBitboards();
 	AvailableObjects[-ActiveObjectCount + MAXOBJECTS] = oi;
 	ActiveObjectCount--;
 	if (ObjectUnderCursor == &object) // Unselect object if this was highlighted by player
@@ -946,6 +1031,7 @@ void AddChest(Object &chest)
 void ObjSetMicro(Point position, int pn)
 {
 	dPiece[position.x][position.y] = pn;
+	InvalidateTileBitboards();
 }
 
 void DoorSet(Point position, bool isLeftDoor)
@@ -1757,6 +1843,7 @@ void OperateDoor(Object &door, bool sendflag)
 {
 	const bool isCrypt = IsAnyOf(door._otype, OBJ_L5LDOOR, OBJ_L5RDOOR);
 	const bool openDoor = door._oVar4 == DOOR_CLOSED;
+	AwakeObjects.set(GetObjectIndex(door));
 
 	if (!openDoor && !IsDoorClear(door)) {
 		PlaySfxLoc(isCrypt ? SfxID::CryptDoorClose : SfxID::DoorClose, door.position);
@@ -3439,6 +3526,7 @@ void BreakCrux(Object &crux, bool sendmsg)
 	crux._oAnimDelay = 1;
 	crux._oSolidFlag = true;
 	crux._oMissFlag = true;
+	InvalidateTileBitboards();
 	crux._oBreak = -1;
 	crux.selectionRegion = SelectionRegion::None;
 
@@ -3465,6 +3553,7 @@ void BreakBarrel(const Player &player, Object &barrel, bool forcebreak, bool sen
 	barrel._oAnimDelay = 1;
 	barrel._oSolidFlag = false;
 	barrel._oMissFlag = true;
+	InvalidateTileBitboards();
 	barrel._oBreak = -1;
 	barrel.selectionRegion = SelectionRegion::None;
 	barrel._oPreFlag = true;
@@ -4118,6 +4207,7 @@ Object *AddObject(_object_id objType, Point objPos)
 	AddObjectLight(object);
 
 	ActiveObjectCount++;
+	InvalidateTileBitboards();
 	return &object;
 }
 
@@ -4181,10 +4271,19 @@ void OperateTrap(Object &trap)
 	PlaySfxLoc(SfxID::TriggerTrap, triggerPosition);
 }
 
+void WakeAllObjects()
+{
+	for (int i = 0; i < ActiveObjectCount; i++)
+		AwakeObjects.set(ActiveObjects[i]);
+}
+
 void ProcessObjects()
 {
 	for (int i = 0; i < ActiveObjectCount; ++i) {
-		Object &object = Objects[ActiveObjects[i]];
+		const int oi = ActiveObjects[i];
+		if (!AwakeObjects.test(oi))
+			continue;
+		Object &object = Objects[oi];
 		switch (object._otype) {
 		case OBJ_L1LIGHT:
 		case OBJ_SKFIRE:
@@ -4249,23 +4348,23 @@ void ProcessObjects()
 		default:
 			break;
 		}
-		if (!object._oAnimFlag)
-			continue;
-
-		object._oAnimCnt++;
-
-		if (object._oAnimCnt < object._oAnimDelay)
-			continue;
+		if (object._oAnimFlag) {
+			object._oAnimCnt++;
+			if (object._oAnimCnt >= object._oAnimDelay) {
+				object._oAnimCnt = 0;
+				object._oAnimFrame++;
+				if (object._oAnimFrame > object._oAnimLen)
+					object._oAnimFrame = 1;
+			}
+		}
 
-		object._oAnimCnt = 0;
-		object._oAnimFrame++;
-		if (object._oAnimFrame > object._oAnimLen)
-			object._oAnimFrame = 1;
+		if (!NeedsUpdate(object))
+			AwakeObjects.reset(oi);
 	}
 
 	for (int i = 0; i < ActiveObjectCount;) {
 		const int oi = ActiveObjects[i];
-		if (Objects[oi]._oDelFlag) {
+		if (AwakeObjects.test(oi) && Objects[oi]._oDelFlag) {
 			DeleteObject(oi, i);
 		} else {
 			i++;
@@ -4363,6 +4462,8 @@ _item_indexes ItemMiscIdIdx(item_misc_id imiscid)
 void OperateObject(Player &player, Object &object)
 {
 	const bool sendmsg = &player == MyPlayer;
+	// Operating one object can start others (trap lines, barrel chains, map changes)
+	WakeAllObjects();
 
 	switch (object._otype) {
 	case OBJ_L1LDOOR:
@@ -4473,6 +4574,7 @@ void OperateObject(Player &player, Object &object)
 
 void DeltaSyncOpObject(Object &object)
 {
+	WakeAllObjects();
 	switch (object._otype) {
 	case OBJ_L1LDOOR:
 	case OBJ_L1RDOOR:
@@ -4566,6 +4668,7 @@ void DeltaSyncCloseObj(Object &object)
 void SyncOpObject(Player &player, int cmd, Object &object)
 {
 	const bool sendmsg = &player == MyPlayer;
+	WakeAllObjects();
 
 	switch (object._otype) {
 	case OBJ_L1LDOOR:
@@ -4675,11 +4778,13 @@ void SyncOpObject(Player &player, int cmd, Object &object)
 
 void BreakObjectMissile(const Player *player, Object &object)
 {
+	WakeAllObjects();
 	if (object.IsCrux())
 		BreakCrux(object, true);
 }
 void BreakObject(const Player &player, Object &object)
 {
+	WakeAllObjects();
 	if (object.IsBarrel()) {
 		BreakBarrel(player, object, false, true);
 	} else if (object.IsCrux()) {
@@ -4692,6 +4797,7 @@ void DeltaSyncBreakObj(Object &object)
 	if (!object.IsBreakable() || !object.canInteractWith())
 		return;
 
+	WakeAllObjects();
 	object._oMissFlag = true;
 	object._oBreak = -1;
 	object.selectionRegion = SelectionRegion::None;
@@ -4701,6 +4807,7 @@ void DeltaSyncBreakObj(Object &object)
 
 	if (object.IsBarrel()) {
 		object._oSolidFlag = false;
+		InvalidateTileBitboards();
 	} else if (object.IsCrux() && AreAllCruxesOfTypeBroken(object._oVar8)) {
 		ObjChangeMap(object._oVar1, object._oVar2, object._oVar3, object._oVar4);
 	}
@@ -4708,6 +4815,7 @@ void DeltaSyncBreakObj(Object &object)
 
 void SyncBreakObj(const Player &player, Object &object)
 {
+	WakeAllObjects();
 	if (object.IsBarrel()) {
 		BreakBarrel(player, object, true, false);
 	} else if (object.IsCrux()) {
@@ -4717,6 +4825,7 @@ void SyncBreakObj(const Player &player, Object &object)
 
 void SyncObjectAnim(Object &object)
 {
+	AwakeObjects.set(GetObjectIndex(object));
 	object_graphic_id index = AllObjects[object._otype].ofindex;
 
 	if (!HeadlessMode) {
@@ -4908,6 +5017,7 @@ void SyncNakrulRoom()
 	dPiece[UberRow][UberCol - 1] = 300;
 	dPiece[UberRow][UberCol - 2] = 299;
 	dPiece[UberRow][UberCol + 1] = 298;
+	InvalidateTileBitboards();
 }
 
 } // namespace devilution
@@ -282,9 +282,9 @@ struct Object {
 };
 
 extern DVL_API_FOR_TEST Object Objects[MAXOBJECTS];
-extern int AvailableObjects[MAXOBJECTS];
+extern DVL_API_FOR_TEST int AvailableObjects[MAXOBJECTS];
 extern int ActiveObjects[MAXOBJECTS];
-extern int ActiveObjectCount;
+extern DVL_API_FOR_TEST int ActiveObjectCount;
 /** @brief Indicates that objects are being loaded during gameplay and pre calculated data should be updated. */
 extern bool LoadingMapObjects;
 
@@ -343,6 +343,13 @@ void SetMapObjects(const uint16_t *dunData, int startx, int starty);
 Object *AddObject(_object_id objType, Point objPos);
 bool UpdateTrapState(Object &trap);
 void OperateTrap(Object &trap);
+/**
+ * @brief Makes ProcessObjects update every active object again on the next tick
+ *
+ * Objects that have nothing left to animate or check are skipped until something changes their state.
+ * Call this after modifying objects from outside of objects.cpp.
+ */
+void WakeAllObjects();
 void ProcessObjects();
 void RedoPlayerVision();
 void MonstCheckDoors(const Monster &monster);
@@ -888,12 +888,18 @@ std::vector<OptionEntryBase *> ControllerOptions::GetEntries()
 NetworkOptions::NetworkOptions()
     : OptionCategoryBase("Network", N_("Network"), N_("Network Settings"))
     , port("Port", OptionEntryFlags::Invisible, "Port", "What network port to use.", 6112)
+    , deltaPlayerHeader("Delta Player Header", OptionEntryFlags::Invisible, "Delta Player Header", "Only send the player stats that changed since the last keyframe with each network packet.", true)
+    , lz4Deltas("LZ4 Deltas", OptionEntryFlags::Invisible, "LZ4 Deltas", "Compress level data for joining players with LZ4, which is much faster than PKWare.", true)
+    , adaptiveTurnPacing("Adaptive Turn Pacing", OptionEntryFlags::Invisible, "Adaptive Turn Pacing", "Size the number of turns sent ahead from the measured round trip time.", true)
 {
 }
 std::vector<OptionEntryBase *> NetworkOptions::GetEntries()
 {
 	return {
 		&port,
+		&deltaPlayerHeader,
+		&lz4Deltas,
+		&adaptiveTurnPacing,
 	};
 }
 
@@ -665,6 +665,12 @@ struct NetworkOptions : OptionCategoryBase {
 	char szPreviousHost[129];
 	/** @brief What network port to use. */
 	OptionEntryInt<uint16_t> port;
+	/** @brief Only send the player stats that changed since the last keyframe with each network packet. */
+	OptionEntryBoolean deltaPlayerHeader;
+	/** @brief Compress level data for joining players with LZ4, which is much faster than PKWare. */
+	OptionEntryBoolean lz4Deltas;
+	/** @brief Size the number of turns sent ahead from the measured round trip time. */
+	OptionEntryBoolean adaptiveTurnPacing;
 };
 
 struct ChatOptions : OptionCategoryBase {
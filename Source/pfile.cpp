@@ -5,9 +5,16 @@
  */
 #include "pfile.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <expected.hpp>
@@ -22,12 +29,19 @@
 #include "mpq/mpq_common.hpp"
 #include "pack.h"
 #include "playerdat.hpp"
+#include "plrmsg.h"
 #include "qol/stash.h"
+#include "utils/algorithm/container.hpp"
 #include "utils/endian_read.hpp"
+#include "utils/endian_write.hpp"
+#include "utils/enum_traits.h"
 #include "utils/file_util.h"
 #include "utils/language.h"
+#include "utils/log.hpp"
+#include "utils/parallel_for.hpp"
 #include "utils/parse_int.hpp"
 #include "utils/paths.h"
+#include "utils/sdl_thread.h"
 #include "utils/stdcompat/filesystem.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
@@ -142,29 +156,409 @@ bool ReadHero(SaveReader &archive, PlayerPack *pPack)
 	return ret;
 }
 
-void EncodeHero(SaveWriter &saveWriter, const PlayerPack *pack)
+/** @brief Serializes the files describing a hero, leaving the encoding to WriteSnapshot. */
+SaveSnapshot SnapshotHero(Player &player)
 {
-	const size_t packedLen = codec_get_encoded_len(sizeof(*pack));
-	const std::unique_ptr<std::byte[]> packed { new std::byte[packedLen] };
+	SaveSnapshot snapshot;
 
-	memcpy(packed.get(), pack, sizeof(*pack));
-	codec_encode(packed.get(), sizeof(*pack), packedLen, pfile_get_password());
-	saveWriter.WriteFile("hero", packed.get(), packedLen);
+	PlayerPack pkplr;
+	PackPlayer(pkplr, player);
+	std::unique_ptr<std::byte[]> packed { new std::byte[codec_get_encoded_len(sizeof(pkplr))] };
+	memcpy(packed.get(), &pkplr, sizeof(pkplr));
+	snapshot.files.push_back({ "hero", std::move(packed), sizeof(pkplr) });
+
+	if (!gbVanilla) {
+		SaveHotkeys(snapshot, player);
+		SaveHeroItems(snapshot, player);
+	}
+
+	return snapshot;
+}
+
+/**
+ * @brief Encodes the files of a snapshot in place and writes them to the archive.
+ * @return false if any of the files could not be written
+ */
+bool WriteSnapshot(SaveWriter &saveWriter, SaveSnapshot &snapshot, const char *password)
+{
+	bool success = true;
+	for (SaveSnapshot::File &file : snapshot.files) {
+		const size_t encodedLen = codec_get_encoded_len(file.size);
+		codec_encode(file.data.get(), file.size, encodedLen, password);
+		if (!saveWriter.WriteFile(file.name.c_str(), file.data.get(), encodedLen))
+			success = false;
+	}
+	return success;
+}
+
+void Game2UiPlayer(const Player &player, _uiheroinfo *heroinfo, bool bHasSaveFile)
+{
+	CopyUtf8(heroinfo->name, player._pName, sizeof(heroinfo->name));
+	heroinfo->level = player.getCharacterLevel();
+	heroinfo->heroclass = player._pClass;
+	heroinfo->strength = player._pStrength;
+	heroinfo->magic = player._pMagic;
+	heroinfo->dexterity = player._pDexterity;
+	heroinfo->vitality = player._pVitality;
+	heroinfo->hassaved = bHasSaveFile;
+	heroinfo->herorank = player.pDiabloKillLevel;
+	heroinfo->spawned = gbIsSpawn;
+}
+
+constexpr uint32_t HeroIndexMagic = LoadLE32("DHIX");
+constexpr uint32_t HeroIndexVersion = 2;
+constexpr size_t HeroIndexHeaderSize = 8;
+constexpr size_t HeroSummarySize = 44;
+
+/** @brief Size and last write time of a save on disk */
+struct SaveStamp {
+	uint32_t size;
+	uint64_t modified;
+
+	bool operator==(const SaveStamp &) const = default;
+};
+
+/** @brief Selection screen entry of a hero, trusted while the save keeps the stamp it had when the entry was stored */
+struct HeroSummary {
+	SaveStamp stamp;
+	_uiheroinfo info;
+};
+
+bool IsSameSummary(const HeroSummary &a, const HeroSummary &b)
+{
+	return a.stamp == b.stamp
+	    && strcmp(a.info.name, b.info.name) == 0
+	    && a.info.level == b.info.level
+	    && a.info.heroclass == b.info.heroclass
+	    && a.info.herorank == b.info.herorank
+	    && a.info.hassaved == b.info.hassaved
+	    && a.info.strength == b.info.strength
+	    && a.info.magic == b.info.magic
+	    && a.info.dexterity == b.info.dexterity
+	    && a.info.vitality == b.info.vitality;
+}
+
+using HeroIndex = std::array<std::optional<HeroSummary>, MAX_CHARACTERS>;
+
+std::string GetHeroIndexPath()
+{
+	return StrCat(paths::PrefPath(),
+	    gbIsSpawn
+	        ? (gbIsMultiplayer ? "share_" : "spawn_")
+	        : (gbIsMultiplayer ? "multi_" : "single_"),
+	    gbIsHellfire ? "heroes.hidx" : "heroes.idx");
+}
+
+/**
+ * @brief Returns the size and last write time of the save on disk, or nothing if there is no save.
+ *
+ * The game refreshes the index whenever it writes a save, so the stamp only has to catch saves that were
+ * replaced or edited by something else.
+ */
+std::optional<SaveStamp> GetSaveStamp(const std::string &savePath)
+{
+	uintmax_t size;
+	uint64_t modified;
+#ifdef UNPACKED_SAVES
+	const std::string heroPath = StrCat(savePath, "hero");
+	if (!FileExists(heroPath) || !GetFileSize(heroPath.c_str(), &size) || !GetFileModificationTime(heroPath.c_str(), &modified))
+		return std::nullopt;
+	SaveStamp stamp { static_cast<uint32_t>(size), modified };
+	for (const char *name : { "heroitems", "game" }) {
+		const std::string path = StrCat(savePath, name);
+		if (FileExists(path) && GetFileSize(path.c_str(), &size) && GetFileModificationTime(path.c_str(), &modified)) {
+			stamp.size += static_cast<uint32_t>(size);
+			stamp.modified = std::max(stamp.modified, modified);
+		}
+	}
+	return stamp;
+#else
+	if (!FileExists(savePath) || !GetFileSize(savePath.c_str(), &size) || !GetFileModificationTime(savePath.c_str(), &modified))
+		return std::nullopt;
+	return SaveStamp { static_cast<uint32_t>(size), modified };
+#endif
+}
+
+/**
+ * @brief Save whose levels were written after its index entry was stored.
+ *
+ * Writing a level does not change what the selection screen shows, so the new stamp is only stored the next time
+ * the index is written anyway or read for the selection screen.
+ */
+std::optional<uint32_t> UnstampedSave;
+
+HeroIndex ReadHeroIndex(const std::string &indexPath)
+{
+	HeroIndex index;
+
+	uintmax_t size;
+	if (!FileExists(indexPath) || !GetFileSize(indexPath.c_str(), &size) || size < HeroIndexHeaderSize)
+		return index;
+	FILE *file = OpenFile(indexPath.c_str(), "rb");
+	if (file == nullptr)
+		return index;
+	std::vector<std::byte> data(static_cast<size_t>(size));
+	const bool read = std::fread(data.data(), data.size(), 1, file) == 1;
+	std::fclose(file);
+	if (!read || LoadLE32(&data[0]) != HeroIndexMagic || LoadLE32(&data[4]) != HeroIndexVersion)
+		return index;
+
+	for (size_t offset = HeroIndexHeaderSize; offset + HeroSummarySize <= data.size(); offset += HeroSummarySize) {
+		const std::byte *entry = &data[offset];
+		const uint32_t saveNum = LoadLE32(entry);
+		if (saveNum >= MAX_CHARACTERS)
+			continue;
+		// A damaged entry is dropped, so the save it belongs to gets scanned again
+		const uint8_t level = static_cast<uint8_t>(entry[32]);
+		const uint8_t heroClass = static_cast<uint8_t>(entry[33]);
+		if (heroClass >= enum_size<HeroClass>::value || level == 0 || level > GetMaximumCharacterLevel())
+			continue;
+
+		HeroSummary summary;
+		summary.stamp.size = LoadLE32(entry + 4);
+		summary.stamp.modified = LoadLE32(entry + 8) | static_cast<uint64_t>(LoadLE32(entry + 12)) << 32;
+		_uiheroinfo &info = summary.info;
+		info.saveNumber = saveNum;
+		memcpy(info.name, entry + 16, sizeof(info.name));
+		info.name[sizeof(info.name) - 1] = '\0';
+		info.level = level;
+		info.heroclass = static_cast<HeroClass>(heroClass);
+		info.herorank = static_cast<uint8_t>(entry[34]);
+		info.hassaved = entry[35] != std::byte { 0 };
+		info.strength = LoadLE16(entry + 36);
+		info.magic = LoadLE16(entry + 38);
+		info.dexterity = LoadLE16(entry + 40);
+		info.vitality = LoadLE16(entry + 42);
+		info.spawned = gbIsSpawn;
+		index[saveNum] = summary;
+	}
+
+	return index;
+}
+
+void WriteHeroIndex(const std::string &indexPath, const HeroIndex &index)
+{
+	std::vector<std::byte> data(HeroIndexHeaderSize);
+	WriteLE32(&data[0], HeroIndexMagic);
+	WriteLE32(&data[4], HeroIndexVersion);
+	for (const std::optional<HeroSummary> &summary : index) {
+		if (!summary)
+			continue;
+
+		const size_t offset = data.size();
+		data.resize(offset + HeroSummarySize);
+		std::byte *entry = &data[offset];
+		const _uiheroinfo &info = summary->info;
+		WriteLE32(entry, info.saveNumber);
+		WriteLE32(entry + 4, summary->stamp.size);
+		WriteLE32(entry + 8, static_cast<uint32_t>(summary->stamp.modified));
+		WriteLE32(entry + 12, static_cast<uint32_t>(summary->stamp.modified >> 32));
+		memcpy(entry + 16, info.name, sizeof(info.name));
+		entry[32] = static_cast<std::byte>(info.level);
+		entry[33] = static_cast<std::byte>(info.heroclass);
+		entry[34] = static_cast<std::byte>(info.herorank);
+		entry[35] = static_cast<std::byte>(info.hassaved ? 1 : 0);
+		WriteLE16(entry + 36, info.strength);
+		WriteLE16(entry + 38, info.magic);
+		WriteLE16(entry + 40, info.dexterity);
+		WriteLE16(entry + 42, info.vitality);
+	}
+
+	FILE *file = OpenFile(indexPath.c_str(), "wb");
+	if (file == nullptr) {
+		LogError("Failed to open hero index {}", indexPath);
+		return;
+	}
+	if (std::fwrite(data.data(), data.size(), 1, file) != 1)
+		LogError("Failed to write hero index {}", indexPath);
+	std::fclose(file);
+}
+
+/**
+ * @brief Replaces the index entry of a save that was just written, or removes it if `info` is null.
+ *
+ * The index is left untouched if it already holds the same entry.
+ */
+void StoreHeroSummary(const std::string &indexPath, const std::string &savePath, uint32_t saveNum, const _uiheroinfo *info)
+{
+	if (UnstampedSave == saveNum)
+		UnstampedSave = std::nullopt;
+	HeroIndex index = ReadHeroIndex(indexPath);
+	const std::optional<SaveStamp> stamp = info != nullptr ? GetSaveStamp(savePath) : std::nullopt;
+	if (stamp) {
+		const HeroSummary summary { *stamp, *info };
+		if (index[saveNum] && IsSameSummary(*index[saveNum], summary))
+			return;
+		index[saveNum] = summary;
+	} else {
+		if (!index[saveNum])
+			return;
+		index[saveNum] = std::nullopt;
+	}
+	WriteHeroIndex(indexPath, index);
+}
+
+void StoreHeroSummary(uint32_t saveNum, const _uiheroinfo *info)
+{
+	StoreHeroSummary(GetHeroIndexPath(), GetSavePath(saveNum), saveNum, info);
+}
+
+/**
+ * @brief Notes that levels were written to a save, which does not change what the selection screen shows.
+ */
+void MarkSaveUnstamped(uint32_t saveNum)
+{
+	UnstampedSave = saveNum;
+}
+
+/** @brief A multiplayer autosave that is encoded and written on a worker thread */
+struct AsyncSave {
+	std::string heroPath;
+	SaveSnapshot hero;
+	std::string stashPath;
+	std::string heroIndexPath;
+	/** @brief Stored in the hero index once the save is written */
+	_uiheroinfo summary;
+	/** @brief Empty if the stash did not change since it was last saved */
+	SaveSnapshot stash;
+	const char *password;
+	uint32_t startTick;
+	/** @brief Only read once done is set */
+	bool failed;
+	std::atomic_bool done;
+	SdlThread worker;
+};
+
+std::unique_ptr<AsyncSave> PendingSave;
+
+/**
+ * @brief Unencoded copy of a level file written to the save during this session
+ *
+ * Only the level file is kept. The dungeon itself is still generated from its seed on every visit,
+ * since generation also places quests, set pieces and the view position, none of which are part of the level file.
+ */
+struct CachedLevelFile {
+	uint32_t saveNumber;
+	std::string name;
+	std::unique_ptr<std::byte[]> data;
+	size_t size;
+};
+
+/** @brief Upper bound for the size of all cached level files, enough for several dungeon levels plus town */
+constexpr size_t LevelFileCacheBudget = 2 * 1024 * 1024;
+
+/** @brief Level files of the levels that were left recently, most recent first */
+std::vector<CachedLevelFile> LevelFileCache;
+size_t LevelFileCacheSize;
+
+void ClearLevelFileCache()
+{
+	LevelFileCache.clear();
+	LevelFileCacheSize = 0;
+}
+
+void CacheLevelFile(const SaveSnapshot::File &file)
+{
+	const auto it = c_find_if(LevelFileCache, [&file](const CachedLevelFile &level) {
+		return level.saveNumber == gSaveNumber && level.name == file.name;
+	});
+	if (it != LevelFileCache.end()) {
+		LevelFileCacheSize -= it->size;
+		LevelFileCache.erase(it);
+	}
+
+	std::unique_ptr<std::byte[]> data { new std::byte[file.size] };
+	memcpy(data.get(), file.data.get(), file.size);
+	LevelFileCache.insert(LevelFileCache.begin(), { gSaveNumber, file.name, std::move(data), file.size });
+	LevelFileCacheSize += file.size;
+
+	while (LevelFileCacheSize > LevelFileCacheBudget) {
+		LevelFileCacheSize -= LevelFileCache.back().size;
+		LevelFileCache.pop_back();
+	}
+}
+
+int SDLCALL WriteAsyncSave(void *data)
+{
+	AsyncSave &save = *static_cast<AsyncSave *>(data);
+
+	bool success;
+	{
+		SaveWriter saveWriter(std::string(save.heroPath));
+		success = WriteSnapshot(saveWriter, save.hero, save.password);
+	}
+	if (!save.stash.files.empty()) {
+		SaveWriter stashWriter(std::string(save.stashPath));
+		if (!WriteSnapshot(stashWriter, save.stash, save.password))
+			success = false;
+	}
+
+	save.failed = !success;
+	save.done = true;
+	return 0;
+}
+
+/**
+ * @brief Reports the outcome of the pending autosave once the worker is done.
+ * @param wait Block until the worker is done, required before anything else touches the save files
+ */
+void FinishAsyncSave(bool wait)
+{
+	if (PendingSave == nullptr || (!wait && !PendingSave->done))
+		return;
+
+	PendingSave->worker.join();
+	if (PendingSave->failed) {
+		LogError("Failed to write autosave to {}", PendingSave->heroPath);
+		EventPlrMsg(_("Failed to save the game"), UiFlags::ColorRed);
+		// Try again with the next save
+		if (!PendingSave->stash.files.empty())
+			Stash.dirty = true;
+	} else {
+		LogVerbose("Autosave written in {} ms", SDL_GetTicks() - PendingSave->startTick);
+		StoreHeroSummary(PendingSave->heroIndexPath, PendingSave->heroPath, PendingSave->summary.saveNumber, &PendingSave->summary);
+	}
+	PendingSave = nullptr;
+}
+
+void StartAsyncSave()
+{
+	auto save = std::make_unique<AsyncSave>();
+	save->heroPath = GetSavePath(gSaveNumber);
+	save->hero = SnapshotHero(*MyPlayer);
+	save->heroIndexPath = GetHeroIndexPath();
+	save->summary.saveNumber = gSaveNumber;
+	Game2UiPlayer(*MyPlayer, &save->summary, false);
+	if (Stash.dirty) {
+		save->stashPath = GetStashSavePath();
+		SaveStash(save->stash);
+		Stash.dirty = false;
+	}
+	save->password = pfile_get_password();
+	save->startTick = SDL_GetTicks();
+	save->failed = false;
+	save->done = false;
+
+	PendingSave = std::move(save);
+	PendingSave->worker = SdlThread(WriteAsyncSave, PendingSave.get());
 }
 
 SaveWriter GetSaveWriter(uint32_t saveNum)
 {
+	FinishAsyncSave(/*wait=*/true);
 	return SaveWriter(GetSavePath(saveNum));
 }
 
 SaveWriter GetStashWriter()
 {
+	FinishAsyncSave(/*wait=*/true);
 	return SaveWriter(GetStashSavePath());
 }
 
 #ifndef DISABLE_DEMOMODE
 void CopySaveFile(uint32_t saveNum, std::string targetPath)
 {
+	FinishAsyncSave(/*wait=*/true);
 	const std::string savePath = GetSavePath(saveNum);
 #if defined(UNPACKED_SAVES)
 #ifdef DVL_NO_FILESYSTEM
@@ -182,20 +576,6 @@ void CopySaveFile(uint32_t saveNum, std::string targetPath)
 }
 #endif
 
-void Game2UiPlayer(const Player &player, _uiheroinfo *heroinfo, bool bHasSaveFile)
-{
-	CopyUtf8(heroinfo->name, player._pName, sizeof(heroinfo->name));
-	heroinfo->level = player.getCharacterLevel();
-	heroinfo->heroclass = player._pClass;
-	heroinfo->strength = player._pStrength;
-	heroinfo->magic = player._pMagic;
-	heroinfo->dexterity = player._pDexterity;
-	heroinfo->vitality = player._pVitality;
-	heroinfo->hassaved = bHasSaveFile;
-	heroinfo->herorank = player.pDiabloKillLevel;
-	heroinfo->spawned = gbIsSpawn;
-}
-
 bool GetFileName(uint8_t lvl, char *dst)
 {
 	if (gbIsMultiplayer) {
@@ -218,18 +598,23 @@ bool GetFileName(uint8_t lvl, char *dst)
 	return false;
 }
 
-bool ArchiveContainsGame(SaveReader &hsArchive)
+/** @brief Reads the magic number of the saved game without touching any game state, so it can run on a worker thread */
+std::optional<uint32_t> ReadGameHeader(SaveReader &hsArchive)
 {
 	if (gbIsMultiplayer)
-		return false;
+		return std::nullopt;
 
 	auto gameData = ReadArchive(hsArchive, "game");
 	if (gameData == nullptr)
-		return false;
+		return std::nullopt;
 
-	const uint32_t hdr = LoadLE32(gameData.get());
+	return LoadLE32(gameData.get());
+}
 
-	return IsHeaderValid(hdr);
+bool ArchiveContainsGame(SaveReader &hsArchive)
+{
+	const std::optional<uint32_t> hdr = ReadGameHeader(hsArchive);
+	return hdr && IsHeaderValid(*hdr);
 }
 
 std::optional<SaveReader> CreateSaveReader(std::string &&path)
@@ -507,15 +892,8 @@ void pfile_write_hero(SaveWriter &saveWriter, bool writeGameData)
 		SaveGameData(saveWriter);
 		RenameTempToPerm(saveWriter);
 	}
-	PlayerPack pkplr;
-	Player &myPlayer = *MyPlayer;
-
-	PackPlayer(pkplr, myPlayer);
-	EncodeHero(saveWriter, &pkplr);
-	if (!gbVanilla) {
-		SaveHotkeys(saveWriter, myPlayer);
-		SaveHeroItems(saveWriter, myPlayer);
-	}
+	SaveSnapshot snapshot = SnapshotHero(*MyPlayer);
+	WriteSnapshot(saveWriter, snapshot, pfile_get_password());
 }
 
 void RemoveAllInvalidItems(Player &player)
@@ -529,6 +907,16 @@ void RemoveAllInvalidItems(Player &player)
 	RemoveEmptyInventory(player);
 }
 
+/** @brief A save the hero index does not describe, read on a worker thread */
+struct ScannedHero {
+	uint32_t saveNumber;
+	SaveStamp stamp;
+	std::string savePath;
+	bool valid;
+	PlayerPack pack;
+	std::optional<uint32_t> gameHeader;
+};
+
 } // namespace
 
 #ifdef UNPACKED_SAVES
@@ -585,11 +973,13 @@ void SaveWriter::RemoveHashEntries(bool (*fnGetName)(uint8_t, char *))
 
 std::optional<SaveReader> OpenSaveArchive(uint32_t saveNum)
 {
+	FinishAsyncSave(/*wait=*/true);
 	return CreateSaveReader(GetSavePath(saveNum));
 }
 
 std::optional<SaveReader> OpenStashArchive()
 {
+	FinishAsyncSave(/*wait=*/true);
 	return CreateSaveReader(GetStashSavePath());
 }
 
@@ -621,8 +1011,15 @@ const char *pfile_get_password()
 
 void pfile_write_hero(bool writeGameData)
 {
-	SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
-	pfile_write_hero(saveWriter, writeGameData);
+	{
+		SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
+		pfile_write_hero(saveWriter, writeGameData);
+	}
+
+	_uiheroinfo summary;
+	summary.saveNumber = gSaveNumber;
+	Game2UiPlayer(*MyPlayer, &summary, !gbIsMultiplayer && (writeGameData || gbValidSaveFile));
+	StoreHeroSummary(gSaveNumber, &summary);
 }
 
 #ifndef DISABLE_DEMOMODE
@@ -659,7 +1056,9 @@ void sfile_write_stash()
 
 	SaveWriter stashWriter = GetStashWriter();
 
-	SaveStash(stashWriter);
+	SaveSnapshot snapshot;
+	SaveStash(snapshot);
+	WriteSnapshot(stashWriter, snapshot, pfile_get_password());
 
 	Stash.dirty = false;
 }
@@ -667,30 +1066,73 @@ void sfile_write_stash()
 bool pfile_ui_set_hero_infos(bool (*uiAddHeroInfo)(_uiheroinfo *))
 {
 	memset(hero_names, 0, sizeof(hero_names));
+	FinishAsyncSave(/*wait=*/true);
+
+	const std::string indexPath = GetHeroIndexPath();
+	HeroIndex index = ReadHeroIndex(indexPath);
+	bool indexChanged = false;
 
+	std::vector<ScannedHero> scan;
 	for (uint32_t i = 0; i < MAX_CHARACTERS; i++) {
-		std::optional<SaveReader> archive = OpenSaveArchive(i);
-		if (archive) {
-			PlayerPack pkplr;
-			if (ReadHero(*archive, &pkplr)) {
-				_uiheroinfo uihero;
-				uihero.saveNumber = i;
-				strcpy(hero_names[i], pkplr.pName);
-				const bool hasSaveGame = ArchiveContainsGame(*archive);
-				if (hasSaveGame)
-					pkplr.bIsHellfire = gbIsHellfireSaveGame ? 1 : 0;
-
-				Player &player = Players[0];
-
-				UnPackPlayer(pkplr, player);
-				LoadHeroItems(player);
-				RemoveAllInvalidItems(player);
-				CalcPlrInv(player, false);
-
-				Game2UiPlayer(player, &uihero, hasSaveGame);
-				uiAddHeroInfo(&uihero);
-			}
+		std::string savePath = GetSavePath(i);
+		const std::optional<SaveStamp> stamp = GetSaveStamp(savePath);
+		if (index[i] && stamp && UnstampedSave == i) {
+			index[i]->stamp = *stamp;
+			indexChanged = true;
+		}
+		if (index[i] && stamp && index[i]->stamp == *stamp)
+			continue;
+		if (index[i]) {
+			index[i] = std::nullopt;
+			indexChanged = true;
 		}
+		if (stamp)
+			scan.push_back({ i, *stamp, std::move(savePath), false, {}, std::nullopt });
+	}
+	UnstampedSave = std::nullopt;
+
+	// Reading and decoding the archives only depends on the game mode, unpacking the heroes has to stay on this thread
+	ParallelFor(scan.size(), [&scan](size_t i) {
+		ScannedHero &hero = scan[i];
+		std::optional<SaveReader> archive = CreateSaveReader(std::move(hero.savePath));
+		if (!archive)
+			return;
+		hero.valid = ReadHero(*archive, &hero.pack);
+		if (hero.valid)
+			hero.gameHeader = ReadGameHeader(*archive);
+	});
+
+	for (ScannedHero &hero : scan) {
+		if (!hero.valid)
+			continue;
+
+		const bool hasSaveGame = hero.gameHeader && IsHeaderValid(*hero.gameHeader);
+		if (hasSaveGame)
+			hero.pack.bIsHellfire = gbIsHellfireSaveGame ? 1 : 0;
+
+		Player &player = Players[0];
+
+		UnPackPlayer(hero.pack, player);
+		LoadHeroItems(player);
+		RemoveAllInvalidItems(player);
+		CalcPlrInv(player, false);
+
+		HeroSummary summary { hero.stamp, {} };
+		summary.info.saveNumber = hero.saveNumber;
+		Game2UiPlayer(player, &summary.info, hasSaveGame);
+		index[hero.saveNumber] = summary;
+		indexChanged = true;
+	}
+
+	if (indexChanged)
+		WriteHeroIndex(indexPath, index);
+
+	for (const std::optional<HeroSummary> &summary : index) {
+		if (!summary)
+			continue;
+		_uiheroinfo uihero = summary->info;
+		CopyUtf8(hero_names[uihero.saveNumber], uihero.name, sizeof(hero_names[uihero.saveNumber]));
+		uiAddHeroInfo(&uihero);
 	}
 
 	return true;
@@ -717,8 +1159,6 @@ uint32_t pfile_ui_get_first_unused_save_num()
 
 bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 {
-	PlayerPack pkplr;
-
 	const uint32_t saveNum = heroinfo->saveNumber;
 	if (saveNum >= MAX_CHARACTERS)
 		return false;
@@ -726,20 +1166,19 @@ bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 
 	giNumberOfLevels = gbIsHellfire ? 25 : 17;
 
-	SaveWriter saveWriter = GetSaveWriter(saveNum);
-	saveWriter.RemoveHashEntries(GetFileName);
-	CopyUtf8(hero_names[saveNum], heroinfo->name, sizeof(hero_names[saveNum]));
-
 	Player &player = Players[0];
-	CreatePlayer(player, heroinfo->heroclass);
-	CopyUtf8(player._pName, heroinfo->name, PlayerNameLength);
-	PackPlayer(pkplr, player);
-	EncodeHero(saveWriter, &pkplr);
-	Game2UiPlayer(player, heroinfo, false);
-	if (!gbVanilla) {
-		SaveHotkeys(saveWriter, player);
-		SaveHeroItems(saveWriter, player);
+	{
+		SaveWriter saveWriter = GetSaveWriter(saveNum);
+		saveWriter.RemoveHashEntries(GetFileName);
+		CopyUtf8(hero_names[saveNum], heroinfo->name, sizeof(hero_names[saveNum]));
+
+		CreatePlayer(player, heroinfo->heroclass);
+		CopyUtf8(player._pName, heroinfo->name, PlayerNameLength);
+		SaveSnapshot snapshot = SnapshotHero(player);
+		WriteSnapshot(saveWriter, snapshot, pfile_get_password());
 	}
+	Game2UiPlayer(player, heroinfo, false);
+	StoreHeroSummary(saveNum, heroinfo);
 
 	return true;
 }
@@ -749,7 +1188,9 @@ bool pfile_delete_save(_uiheroinfo *heroInfo)
 	const uint32_t saveNum = heroInfo->saveNumber;
 	if (saveNum < MAX_CHARACTERS) {
 		hero_names[saveNum][0] = '\0';
+		FinishAsyncSave(/*wait=*/true);
 		RemoveFile(GetSavePath(saveNum).c_str());
+		StoreHeroSummary(saveNum, nullptr);
 	}
 	return true;
 }
@@ -777,29 +1218,57 @@ void pfile_read_player_from_save(uint32_t saveNum, Player &player)
 
 void pfile_save_level()
 {
-	SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
-	SaveLevel(saveWriter);
+	if (gbIsMultiplayer) {
+		SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
+		SaveLevel(saveWriter);
+		return;
+	}
+
+	{
+		SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
+		SaveSnapshot snapshot;
+		SaveLevel(snapshot);
+		CacheLevelFile(snapshot.files.front());
+		WriteSnapshot(saveWriter, snapshot, pfile_get_password());
+	}
+	MarkSaveUnstamped(gSaveNumber);
+}
+
+std::span<const std::byte> pfile_cached_level_file(std::string_view name)
+{
+	for (const CachedLevelFile &level : LevelFileCache) {
+		if (level.saveNumber == gSaveNumber && level.name == name)
+			return { level.data.get(), level.size };
+	}
+	return {};
 }
 
 tl::expected<void, std::string> pfile_convert_levels()
 {
+	ClearLevelFileCache();
 	SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
 	return ConvertLevels(saveWriter);
 }
 
 void pfile_remove_temp_files()
 {
+	ClearLevelFileCache();
 	if (gbIsMultiplayer)
 		return;
 
-	SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
-	saveWriter.RemoveHashEntries(GetTempSaveNames);
+	{
+		SaveWriter saveWriter = GetSaveWriter(gSaveNumber);
+		saveWriter.RemoveHashEntries(GetTempSaveNames);
+	}
+	MarkSaveUnstamped(gSaveNumber);
 }
 
 void pfile_update(bool forceSave)
 {
 	static Uint32 prevTick;
 
+	FinishAsyncSave(/*wait=*/forceSave);
+
 	if (!gbIsMultiplayer)
 		return;
 
@@ -807,9 +1276,12 @@ void pfile_update(bool forceSave)
 	if (!forceSave && tick - prevTick <= 60000)
 		return;
 
+	// The previous save is still being written, try again on the next call
+	if (PendingSave != nullptr)
+		return;
+
 	prevTick = tick;
-	pfile_write_hero();
-	sfile_write_stash();
+	StartAsyncSave();
 }
 
 } // namespace devilution
@@ -5,8 +5,13 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <expected.hpp>
 
@@ -83,6 +88,19 @@ using SaveReader = MpqArchive;
 using SaveWriter = MpqWriter;
 #endif
 
+/**
+ * @brief Save files serialized on the game thread, encoded and written to an archive later.
+ */
+struct SaveSnapshot {
+	struct File {
+		std::string name;
+		/** @brief Unencoded contents, the buffer has room to encode them in place */
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+	};
+	std::vector<File> files;
+};
+
 /**
  * @brief Comparison result of pfile_compare_hero_demo
  */
@@ -125,9 +143,24 @@ bool pfile_ui_save_create(_uiheroinfo *heroinfo);
 bool pfile_delete_save(_uiheroinfo *heroInfo);
 void pfile_read_player_from_save(uint32_t saveNum, Player &player);
 void pfile_save_level();
+/**
+ * @brief Returns the unencoded contents of a level file that was saved during this session, or an empty span.
+ *
+ * Single player keeps the level files of the most recently left levels in memory, so going back to them does not
+ * need to read and decode them from the save. The dungeon layout is not part of the level file and is still
+ * generated again on every visit. The data stays valid until the next level is saved.
+ */
+std::span<const std::byte> pfile_cached_level_file(std::string_view name);
 tl::expected<void, std::string> pfile_convert_levels();
 void pfile_remove_temp_files();
 std::unique_ptr<std::byte[]> pfile_read(const char *pszName, size_t *pdwLen);
+
+/**
+ * @brief Periodically saves the hero and stash in multiplayer.
+ *
+ * The save is serialized right away but encoded and written on a worker thread.
+ * Later calls report the outcome, a forced save first waits for the previous one.
+ */
 void pfile_update(bool forceSave);
 
 } // namespace devilution
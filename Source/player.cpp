@@ -444,7 +444,7 @@ bool WeaponDecay(Player &player, int ii)
 			CalcPlrInv(player, true);
 			return true;
 		}
-		CalcPlrInv(player, true);
+		CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 	}
 	return false;
 }
@@ -2375,7 +2375,7 @@ void NextPlrLevel(Player &player)
 {
 	player.setCharacterLevel(player.getCharacterLevel() + 1);
 
-	CalcPlrInv(player, true);
+	CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 
 	if (CalcStatDiff(player) < 5) {
 		player._pStatPts = CalcStatDiff(player);
@@ -2410,7 +2410,7 @@ void NextPlrLevel(Player &player)
 	if (ControlMode != ControlTypes::KeyboardAndMouse)
 		FocusOnCharInfo();
 
-	CalcPlrInv(player, true);
+	CalcPlrInv(player, true, PlayerStatGroup::ItemBonuses);
 	PlaySFX(SfxID::ItemArmor);
 	PlaySFX(SfxID::ItemSign);
 }
@@ -2937,7 +2937,7 @@ void RestartTownLvl(Player &player)
 	player._pMana = 0;
 	player._pManaBase = player._pMana - (player._pMaxMana - player._pMaxManaBase);
 
-	CalcPlrInv(player, false);
+	CalcPlrInv(player, false, PlayerStatGroup::ItemBonuses);
 	player._pmode = PM_NEWLVL;
 
 	if (&player == MyPlayer) {
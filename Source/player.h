@@ -347,6 +347,8 @@ public:
 	bool _pBlockFlag;
 	bool _pInvincible;
 	int8_t _pLightRad;
+	/** @brief Derived stat groups that the next CalcPlrInv call has to recompute */
+	PlayerStatGroup staleStatGroups = PlayerStatGroup::All;
 	/** @brief True when the player is transitioning between levels */
 	bool _pLvlChanging;
 
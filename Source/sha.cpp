@@ -11,25 +11,83 @@ namespace devilution {
 namespace {
 
 /**
- * Diablo-"SHA1" circular left shift, portable version.
+ * Diablo-"SHA1" circular left shift.
+ *
+ * The SHA-like algorithm as originally implemented treated word as a signed value and used arithmetic right shifts
+ * (sign-extending). This results in the high 32-`bits` bits being set to 1 whenever the sign bit is set.
  */
-uint32_t SHA1CircularShift(uint32_t word, size_t bits)
+constexpr uint32_t SHA1CircularShift(uint32_t word, size_t bits)
 {
-	// The SHA-like algorithm as originally implemented treated word as a signed value and used arithmetic right shifts
-	//  (sign-extending). This results in the high 32-`bits` bits being set to 1.
-	if ((word & (1 << 31)) != 0)
-		return (0xFFFFFFFF << bits) | (word >> (32 - bits));
-	return (word << bits) | (word >> (32 - bits));
+	return (word << bits) | static_cast<uint32_t>(static_cast<int32_t>(word) >> (32 - bits));
 }
 
-void SHA1ProcessMessageBlock(SHA1Context *context)
+static_assert(SHA1CircularShift(0x40000001, 5) == 0x00000028);
+static_assert(SHA1CircularShift(0x80000001, 5) == 0xFFFFFFF0);
+
+struct Choose {
+	static constexpr uint32_t Constant = 0x5A827999;
+	static constexpr uint32_t Mix(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return (b & c) | ((~b) & d);
+	}
+};
+
+template <uint32_t K>
+struct Parity {
+	static constexpr uint32_t Constant = K;
+	static constexpr uint32_t Mix(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return b ^ c ^ d;
+	}
+};
+
+struct Majority {
+	static constexpr uint32_t Constant = 0x8F1BBCDC;
+	static constexpr uint32_t Mix(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return (b & c) | (b & d) | (c & d);
+	}
+};
+
+/**
+ * @brief Returns word `i` of the message schedule, keeping only the last 16 words in `w`.
+ *
+ * Unlike real SHA-1 the expanded words are not rotated.
+ */
+uint32_t Schedule(uint32_t w[BlockSize], int i)
 {
-	std::uint32_t w[80];
+	if (i >= 16)
+		w[i & 15] ^= w[(i + 2) & 15] ^ w[(i + 8) & 15] ^ w[(i + 13) & 15];
+	return w[i & 15];
+}
 
-	memcpy(w, context->buffer, BlockSize * sizeof(uint32_t));
-	for (int i = 16; i < 80; i++) {
-		w[i] = w[i - 16] ^ w[i - 14] ^ w[i - 8] ^ w[i - 3];
+/**
+ * @brief A single round. Instead of moving every variable along, the caller rotates the roles of the arguments.
+ */
+template <class Function>
+void Round(uint32_t a, uint32_t &b, uint32_t c, uint32_t d, uint32_t &e, uint32_t w)
+{
+	e += SHA1CircularShift(a, 5) + Function::Mix(b, c, d) + w + Function::Constant;
+	b = SHA1CircularShift(b, 30);
+}
+
+/** @brief 20 rounds with the same function, starting at round `first`. */
+template <class Function>
+void Rounds(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t w[BlockSize], int first)
+{
+	for (int i = first; i < first + 20; i += 5) {
+		Round<Function>(a, b, c, d, e, Schedule(w, i));
+		Round<Function>(e, a, b, c, d, Schedule(w, i + 1));
+		Round<Function>(d, e, a, b, c, Schedule(w, i + 2));
+		Round<Function>(c, d, e, a, b, Schedule(w, i + 3));
+		Round<Function>(b, c, d, e, a, Schedule(w, i + 4));
 	}
+}
+
+void SHA1ProcessMessageBlock(SHA1Context *context)
+{
+	std::uint32_t w[BlockSize];
+	memcpy(w, context->buffer, sizeof(w));
 
 	std::uint32_t a = context->state[0];
 	std::uint32_t b = context->state[1];
@@ -37,41 +95,10 @@ void SHA1ProcessMessageBlock(SHA1Context *context)
 	std::uint32_t d = context->state[3];
 	std::uint32_t e = context->state[4];
 
-	for (int i = 0; i < 20; i++) {
-		const std::uint32_t temp = SHA1CircularShift(a, 5) + ((b & c) | ((~b) & d)) + e + w[i] + 0x5A827999;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
-	}
-
-	for (int i = 20; i < 40; i++) {
-		const std::uint32_t temp = SHA1CircularShift(a, 5) + (b ^ c ^ d) + e + w[i] + 0x6ED9EBA1;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
-	}
-
-	for (int i = 40; i < 60; i++) {
-		const std::uint32_t temp = SHA1CircularShift(a, 5) + ((b & c) | (b & d) | (c & d)) + e + w[i] + 0x8F1BBCDC;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
-	}
-
-	for (int i = 60; i < 80; i++) {
-		const std::uint32_t temp = SHA1CircularShift(a, 5) + (b ^ c ^ d) + e + w[i] + 0xCA62C1D6;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
-	}
+	Rounds<Choose>(a, b, c, d, e, w, 0);
+	Rounds<Parity<0x6ED9EBA1>>(a, b, c, d, e, w, 20);
+	Rounds<Majority>(a, b, c, d, e, w, 40);
+	Rounds<Parity<0xCA62C1D6>>(a, b, c, d, e, w, 60);
 
 	context->state[0] += a;
 	context->state[1] += b;
@@ -18,6 +18,9 @@ namespace devilution {
 
 namespace {
 
+/** Bumped whenever the spell table changes. */
+uint32_t SpellDataGeneration;
+
 void AddNullSpell()
 {
 	SpellData &null = SpellsData.emplace_back();
@@ -229,6 +232,7 @@ tl::expected<SpellID, std::string> ParseSpellId(std::string_view value)
 
 void LoadSpellData()
 {
+	++SpellDataGeneration;
 	SpellsData.clear();
 	const std::string_view filename = "txtdata\\spells\\spelldat.tsv";
 	DataFile dataFile = DataFile::loadOrDie(filename);
@@ -257,4 +261,9 @@ void LoadSpellData()
 	SpellsData.shrink_to_fit();
 }
 
+uint32_t GetSpellDataGeneration()
+{
+	return SpellDataGeneration;
+}
+
 } // namespace devilution
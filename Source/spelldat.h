@@ -274,4 +274,7 @@ inline const SpellData &GetSpellData(SpellID spellId)
 
 void LoadSpellData();
 
+/** @brief Returns a counter that changes whenever spell data is (re)loaded. */
+uint32_t GetSpellDataGeneration();
+
 } // namespace devilution
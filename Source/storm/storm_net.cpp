@@ -4,11 +4,14 @@
 #include <memory>
 
 #ifndef NONET
+#include <atomic>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <utility>
 
 #include "utils/sdl_mutex.h"
+#include "utils/spsc_queue.hpp"
 #endif
 
 #include "dvlnet/abstract_net.h"
@@ -27,12 +30,130 @@ bool GameIsPublic = {};
 
 #ifndef NONET
 SdlMutex storm_net_mutex;
+
+struct ReceivedNetMessage {
+	bool isEvent;
+	/** @brief Sender of a message, or the player an event is about */
+	uint8_t sender;
+	uint32_t eventId;
+	std::vector<std::byte> payload;
+};
+
+/**
+ * @brief Messages and events on their way to the game thread.
+ *
+ * The producer is whichever thread holds storm_net_mutex, the consumer is the thread calling SNetReceiveMessage.
+ */
+SpscQueue<ReceivedNetMessage, 256> ReceiveQueue;
+/** @brief Takes what does not fit in ReceiveQueue, guarded by storm_net_mutex */
+std::deque<ReceivedNetMessage> ReceiveOverflow;
+std::atomic_bool ReceiveQueueEnabled;
+/** @brief Set while the front of ReceiveQueue is handed out by SNetReceiveMessage */
+bool HoldingQueuedMessage;
+/** @brief Message handed out by SNetReceiveMessage after it was taken from ReceiveOverflow */
+ReceivedNetMessage OverflowMessage;
+SEVTHANDLER EventHandlers[EVENT_TYPE_PLAYER_MESSAGE + 1];
+
+/** @brief Must be called with storm_net_mutex held */
+void QueueReceived(bool isEvent, uint8_t sender, uint32_t eventId, const void *data, size_t size)
+{
+	// Once something spilled over, everything after it has to go the same way to stay in order
+	ReceivedNetMessage *slot = ReceiveOverflow.empty() ? ReceiveQueue.tryReserve() : nullptr;
+	const bool spilled = slot == nullptr;
+	if (spilled)
+		slot = &ReceiveOverflow.emplace_back();
+
+	slot->isEvent = isEvent;
+	slot->sender = sender;
+	slot->eventId = eventId;
+	const auto *bytes = static_cast<const std::byte *>(data);
+	slot->payload.assign(bytes, bytes + size);
+
+	if (!spilled)
+		ReceiveQueue.commit();
+}
+
+/** @brief Must be called with storm_net_mutex held */
+void PumpReceiveQueue()
+{
+	while (ReceiveOverflow.empty() && !ReceiveQueue.full()) {
+		uint8_t sender;
+		void *data;
+		size_t size;
+		if (!dvlnet_inst->SNetReceiveMessage(&sender, &data, &size))
+			break;
+		QueueReceived(false, sender, 0, data, size);
+	}
+}
+
+/** @brief Registered with dvlnet in place of the real handlers, always called with storm_net_mutex held. */
+void HandleNetEvent(_SNETEVENT *ev)
+{
+	if (ReceiveQueueEnabled) {
+		QueueReceived(true, static_cast<uint8_t>(ev->playerid), ev->eventid, ev->data, ev->databytes);
+		return;
+	}
+	const SEVTHANDLER handler = EventHandlers[ev->eventid];
+	if (handler != nullptr)
+		handler(ev);
+}
+
+void DispatchQueuedEvent(ReceivedNetMessage &message)
+{
+	const SEVTHANDLER handler = EventHandlers[message.eventId];
+	if (handler == nullptr)
+		return;
+	_SNETEVENT ev;
+	ev.eventid = message.eventId;
+	ev.playerid = message.sender;
+	ev.data = message.payload.empty() ? nullptr : message.payload.data();
+	ev.databytes = message.payload.size();
+	handler(&ev);
+}
+
+bool ReceiveQueuedMessage(uint8_t *senderplayerid, void **data, size_t *databytes)
+{
+	while (true) {
+		if (HoldingQueuedMessage) {
+			ReceiveQueue.pop();
+			HoldingQueuedMessage = false;
+		}
+
+		ReceivedNetMessage *message = ReceiveQueue.front();
+		if (message == nullptr) {
+			std::lock_guard<SdlMutex> lg(storm_net_mutex);
+			PumpReceiveQueue();
+			message = ReceiveQueue.front();
+			if (message == nullptr) {
+				if (ReceiveOverflow.empty())
+					return false;
+				OverflowMessage = std::move(ReceiveOverflow.front());
+				ReceiveOverflow.pop_front();
+				message = &OverflowMessage;
+			}
+		}
+		HoldingQueuedMessage = message != &OverflowMessage;
+
+		// Event handlers may call back into storm_net, so they run without the lock
+		if (message->isEvent) {
+			DispatchQueuedEvent(*message);
+			continue;
+		}
+
+		*senderplayerid = message->sender;
+		*data = message->payload.data();
+		*databytes = message->payload.size();
+		return true;
+	}
+}
 #endif
 } // namespace
 
 bool SNetReceiveMessage(uint8_t *senderplayerid, void **data, size_t *databytes)
 {
 #ifndef NONET
+	if (ReceiveQueueEnabled)
+		return ReceiveQueuedMessage(senderplayerid, data, databytes);
 	std::lock_guard<SdlMutex> lg(storm_net_mutex);
 #endif
 	return dvlnet_inst->SNetReceiveMessage(senderplayerid, data, databytes);
@@ -76,6 +197,9 @@ bool SNetUnregisterEventHandler(event_type evtype)
 {
 #ifndef NONET
 	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+#ifndef NONET
+	EventHandlers[evtype] = nullptr;
 #endif
 	if (dvlnet_inst == nullptr)
 		return true;
@@ -86,8 +210,11 @@ bool SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func)
 {
 #ifndef NONET
 	std::lock_guard<SdlMutex> lg(storm_net_mutex);
-#endif
+	EventHandlers[evtype] = func;
+	return dvlnet_inst->SNetRegisterEventHandler(evtype, HandleNetEvent);
+#else
 	return dvlnet_inst->SNetRegisterEventHandler(evtype, func);
+#endif
 }
 
 bool SNetDestroy()
@@ -193,6 +320,14 @@ bool SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_inst->SNetGetTurnsInTransit(turns);
 }
 
+bool SNetGetLatency(uint8_t playerId, uint32_t *latency)
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+	return dvlnet_inst->SNetGetLatency(playerId, latency);
+}
+
 /**
  * @brief engine calls this only once with argument 1
  */
@@ -238,4 +373,30 @@ bool DvlNet_IsPublicGame()
 	return GameIsPublic;
 }
 
+void DvlNet_SetReceiveQueueEnabled(bool enabled)
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+	ReceiveQueueEnabled = enabled;
+	if (enabled)
+		return;
+	if (HoldingQueuedMessage) {
+		ReceiveQueue.pop();
+		HoldingQueuedMessage = false;
+	}
+	while (ReceiveQueue.front() != nullptr)
+		ReceiveQueue.pop();
+	ReceiveOverflow.clear();
+#endif
+}
+
+void DvlNet_PumpReceiveQueue()
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+	if (ReceiveQueueEnabled && dvlnet_inst != nullptr)
+		PumpReceiveQueue();
+#endif
+}
+
 } // namespace devilution
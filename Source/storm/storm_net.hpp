@@ -74,6 +74,14 @@ bool SNetDropPlayer(uint8_t playerid, uint32_t flags);
  */
 bool SNetGetTurnsInTransit(uint32_t *turns);
 
+/**
+ * @brief Retrieves the most recently measured round trip time to a player.
+ * @param playerId The player to query
+ * @param latency Receives the round trip time in milliseconds
+ * @return false if the player is not connected or has not been measured yet
+ */
+bool SNetGetLatency(uint8_t playerId, uint32_t *latency);
+
 bool SNetJoinGame(char *gameName, char *gamePassword, int *playerid);
 
 /*  SNetLeaveGame @ 119
@@ -139,4 +147,19 @@ void DvlNet_SetPassword(std::string pw);
 void DvlNet_ClearPassword();
 bool DvlNet_IsPublicGame();
 
+/**
+ * @brief Routes received messages and network events through a queue that is drained by SNetReceiveMessage.
+ *
+ * While enabled, any thread may poll the network and events are only delivered on the thread
+ * calling SNetReceiveMessage. Disabling drops everything that is still queued.
+ */
+void DvlNet_SetReceiveQueueEnabled(bool enabled);
+
+/**
+ * @brief Moves messages that arrived since the last call into the receive queue.
+ *
+ * Meant to be called from the network thread so that the network is serviced during long frames.
+ */
+void DvlNet_PumpReceiveQueue();
+
 } // namespace devilution
@@ -234,6 +234,49 @@ bool GetFileSize(const char *path, std::uintmax_t *size)
 #endif
 }
 
+bool GetFileModificationTime(const char *path, std::uint64_t *time)
+{
+#ifdef _WIN32
+	FILETIME lastWrite;
+#if defined(WINVER) && WINVER <= 0x0500 && (!defined(_WIN32_WINNT) || _WIN32_WINNT == 0)
+	HANDLE handle = ::CreateFileA(path, GENERIC_READ,
+	    FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+	    FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+	const bool success = ::GetFileTime(handle, NULL, NULL, &lastWrite) != 0;
+	::CloseHandle(handle);
+	if (!success)
+		return false;
+#else
+	WIN32_FILE_ATTRIBUTE_DATA attr;
+#ifdef DEVILUTIONX_WINDOWS_NO_WCHAR
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attr)) {
+		return false;
+	}
+#else
+	const auto pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr) {
+		LogError("UTF-8 -> UTF-16 conversion error code {}", ::GetLastError());
+		return false;
+	}
+	if (!GetFileAttributesExW(&pathUtf16[0], GetFileExInfoStandard, &attr)) {
+		return false;
+	}
+#endif
+	lastWrite = attr.ftLastWriteTime;
+#endif
+	*time = static_cast<std::uint64_t>(lastWrite.dwHighDateTime) << (sizeof(lastWrite.dwHighDateTime) * 8) | lastWrite.dwLowDateTime;
+	return true;
+#else
+	struct ::stat statResult;
+	if (::stat(path, &statResult) == -1)
+		return false;
+	*time = static_cast<std::uint64_t>(statResult.st_mtime);
+	return true;
+#endif
+}
+
 bool CreateDir(const char *path)
 {
 #ifdef DVL_HAS_FILESYSTEM
@@ -362,25 +405,48 @@ bool ResizeFile(const char *path, std::uintmax_t size)
 #endif
 }
 
-void RenameFile(const char *from, const char *to)
+bool RenameFile(const char *from, const char *to)
 {
 #ifdef _WIN32
-#ifdef DEVILUTIONX_WINDOWS_NO_WCHAR
-	::MoveFile(from, to);
+#if defined(WINVER) && WINVER <= 0x0500 && (!defined(_WIN32_WINNT) || _WIN32_WINNT == 0)
+	// MoveFileEx is not available on Windows 9x, so the target has to go first
+	::DeleteFileA(to);
+	if (!::MoveFileA(from, to)) {
+		LogError("MoveFileA({}, {}) failed: {}", from, to, ::GetLastError());
+		return false;
+	}
+#elif defined(DEVILUTIONX_WINDOWS_NO_WCHAR)
+	if (!::MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING)) {
+		LogError("MoveFileExA({}, {}) failed: {}", from, to, ::GetLastError());
+		return false;
+	}
 #else
 	const auto fromUtf16 = ToWideChar(from);
 	const auto toUtf16 = ToWideChar(to);
 	if (fromUtf16 == nullptr || toUtf16 == nullptr) {
 		LogError("UTF-8 -> UTF-16 conversion error code {}", ::GetLastError());
-		return;
+		return false;
+	}
+	if (!::MoveFileExW(&fromUtf16[0], &toUtf16[0], MOVEFILE_REPLACE_EXISTING)) {
+		LogError("MoveFileExW({}, {}) failed: {}", from, to, ::GetLastError());
+		return false;
 	}
-	::MoveFileW(&fromUtf16[0], &toUtf16[0]);
 #endif // _WIN32
+	return true;
 #elif defined(DVL_HAS_FILESYSTEM)
 	std::error_code ec;
 	std::filesystem::rename(reinterpret_cast<const char8_t *>(from), reinterpret_cast<const char8_t *>(to), ec);
+	if (ec) {
+		LogError("rename({}, {}) failed: {}", from, to, ec.message());
+		return false;
+	}
+	return true;
 #else
-	::rename(from, to);
+	if (::rename(from, to) != 0) {
+		LogError("rename({}, {}) failed: {}", from, to, std::strerror(errno));
+		return false;
+	}
+	return true;
 #endif
 }
 
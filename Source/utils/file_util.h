@@ -29,6 +29,13 @@ std::string_view Dirname(std::string_view path);
 bool FileExistsAndIsWriteable(const char *path);
 bool GetFileSize(const char *path, std::uintmax_t *size);
 
+/**
+ * @brief Retrieves the last write time of a file.
+ *
+ * The value is only meaningful when compared with another value returned for the same file.
+ */
+bool GetFileModificationTime(const char *path, std::uint64_t *time);
+
 /**
  * @brief Creates a single directory (non-recursively).
  *
@@ -38,7 +45,12 @@ bool CreateDir(const char *path);
 
 void RecursivelyCreateDir(const char *path);
 bool ResizeFile(const char *path, std::uintmax_t size);
-void RenameFile(const char *from, const char *to);
+/**
+ * @brief Renames a file, replacing `to` if it exists.
+ *
+ * @return True if the file was renamed.
+ */
+bool RenameFile(const char *from, const char *to);
 void CopyFileOverwrite(const char *from, const char *to);
 void RemoveFile(const char *path);
 FILE *OpenFile(const char *path, const char *mode);
@@ -19,12 +19,14 @@ public:
 		return CheckError(s_ != nullptr, "fopen(\"{}\", \"{}\")", path, mode);
 	}
 
-	void Close()
+	// Returns false if buffered data could not be written out.
+	bool Close()
 	{
-		if (s_ != nullptr) {
-			std::fclose(s_);
-			s_ = nullptr;
-		}
+		if (s_ == nullptr)
+			return true;
+		const bool ok = CheckError(std::fclose(s_) == 0, "fclose()");
+		s_ = nullptr;
+		return ok;
 	}
 
 	[[nodiscard]] bool IsOpen() const
@@ -0,0 +1,199 @@
+#include "utils/lz4_block.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace devilution {
+
+namespace {
+
+/** @brief Shortest match that can be encoded */
+constexpr size_t MinMatch = 4;
+/** @brief The last bytes of a block are always literals */
+constexpr size_t LastLiterals = 5;
+/** @brief The last match must start at least this many bytes before the end of the block */
+constexpr size_t MatchFindLimit = 12;
+constexpr size_t MaxOffset = 65535;
+constexpr unsigned HashLog = 12;
+/** @brief Lengths that do not fit in a token nibble continue in extra bytes */
+constexpr size_t RunMask = 15;
+
+uint32_t Read32(const std::byte *src)
+{
+	uint32_t value;
+	memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+uint32_t HashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761U) >> (32 - HashLog);
+}
+
+std::byte *WriteLength(std::byte *dst, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*dst++ = std::byte { 255 };
+	*dst++ = static_cast<std::byte>(length);
+	return dst;
+}
+
+/**
+ * @brief Writes a sequence of literals followed by a match, or only literals if matchLength is 0.
+ * @return End of the sequence, or nullptr if it does not fit
+ */
+std::byte *WriteSequence(std::byte *dst, const std::byte *dstEnd, const std::byte *literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	const size_t maxSize = 1 + (literalLength / 255 + 1) + literalLength + 2 + (matchLength / 255 + 1);
+	if (static_cast<size_t>(dstEnd - dst) < maxSize)
+		return nullptr;
+
+	std::byte *token = dst++;
+	uint8_t tokenValue;
+	if (literalLength >= RunMask) {
+		tokenValue = RunMask << 4;
+		dst = WriteLength(dst, literalLength - RunMask);
+	} else {
+		tokenValue = static_cast<uint8_t>(literalLength << 4);
+	}
+	memcpy(dst, literals, literalLength);
+	dst += literalLength;
+
+	if (matchLength != 0) {
+		*dst++ = static_cast<std::byte>(offset & 0xFF);
+		*dst++ = static_cast<std::byte>(offset >> 8);
+		const size_t matchCode = matchLength - MinMatch;
+		if (matchCode >= RunMask) {
+			tokenValue |= RunMask;
+			dst = WriteLength(dst, matchCode - RunMask);
+		} else {
+			tokenValue |= static_cast<uint8_t>(matchCode);
+		}
+	}
+
+	*token = static_cast<std::byte>(tokenValue);
+	return dst;
+}
+
+bool ReadLength(const std::byte *&src, const std::byte *srcEnd, size_t &length)
+{
+	while (true) {
+		if (src >= srcEnd)
+			return false;
+		const auto value = static_cast<uint8_t>(*src++);
+		length += value;
+		if (value != 255)
+			return true;
+	}
+}
+
+} // namespace
+
+size_t Lz4CompressBlock(const std::byte *src, size_t srcSize, std::byte *dst, size_t dstCapacity)
+{
+	const std::byte *const srcEnd = src + srcSize;
+	const std::byte *const dstEnd = dst + dstCapacity;
+	std::byte *out = dst;
+	const std::byte *ip = src;
+	const std::byte *anchor = src;
+
+	if (srcSize > MatchFindLimit) {
+		const std::byte *const matchLimit = srcEnd - LastLiterals;
+		const std::byte *const searchLimit = srcEnd - MatchFindLimit;
+		uint32_t table[1U << HashLog] = {};
+		unsigned misses = 0;
+
+		while (ip <= searchLimit) {
+			const uint32_t sequence = Read32(ip);
+			const uint32_t hash = HashSequence(sequence);
+			const std::byte *match = src + table[hash];
+			table[hash] = static_cast<uint32_t>(ip - src);
+
+			if (match >= ip || static_cast<size_t>(ip - match) > MaxOffset || Read32(match) != sequence) {
+				// Skip ahead faster through data that does not compress
+				ip += (misses++ >> 6) + 1;
+				continue;
+			}
+			misses = 0;
+
+			while (ip > anchor && match > src && ip[-1] == match[-1]) {
+				ip--;
+				match--;
+			}
+
+			const std::byte *matchEnd = ip + MinMatch;
+			const std::byte *ref = match + MinMatch;
+			while (matchEnd < matchLimit && *matchEnd == *ref) {
+				matchEnd++;
+				ref++;
+			}
+
+			out = WriteSequence(out, dstEnd, anchor, ip - anchor, ip - match, matchEnd - ip);
+			if (out == nullptr)
+				return 0;
+
+			ip = matchEnd;
+			anchor = ip;
+			if (ip <= searchLimit)
+				table[HashSequence(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+		}
+	}
+
+	out = WriteSequence(out, dstEnd, anchor, srcEnd - anchor, 0, 0);
+	if (out == nullptr)
+		return 0;
+
+	return out - dst;
+}
+
+size_t Lz4DecompressBlock(const std::byte *src, size_t srcSize, std::byte *dst, size_t dstCapacity)
+{
+	const std::byte *const srcEnd = src + srcSize;
+	const std::byte *const dstEnd = dst + dstCapacity;
+	std::byte *out = dst;
+
+	while (src < srcEnd) {
+		const auto token = static_cast<uint8_t>(*src++);
+
+		size_t literalLength = token >> 4;
+		if (literalLength == RunMask && !ReadLength(src, srcEnd, literalLength))
+			return 0;
+		if (literalLength > static_cast<size_t>(srcEnd - src) || literalLength > static_cast<size_t>(dstEnd - out))
+			return 0;
+		memcpy(out, src, literalLength);
+		src += literalLength;
+		out += literalLength;
+
+		// The last sequence has no match
+		if (src == srcEnd)
+			break;
+
+		if (srcEnd - src < 2)
+			return 0;
+		const size_t offset = static_cast<uint8_t>(src[0]) | (static_cast<uint8_t>(src[1]) << 8);
+		src += 2;
+		if (offset == 0 || offset > static_cast<size_t>(out - dst))
+			return 0;
+
+		size_t matchLength = token & RunMask;
+		if (matchLength == RunMask && !ReadLength(src, srcEnd, matchLength))
+			return 0;
+		matchLength += MinMatch;
+		if (matchLength > static_cast<size_t>(dstEnd - out))
+			return 0;
+
+		// Overlapping matches repeat the last `offset` bytes, so the copied span can double each step
+		const std::byte *match = out - offset;
+		while (matchLength > 0) {
+			const size_t chunk = std::min<size_t>(matchLength, out - match);
+			memcpy(out, match, chunk);
+			out += chunk;
+			matchLength -= chunk;
+		}
+	}
+
+	return out - dst;
+}
+
+} // namespace devilution
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace devilution {
+
+/**
+ * @brief Returns the worst case size of compressing `size` bytes with Lz4CompressBlock.
+ */
+constexpr size_t Lz4CompressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compresses a buffer using the LZ4 block format.
+ * @param src Data to compress
+ * @param srcSize Size of the data to compress
+ * @param dst Output buffer
+ * @param dstCapacity Size of the output buffer
+ * @return Size of the compressed data, or 0 if it does not fit in the output buffer
+ */
+size_t Lz4CompressBlock(const std::byte *src, size_t srcSize, std::byte *dst, size_t dstCapacity);
+
+/**
+ * @brief Decompresses an LZ4 block, rejecting malformed input.
+ * @param src Compressed data
+ * @param srcSize Size of the compressed data
+ * @param dst Output buffer
+ * @param dstCapacity Size of the output buffer
+ * @return Size of the decompressed data, or 0 if the input is malformed or does not fit in the output buffer
+ */
+size_t Lz4DecompressBlock(const std::byte *src, size_t srcSize, std::byte *dst, size_t dstCapacity);
+
+} // namespace devilution
@@ -0,0 +1,194 @@
+#include "utils/parallel_for.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <SDL.h>
+
+#include "appfat.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+namespace {
+
+struct ParallelForState {
+	tl::function_ref<void(size_t)> func;
+	size_t count;
+	std::atomic<size_t> next;
+};
+
+void RunParallelFor(ParallelForState &state)
+{
+	for (size_t i = state.next++; i < state.count; i = state.next++)
+		state.func(i);
+}
+
+int SDLCALL ParallelForWorker(void *data)
+{
+	RunParallelFor(*static_cast<ParallelForState *>(data));
+	return 0;
+}
+
+} // namespace
+
+unsigned GetHardwareConcurrency()
+{
+#if defined(USE_SDL1) || defined(__DJGPP__)
+	return 1;
+#else
+	return static_cast<unsigned>(std::max(SDL_GetCPUCount(), 1));
+#endif
+}
+
+void ParallelFor(size_t count, tl::function_ref<void(size_t)> func)
+{
+	if (count == 0)
+		return;
+
+	ParallelForState state { func, count, 0 };
+
+	const size_t workerCount = std::min<size_t>(count, GetHardwareConcurrency()) - 1;
+	std::vector<SdlThread> workers;
+	workers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; i++)
+		workers.emplace_back(ParallelForWorker, &state);
+
+	RunParallelFor(state);
+
+	for (SdlThread &worker : workers)
+		worker.join();
+}
+
+#ifdef __DJGPP__
+struct WorkerPool::State {
+};
+#else
+struct WorkerPool::State {
+	SdlMutex mutex;
+	/** Signalled when a new loop starts or the pool stops */
+	SDL_cond *wake;
+	/** Signalled when the last busy worker is done */
+	SDL_cond *done;
+	std::vector<SdlThread> workers;
+
+	const tl::function_ref<void(size_t)> *func = nullptr;
+	size_t count = 0;
+	std::atomic<size_t> next = 0;
+	/** Bumped for every loop, so a worker can tell whether it has already seen the current one */
+	uint32_t generation = 0;
+	/** Workers currently taking part in a loop */
+	size_t busy = 0;
+	bool stopping = false;
+
+	State()
+	    : wake(SDL_CreateCond())
+	    , done(SDL_CreateCond())
+	{
+		if (wake == nullptr || done == nullptr)
+			ErrSdl();
+	}
+
+	~State()
+	{
+		SDL_DestroyCond(wake);
+		SDL_DestroyCond(done);
+	}
+
+	void runItems()
+	{
+		for (size_t i = next++; i < count; i = next++)
+			(*func)(i);
+	}
+
+	static int SDLCALL Work(void *data)
+	{
+		State &state = *static_cast<State *>(data);
+		uint32_t seen = 0;
+		std::unique_lock<SdlMutex> lock(state.mutex);
+		while (true) {
+			while (!state.stopping && state.generation == seen)
+				SDL_CondWait(state.wake, state.mutex.get());
+			if (state.stopping)
+				return 0;
+
+			seen = state.generation;
+			state.busy++;
+			lock.unlock();
+			state.runItems();
+			lock.lock();
+			if (--state.busy == 0)
+				SDL_CondSignal(state.done);
+		}
+	}
+};
+#endif
+
+WorkerPool::WorkerPool() = default;
+
+WorkerPool::~WorkerPool()
+{
+#ifndef __DJGPP__
+	if (state_ == nullptr)
+		return;
+
+	{
+		const std::lock_guard<SdlMutex> lock(state_->mutex);
+		state_->stopping = true;
+		SDL_CondBroadcast(state_->wake);
+	}
+	for (SdlThread &worker : state_->workers)
+		worker.join();
+#endif
+}
+
+void WorkerPool::run(size_t count, tl::function_ref<void(size_t)> func)
+{
+	if (count == 0)
+		return;
+
+#ifndef __DJGPP__
+	if (!started_) {
+		started_ = true;
+		const unsigned workerCount = GetHardwareConcurrency() - 1;
+		if (workerCount > 0) {
+			state_ = std::make_unique<State>();
+			state_->workers.reserve(workerCount);
+			for (unsigned i = 0; i < workerCount; i++)
+				state_->workers.emplace_back(State::Work, state_.get());
+		}
+	}
+#endif
+
+	if (state_ == nullptr || count == 1) {
+		for (size_t i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+
+#ifndef __DJGPP__
+	State &state = *state_;
+	std::unique_lock<SdlMutex> lock(state.mutex);
+	// Workers that woke up too late for the previous loop may still be looking at it
+	while (state.busy != 0)
+		SDL_CondWait(state.done, state.mutex.get());
+	state.func = &func;
+	state.count = count;
+	state.next = 0;
+	state.generation++;
+	SDL_CondBroadcast(state.wake);
+	lock.unlock();
+
+	state.runItems();
+
+	lock.lock();
+	while (state.busy != 0)
+		SDL_CondWait(state.done, state.mutex.get());
+#endif
+}
+
+} // namespace devilution
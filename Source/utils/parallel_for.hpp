@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <function_ref.hpp>
+
+namespace devilution {
+
+/**
+ * @brief Returns the number of logical CPU cores, or 1 if threads are not available.
+ */
+unsigned GetHardwareConcurrency();
+
+/**
+ * @brief Calls `func` once for each index in [0, count), spreading the calls across worker threads.
+ *
+ * The calling thread takes part in the work and this only returns once every call has finished.
+ * `func` must be safe to call concurrently for different indices.
+ */
+void ParallelFor(size_t count, tl::function_ref<void(size_t)> func);
+
+/**
+ * @brief Runs ParallelFor style loops on worker threads that are started once and then wait for the next loop.
+ *
+ * Meant for loops that run every game tick, where starting threads each time would cost more than the work itself.
+ * The workers are started by the first call to run() and stopped when the pool is destroyed.
+ */
+class WorkerPool {
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/**
+	 * @brief Calls `func` once for each index in [0, count), the same way as ParallelFor.
+	 *
+	 * Must not be called from several threads at once.
+	 */
+	void run(size_t count, tl::function_ref<void(size_t)> func);
+
+private:
+	struct State;
+	std::unique_ptr<State> state_;
+	bool started_ = false;
+};
+
+} // namespace devilution
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace devilution {
+
+/**
+ * @brief A bounded lock-free queue for handing elements from one thread to another.
+ *
+ * Only one thread at a time may act as the producer (tryReserve, commit, tryPush, full)
+ * and only one thread at a time as the consumer (front, pop, empty).
+ * Elements are constructed up front and reused, so slots that own memory keep their capacity.
+ *
+ * @tparam T element type.
+ * @tparam N capacity.
+ */
+template <class T, size_t N>
+class SpscQueue {
+public:
+	/**
+	 * @brief Returns the slot the next element goes into, or nullptr if the queue is full.
+	 *
+	 * The element only becomes visible to the consumer once commit() is called.
+	 */
+	[[nodiscard]] T *tryReserve()
+	{
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == N)
+			return nullptr;
+		return &slots_[tail % N];
+	}
+
+	/** @brief Publishes the slot returned by the last call to tryReserve(). */
+	void commit()
+	{
+		tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool tryPush(T value)
+	{
+		T *slot = tryReserve();
+		if (slot == nullptr)
+			return false;
+		*slot = std::move(value);
+		commit();
+		return true;
+	}
+
+	[[nodiscard]] bool full() const
+	{
+		return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) == N;
+	}
+
+	/**
+	 * @brief Returns the oldest element, or nullptr if the queue is empty.
+	 *
+	 * The element stays valid until pop() is called.
+	 */
+	[[nodiscard]] T *front()
+	{
+		const size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire))
+			return nullptr;
+		return &slots_[head % N];
+	}
+
+	void pop()
+	{
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, N> slots_ {};
+	/** @brief Index of the oldest element, only written by the consumer */
+	alignas(64) std::atomic<size_t> head_ { 0 };
+	/** @brief Index of the next free slot, only written by the producer */
+	alignas(64) std::atomic<size_t> tail_ { 0 };
+};
+
+} // namespace devilution
@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "codec.h"
+
+namespace devilution {
+namespace {
+
+constexpr char Password[] = "xrgyrkj1";
+
+std::vector<std::byte> MakeInput(size_t size)
+{
+	std::vector<std::byte> data(codec_get_encoded_len(size));
+	for (size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>(i * 7 + 3);
+	return data;
+}
+
+void BM_Encode(benchmark::State &state)
+{
+	const size_t size = static_cast<size_t>(state.range(0));
+	// Encoding does not care what it is given, so keep re-encoding the same buffer.
+	std::vector<std::byte> data = MakeInput(size);
+	for (auto _ : state) {
+		codec_encode(data.data(), size, data.size(), Password);
+		benchmark::DoNotOptimize(data.data());
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+void BM_Decode(benchmark::State &state)
+{
+	const size_t size = static_cast<size_t>(state.range(0));
+	std::vector<std::byte> encoded = MakeInput(size);
+	codec_encode(encoded.data(), size, encoded.size(), Password);
+	std::vector<std::byte> data(encoded.size());
+	for (auto _ : state) {
+		// Decoding works in place, so start from the encoded data every time.
+		data = encoded;
+		if (codec_decode(data.data(), data.size(), Password) != size) {
+			state.SkipWithError("codec_decode failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+// A hero file, a typical level and a full game file.
+BENCHMARK(BM_Encode)->Arg(512)->Arg(64 * 1024)->Arg(320 * 1024);
+BENCHMARK(BM_Decode)->Arg(512)->Arg(64 * 1024)->Arg(320 * 1024);
+
+} // namespace
+} // namespace devilution
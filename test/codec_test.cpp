@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "codec.h"
 
 using namespace devilution;
 
+namespace {
+
 TEST(Codec, codec_get_encoded_len)
 {
 	EXPECT_EQ(codec_get_encoded_len(50), 72);
@@ -13,3 +19,60 @@ TEST(Codec, codec_get_encoded_len_eq)
 {
 	EXPECT_EQ(codec_get_encoded_len(128), 136);
 }
+
+std::vector<std::byte> MakeInput(size_t size)
+{
+	std::vector<std::byte> data(codec_get_encoded_len(size));
+	for (size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>(i * 7 + 3);
+	return data;
+}
+
+// Expected output of the original X-SHA-1 implementation, any change to it breaks existing saves.
+TEST(Codec, codec_encode)
+{
+	std::vector<std::byte> data = MakeInput(100);
+	codec_encode(data.data(), 100, data.size(), "xrgyrkj1");
+
+	const uint8_t expected[] = {
+		0x61, 0x67, 0xe5, 0x33, 0x51, 0xc2, 0x0e, 0xa0, 0xe9, 0xfc, 0x82, 0xc7, 0x4e, 0x4b, 0x2a, 0x00, 0x45, 0x2d, 0x92, 0xab,
+		0xed, 0xfb, 0x69, 0x8f, 0xe5, 0x56, 0x9a, 0x54, 0x15, 0x70, 0x1e, 0x4b, 0xfa, 0xff, 0xbe, 0x94, 0xc9, 0x51, 0x1e, 0x37,
+		0x79, 0x4f, 0xdd, 0x1b, 0x79, 0xda, 0x66, 0xd8, 0x81, 0xe4, 0xaa, 0xff, 0x76, 0x63, 0x32, 0xe8, 0xbd, 0xc5, 0x8a, 0x83,
+		0xc5, 0xc3, 0x41, 0x97, 0x0b, 0x5b, 0x9d, 0x9c, 0x70, 0x45, 0x8f, 0x4b, 0x9c, 0x30, 0x61, 0xbc, 0x0c, 0x17, 0xe7, 0x7e,
+		0xc5, 0x85, 0x33, 0x2e, 0x87, 0xc7, 0x11, 0x20, 0xc4, 0xd1, 0x1b, 0x3f, 0xe0, 0xbc, 0xfd, 0x30, 0xb8, 0xa3, 0x73, 0xea,
+		0xf6, 0xbf, 0x72, 0x66, 0xc8, 0x91, 0x4c, 0x44, 0xaf, 0xa3, 0x62, 0xbf, 0x67, 0x32, 0x68, 0xac, 0x1b, 0x09, 0xc2, 0x52,
+		0xf6, 0xbf, 0x72, 0x66, 0xc8, 0x91, 0x4c, 0x44, 0xf4, 0x5c, 0xc5, 0x1b, 0x00, 0x24, 0x00, 0x00
+	};
+	ASSERT_EQ(data.size(), sizeof(expected));
+	for (size_t i = 0; i < data.size(); i++)
+		EXPECT_EQ(static_cast<uint8_t>(data[i]), expected[i]) << "at " << i;
+}
+
+TEST(Codec, codec_encode_signature)
+{
+	std::vector<std::byte> data = MakeInput(4096);
+	codec_encode(data.data(), 4096, data.size(), "xrgyrkj1");
+
+	const uint8_t expected[] = { 0xcf, 0xcd, 0xcd, 0x23, 0x00, 0x40, 0x00, 0x00 };
+	for (size_t i = 0; i < sizeof(expected); i++)
+		EXPECT_EQ(static_cast<uint8_t>(data[4096 + i]), expected[i]) << "at " << i;
+}
+
+TEST(Codec, codec_decode)
+{
+	const std::vector<std::byte> original = MakeInput(1000);
+	std::vector<std::byte> data = original;
+	codec_encode(data.data(), 1000, data.size(), "szqnlsk1");
+	ASSERT_EQ(codec_decode(data.data(), data.size(), "szqnlsk1"), 1000);
+	for (size_t i = 0; i < 1000; i++)
+		EXPECT_EQ(data[i], original[i]) << "at " << i;
+}
+
+TEST(Codec, codec_decode_wrong_password)
+{
+	std::vector<std::byte> data = MakeInput(1000);
+	codec_encode(data.data(), 1000, data.size(), "szqnlsk1");
+	EXPECT_EQ(codec_decode(data.data(), data.size(), "xrgyrkj1"), 0);
+}
+
+} // namespace
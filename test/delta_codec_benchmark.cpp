@@ -0,0 +1,124 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "encrypt.h"
+#include "utils/lz4_block.hpp"
+
+namespace devilution {
+namespace {
+
+constexpr size_t ItemSlots = 127;
+constexpr size_t ItemRecordSize = 58;
+constexpr size_t ObjectRecordSize = 3;
+constexpr size_t MonsterSlots = 200;
+constexpr size_t MonsterRecordSize = 12;
+
+/**
+ * @brief Builds a buffer laid out like a CMD_DLEVEL payload from DeltaExportData.
+ *
+ * Untouched items and monsters are 0xFF like in the real deltas, touched ones get varied contents.
+ */
+std::vector<std::byte> MakeLevelDelta(size_t touched)
+{
+	uint32_t seed = 0x5eed;
+	auto next = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return static_cast<std::byte>(seed >> 24);
+	};
+
+	std::vector<std::byte> delta;
+	delta.push_back(std::byte { 5 }); // level id
+
+	for (size_t i = 0; i < ItemSlots; i++) {
+		if (i >= touched / 4) {
+			delta.push_back(std::byte { 0xFF });
+			continue;
+		}
+		delta.push_back(std::byte { 0x09 }); // bCmd
+		for (size_t j = 1; j < ItemRecordSize; j++)
+			delta.push_back(j < 12 ? next() : std::byte { 0 });
+	}
+
+	const size_t objects = touched / 8;
+	delta.push_back(static_cast<std::byte>(objects));
+	for (size_t i = 0; i < objects * ObjectRecordSize; i++)
+		delta.push_back(next());
+
+	for (size_t i = 0; i < MonsterSlots; i++) {
+		for (size_t j = 0; j < MonsterRecordSize; j++)
+			delta.push_back(i < touched ? next() : std::byte { 0xFF });
+	}
+
+	delta.push_back(std::byte { 0 }); // spawned monster count
+	delta.push_back(std::byte { 0 });
+
+	return delta;
+}
+
+void BM_PkwareCompress(benchmark::State &state)
+{
+	const std::vector<std::byte> delta = MakeLevelDelta(state.range(0));
+	std::vector<std::byte> buffer(delta.size());
+	uint32_t size = 0;
+	for (auto _ : state) {
+		memcpy(buffer.data(), delta.data(), delta.size());
+		size = PkwareCompress(buffer.data(), static_cast<uint32_t>(buffer.size()));
+		benchmark::DoNotOptimize(size);
+	}
+	state.SetBytesProcessed(state.iterations() * delta.size());
+	state.counters["ratio"] = static_cast<double>(size) / delta.size();
+}
+
+void BM_Lz4Compress(benchmark::State &state)
+{
+	const std::vector<std::byte> delta = MakeLevelDelta(state.range(0));
+	std::vector<std::byte> buffer(delta.size());
+	std::vector<std::byte> compressed(Lz4CompressBound(delta.size()));
+	size_t size = 0;
+	for (auto _ : state) {
+		memcpy(buffer.data(), delta.data(), delta.size());
+		size = Lz4CompressBlock(buffer.data(), buffer.size(), compressed.data(), compressed.size());
+		benchmark::DoNotOptimize(size);
+	}
+	state.SetBytesProcessed(state.iterations() * delta.size());
+	state.counters["ratio"] = static_cast<double>(size) / delta.size();
+}
+
+void BM_PkwareDecompress(benchmark::State &state)
+{
+	const std::vector<std::byte> delta = MakeLevelDelta(state.range(0));
+	std::vector<std::byte> compressed = delta;
+	const uint32_t compressedSize = PkwareCompress(compressed.data(), static_cast<uint32_t>(compressed.size()));
+	std::vector<std::byte> buffer(delta.size());
+	for (auto _ : state) {
+		memcpy(buffer.data(), compressed.data(), compressedSize);
+		const uint32_t size = PkwareDecompress(buffer.data(), compressedSize, buffer.size());
+		benchmark::DoNotOptimize(size);
+	}
+	state.SetBytesProcessed(state.iterations() * delta.size());
+}
+
+void BM_Lz4Decompress(benchmark::State &state)
+{
+	const std::vector<std::byte> delta = MakeLevelDelta(state.range(0));
+	std::vector<std::byte> compressed(Lz4CompressBound(delta.size()));
+	compressed.resize(Lz4CompressBlock(delta.data(), delta.size(), compressed.data(), compressed.size()));
+	std::vector<std::byte> buffer(delta.size());
+	for (auto _ : state) {
+		const size_t size = Lz4DecompressBlock(compressed.data(), compressed.size(), buffer.data(), buffer.size());
+		benchmark::DoNotOptimize(size);
+	}
+	state.SetBytesProcessed(state.iterations() * delta.size());
+}
+
+BENCHMARK(BM_PkwareCompress)->Arg(0)->Arg(50)->Arg(200);
+BENCHMARK(BM_Lz4Compress)->Arg(0)->Arg(50)->Arg(200);
+BENCHMARK(BM_PkwareDecompress)->Arg(0)->Arg(50)->Arg(200);
+BENCHMARK(BM_Lz4Decompress)->Arg(0)->Arg(50)->Arg(200);
+
+} // namespace
+} // namespace devilution
@@ -41,6 +41,18 @@ TEST(FileUtil, GetFileSize)
 	EXPECT_EQ(result, 42);
 }
 
+TEST(FileUtil, GetFileModificationTime)
+{
+	std::uint64_t time;
+	EXPECT_FALSE(GetFileModificationTime("this-file-should-not-exist", &time));
+	const std::string path = GetTmpPathName();
+	WriteDummyFile(path.c_str(), 42);
+	std::uint64_t first;
+	ASSERT_TRUE(GetFileModificationTime(path.c_str(), &first));
+	ASSERT_TRUE(GetFileModificationTime(path.c_str(), &time));
+	EXPECT_EQ(time, first);
+}
+
 TEST(FileUtil, FileExists)
 {
 	EXPECT_FALSE(FileExists("this-file-should-not-exist"));
@@ -61,6 +73,20 @@ TEST(FileUtil, ResizeFile)
 	EXPECT_EQ(size, 30);
 }
 
+TEST(FileUtil, RenameFileReplacesTarget)
+{
+	const std::string from = GetTmpPathName(".from.tmp");
+	const std::string to = GetTmpPathName();
+	WriteDummyFile(from.c_str(), 42);
+	WriteDummyFile(to.c_str(), 10);
+	ASSERT_TRUE(RenameFile(from.c_str(), to.c_str()));
+	EXPECT_FALSE(FileExists(from.c_str()));
+	std::uintmax_t size;
+	ASSERT_TRUE(GetFileSize(to.c_str(), &size));
+	EXPECT_EQ(size, 42);
+	EXPECT_FALSE(RenameFile(from.c_str(), to.c_str()));
+}
+
 TEST(FileUtil, Dirname)
 {
 	EXPECT_EQ(Dirname(""), ".");
@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "itemdat.h"
+#include "items.h"
+#include "player.h"
+#include "spelldat.h"
+
+namespace devilution {
+namespace {
+
+constexpr int64_t ItemCount = 1000000;
+
+/** @brief Loads the item tables and returns the base items that can drop. */
+std::vector<_item_indexes> InitItems()
+{
+	LoadItemData();
+	LoadSpellData();
+	Players.resize(1);
+	MyPlayer = &Players[0];
+	ClearUniqueItemFlags();
+
+	std::vector<_item_indexes> dropable;
+	for (size_t i = 0; i < AllItemsList.size(); i++) {
+		if (AllItemsList[i].dropRate > 0 && IsItemAvailable(static_cast<int>(i)))
+			dropable.push_back(static_cast<_item_indexes>(i));
+	}
+	return dropable;
+}
+
+void RollItems(benchmark::State &state, bool onlygood)
+{
+	const std::vector<_item_indexes> dropable = InitItems();
+	std::mt19937 rng(42);
+	Item item;
+	for (auto _ : state) {
+		const _item_indexes idx = dropable[rng() % dropable.size()];
+		const int lvl = 1 + static_cast<int>(rng() % 30);
+		const int uper = rng() % 4 == 0 ? 15 : 1;
+		item = {};
+		SetupAllItems(*MyPlayer, item, idx, rng() & INT32_MAX, lvl, uper, onlygood, false);
+		benchmark::DoNotOptimize(item._iIvalue);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void BM_RollDropItems(benchmark::State &state)
+{
+	RollItems(state, false);
+}
+
+void BM_RollGoodItems(benchmark::State &state)
+{
+	RollItems(state, true);
+}
+
+BENCHMARK(BM_RollDropItems)->Iterations(ItemCount)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RollGoodItems)->Iterations(ItemCount)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace devilution
@@ -1,5 +1,6 @@
 #include <climits>
 #include <random>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -112,6 +113,67 @@ void GenerateAllUniques(bool hellfire, const size_t expectedUniques)
 	EXPECT_EQ(foundUniques.size(), expectedUniques) << StrCat("test run seed ", testRunSeed);
 }
 
+TEST_F(ItemsTest, RecreateItemCacheMatchesGeneration)
+{
+	size_t weaponIndex = 0;
+	while (AllItemsList[weaponIndex].itype != ItemType::Sword || AllItemsList[weaponIndex].dropRate == 0)
+		weaponIndex++;
+	const auto idx = static_cast<_item_indexes>(weaponIndex);
+	const uint16_t createInfo = 20 | CF_ONLYGOOD;
+
+	ClearRecreateItemCache();
+	for (uint32_t seed = 1; seed <= 200; seed++) {
+		Item generated {};
+		RecreateItem(*MyPlayer, generated, idx, createInfo, seed, 0, 0);
+		const uint32_t rngAfterGeneration = GetLCGEngineState();
+
+		SetRndSeed(0);
+		Item cached {};
+		RecreateItem(*MyPlayer, cached, idx, createInfo, seed, 0, 0);
+
+		EXPECT_EQ(GetLCGEngineState(), rngAfterGeneration);
+		EXPECT_STREQ(cached._iIName, generated._iIName);
+		EXPECT_EQ(cached._iMagical, generated._iMagical);
+		EXPECT_EQ(cached._iPrePower, generated._iPrePower);
+		EXPECT_EQ(cached._iSufPower, generated._iSufPower);
+		EXPECT_EQ(cached._iIvalue, generated._iIvalue);
+		EXPECT_EQ(cached._iAC, generated._iAC);
+		EXPECT_EQ(cached._iMaxDur, generated._iMaxDur);
+	}
+
+	// Every second call repeats the one before it, only items depending on the player's stats are generated again
+	const RecreateItemCacheStats stats = GetRecreateItemCacheStats();
+	EXPECT_EQ(stats.hits + stats.misses, 400U);
+	EXPECT_GE(stats.hits, 190U);
+}
+
+TEST_F(ItemsTest, RecreateItemCacheFollowsDataReloads)
+{
+	size_t staffIndex = 0;
+	while (AllItemsList[staffIndex].itype != ItemType::Staff || AllItemsList[staffIndex].dropRate == 0)
+		staffIndex++;
+	const auto idx = static_cast<_item_indexes>(staffIndex);
+	const uint16_t createInfo = 20;
+	const std::string baseName = AllItemsList[staffIndex].iName;
+
+	ClearRecreateItemCache();
+	Item generated {};
+	RecreateItem(*MyPlayer, generated, idx, createInfo, 1, 0, 0);
+
+	// Changing the table without reloading it shows whether the item was served from the cache
+	AllItemsList[staffIndex].iName = "Changed";
+	Item cached {};
+	RecreateItem(*MyPlayer, cached, idx, createInfo, 1, 0, 0);
+	EXPECT_STREQ(cached._iName, generated._iName);
+
+	LoadSpellData();
+	Item regenerated {};
+	RecreateItem(*MyPlayer, regenerated, idx, createInfo, 1, 0, 0);
+	EXPECT_STRNE(regenerated._iName, generated._iName);
+
+	AllItemsList[staffIndex].iName = baseName;
+}
+
 TEST_F(ItemsTest, AllDiabloUniquesCanDrop)
 {
 	GenerateAllUniques(false, 79);
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "levels/gendung.h"
+#include "levels/line_of_sight.hpp"
+#include "levels/tile_properties.hpp"
+#include "monster.h"
+
+namespace devilution {
+namespace {
+
+void FillRandomLevel(std::mt19937 &rng, unsigned density)
+{
+	SOLData[0] = TileProperties::None;
+	SOLData[1] = TileProperties::Solid | TileProperties::BlockMissile;
+	SOLData[2] = TileProperties::BlockMissile;
+	SOLData[3] = TileProperties::Solid;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++)
+			dPiece[x][y] = rng() % density == 0 ? 1 + rng() % 3 : 0;
+	}
+	InvalidateLineOfSight();
+}
+
+TEST(LineOfSightTest, MatchesLineClear)
+{
+	std::mt19937 rng(1234);
+	for (unsigned density : { 2U, 5U, 20U }) {
+		FillRandomLevel(rng, density);
+		for (int i = 0; i < 20000; i++) {
+			const Point start { static_cast<int>(rng() % MAXDUNX), static_cast<int>(rng() % MAXDUNY) };
+			const Point end { static_cast<int>(rng() % MAXDUNX), static_cast<int>(rng() % MAXDUNY) };
+			ASSERT_EQ(IsMissileLineClear(start, end), LineClear(PosOkMissile, start, end)) << start << " to " << end;
+			ASSERT_EQ(IsSolidLineClear(start, end), LineClear(IsTileNotSolid, start, end)) << start << " to " << end;
+		}
+	}
+}
+
+TEST(LineOfSightTest, IgnoresEndPoints)
+{
+	std::mt19937 rng(1);
+	FillRandomLevel(rng, 1000000);
+	dPiece[10][10] = 1;
+	dPiece[20][10] = 1;
+	InvalidateLineOfSight();
+	EXPECT_TRUE(IsMissileLineClear({ 10, 10 }, { 20, 10 }));
+	EXPECT_TRUE(IsMissileLineClear({ 20, 10 }, { 10, 10 }));
+
+	dPiece[15][10] = 2;
+	InvalidateLineOfSight();
+	EXPECT_FALSE(IsMissileLineClear({ 10, 10 }, { 20, 10 }));
+	EXPECT_TRUE(IsSolidLineClear({ 10, 10 }, { 20, 10 }));
+}
+
+} // namespace
+} // namespace devilution
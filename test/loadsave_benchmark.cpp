@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "codec.h"
+#include "encrypt.h"
+#include "engine/assets.hpp"
+#include "engine/random.hpp"
+#include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "itemdat.h"
+#include "items.h"
+#include "levels/gendung.h"
+#include "lighting.h"
+#include "loadsave.h"
+#include "menu.h"
+#include "misdat.h"
+#include "missiles.h"
+#include "monstdat.h"
+#include "monster.h"
+#include "mpq/mpq_reader.hpp"
+#include "mpq/mpq_writer.hpp"
+#include "objdat.h"
+#include "objects.h"
+#include "pack.h"
+#include "pfile.h"
+#include "playerdat.hpp"
+#include "quests.h"
+#include "spelldat.h"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+
+namespace devilution {
+namespace {
+
+constexpr char ArchivePath[] = "loadsave_benchmark.sv";
+constexpr size_t SectorSize = 4096;
+
+/** @brief Name of the temporary level file, unencoded and encoded contents, and the encoded contents split and imploded like MpqWriter does. */
+struct LevelFile {
+	std::string name;
+	std::vector<std::byte> raw;
+	std::vector<std::byte> encoded;
+	std::vector<std::vector<std::byte>> sectors;
+	size_t compressedSize;
+};
+
+LevelFile Level;
+
+std::string SavePath()
+{
+	return paths::PrefPath() + "single_0.sv";
+}
+
+size_t FileSize(const char *path)
+{
+	uintmax_t size = 0;
+	GetFileSize(path, &size);
+	return static_cast<size_t>(size);
+}
+
+/**
+ * @brief Fills dungeon level 5 with as much state as a level can hold: 200 monsters, 127 dropped items, 127 objects and 100 missiles.
+ */
+void PopulateLevel()
+{
+	currlevel = 5;
+	leveltype = DTYPE_CATACOMBS;
+	setlevel = false;
+	SetRndSeed(42);
+
+	Player &myPlayer = *MyPlayer;
+	myPlayer.plractive = true;
+	myPlayer.setLevel(currlevel);
+	myPlayer.position.tile = { 56, 56 };
+	InitLighting();
+	myPlayer.lightId = AddLight(myPlayer.position.tile, 10);
+
+	InitLevelMonsters();
+	AddMonsterType(MT_GOLEM, PLACE_SPECIAL);
+	for (int i = 0; i < MAX_PLRS; i++)
+		AddMonster(GolemHoldingCell, Direction::South, 0, false);
+	const size_t monsterTypes[] = {
+		*AddMonsterType(MT_NZOMBIE, PLACE_SCATTER),
+		*AddMonsterType(MT_RFALLSP, PLACE_SCATTER),
+		*AddMonsterType(MT_WSKELAX, PLACE_SCATTER),
+	};
+	for (size_t i = ActiveMonsterCount; i < MaxMonsters; i++) {
+		const Point position { 16 + static_cast<int>(i % 40) * 2, 16 + static_cast<int>(i / 40) * 2 };
+		Monster *monster = AddMonster(position, static_cast<Direction>(i % 8), monsterTypes[i % 3], true);
+		monster->hitPoints = monster->maxHitPoints / static_cast<int>(1 + i % 4);
+	}
+
+	std::vector<_item_indexes> baseItems;
+	for (size_t i = 0; i < AllItemsList.size(); i++) {
+		if (AllItemsList[i].dropRate > 0 && IsItemAvailable(static_cast<int>(i)))
+			baseItems.push_back(static_cast<_item_indexes>(i));
+	}
+	for (int i = 0; i < MAXITEMS; i++) {
+		const int ii = AllocateItem();
+		Item &item = Items[ii];
+		SetupAllItems(myPlayer, item, baseItems[i % baseItems.size()], AdvanceRndSeed(), 5 + i % 25, 1, false, false);
+		item.position = { 16 + i % 60, 30 + (i / 60) * 2 };
+		dItem[item.position.x][item.position.y] = ii + 1;
+	}
+
+	ActiveObjectCount = 0;
+	for (int i = 0; i < MAXOBJECTS; i++)
+		AvailableObjects[i] = i;
+	const _object_id objectTypes[] = { OBJ_BARREL, OBJ_CHEST1, OBJ_CHEST2, OBJ_SARC, OBJ_BARRELEX };
+	for (int i = 0; ActiveObjectCount < MAXOBJECTS; i++)
+		AddObject(objectTypes[i % 5], { 16 + i % 60, 40 + (i / 60) * 2 });
+
+	InitMissiles();
+	for (int i = 0; i < 100; i++) {
+		const Point src { 16 + i % 50, 50 + i / 50 };
+		AddMissile(src, src + Direction::South, Direction::South, i % 2 == 0 ? MissileID::Arrow : MissileID::Firebolt, TARGET_MONSTERS, myPlayer, 10, 1);
+	}
+}
+
+void InitOnce()
+{
+	[[maybe_unused]] static const bool GlobalInitDone = []() {
+		LoadCoreArchives();
+		LoadGameArchives();
+		if (!HaveMainData()) {
+			LogError("This benchmark needs spawn.mpq or diabdat.mpq");
+			exit(1);
+		}
+
+		HeadlessMode = true;
+		paths::SetPrefPath(paths::BasePath());
+		gbVanilla = false;
+		gbIsHellfire = false;
+		gbIsSpawn = false;
+		gbIsMultiplayer = false;
+		gbIsHellfireSaveGame = false;
+		giNumberOfLevels = 17;
+
+		Players.resize(1);
+		MyPlayerId = 0;
+		MyPlayer = &Players[MyPlayerId];
+
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadMissileData();
+		LoadMonsterData();
+		LoadItemData();
+		LoadObjectData();
+		LoadQuestData();
+		InitQuests();
+
+		_uiheroinfo info {};
+		info.heroclass = HeroClass::Warrior;
+		pfile_ui_save_create(&info);
+		gSaveNumber = info.saveNumber;
+
+		PopulateLevel();
+
+		SaveSnapshot snapshot;
+		SaveLevel(snapshot);
+		SaveSnapshot::File &file = snapshot.files.front();
+		Level.name = file.name;
+		Level.raw.assign(file.data.get(), file.data.get() + file.size);
+		Level.encoded.resize(codec_get_encoded_len(file.size));
+		std::copy(Level.raw.begin(), Level.raw.end(), Level.encoded.begin());
+		codec_encode(Level.encoded.data(), Level.raw.size(), Level.encoded.size(), pfile_get_password());
+
+		Level.compressedSize = 0;
+		for (size_t offset = 0; offset < Level.encoded.size(); offset += SectorSize) {
+			const size_t len = std::min(SectorSize, Level.encoded.size() - offset);
+			std::vector<std::byte> sector(Level.encoded.begin() + offset, Level.encoded.begin() + offset + len);
+			const uint32_t compressedLen = PkwareCompress(sector.data(), static_cast<uint32_t>(len));
+			sector.resize(compressedLen);
+			Level.compressedSize += compressedLen;
+			Level.sectors.push_back(std::move(sector));
+		}
+
+		RemoveFile(ArchivePath);
+		MpqWriter writer(ArchivePath);
+		writer.WriteFile(Level.name, Level.encoded.data(), Level.encoded.size());
+		return true;
+	}();
+}
+
+void ReportSizes(benchmark::State &state)
+{
+	state.counters["raw"] = static_cast<double>(Level.raw.size());
+	state.counters["encoded"] = static_cast<double>(Level.encoded.size());
+	state.counters["compressed"] = static_cast<double>(Level.compressedSize);
+}
+
+void BM_SerializeLevel(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		SaveSnapshot snapshot;
+		SaveLevel(snapshot);
+		benchmark::DoNotOptimize(snapshot.files.front().data.get());
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+}
+
+void BM_EncodeLevel(benchmark::State &state)
+{
+	InitOnce();
+	// Encoding does not care what it is given, so keep re-encoding the same buffer.
+	std::vector<std::byte> buffer = Level.encoded;
+	for (auto _ : state) {
+		codec_encode(buffer.data(), Level.raw.size(), buffer.size(), pfile_get_password());
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+}
+
+void BM_DecodeLevel(benchmark::State &state)
+{
+	InitOnce();
+	std::vector<std::byte> buffer(Level.encoded.size());
+	for (auto _ : state) {
+		// Decoding works in place, so start from the encoded data every time.
+		std::copy(Level.encoded.begin(), Level.encoded.end(), buffer.begin());
+		const size_t size = codec_decode(buffer.data(), buffer.size(), pfile_get_password());
+		if (size != Level.raw.size()) {
+			state.SkipWithError("codec_decode failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+}
+
+void BM_CompressLevel(benchmark::State &state)
+{
+	InitOnce();
+	std::byte sector[SectorSize];
+	for (auto _ : state) {
+		for (size_t offset = 0; offset < Level.encoded.size(); offset += SectorSize) {
+			const size_t len = std::min(SectorSize, Level.encoded.size() - offset);
+			memcpy(sector, &Level.encoded[offset], len);
+			const uint32_t compressedLen = PkwareCompress(sector, static_cast<uint32_t>(len));
+			benchmark::DoNotOptimize(compressedLen);
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * Level.encoded.size());
+	ReportSizes(state);
+}
+
+void BM_DecompressLevel(benchmark::State &state)
+{
+	InitOnce();
+	std::vector<std::byte> workBuf(PkwareWorkBufferSize);
+	std::byte sector[SectorSize];
+	for (auto _ : state) {
+		for (size_t i = 0; i < Level.sectors.size(); i++) {
+			const std::vector<std::byte> &compressed = Level.sectors[i];
+			const size_t len = std::min(SectorSize, Level.encoded.size() - i * SectorSize);
+			// Same as MpqWriter, sectors that did not shrink are stored as is.
+			if (compressed.size() == len)
+				continue;
+			const uint32_t decompressedLen = PkwareDecompress(compressed.data(), static_cast<uint32_t>(compressed.size()), sector, len, workBuf.data());
+			benchmark::DoNotOptimize(decompressedLen);
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * Level.encoded.size());
+	ReportSizes(state);
+}
+
+void BM_WriteLevelArchive(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		state.PauseTiming();
+		RemoveFile(ArchivePath);
+		state.ResumeTiming();
+
+		MpqWriter writer(ArchivePath);
+		writer.WriteFile(Level.name, Level.encoded.data(), Level.encoded.size());
+	}
+	state.SetBytesProcessed(state.iterations() * Level.encoded.size());
+	ReportSizes(state);
+	state.counters["archive"] = static_cast<double>(FileSize(ArchivePath));
+}
+
+void BM_ReadLevelArchive(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		int32_t error = 0;
+		std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error);
+		if (!archive) {
+			state.SkipWithError("Failed to open archive");
+			break;
+		}
+		size_t size;
+		std::unique_ptr<std::byte[]> data = archive->ReadFile(Level.name, size, error);
+		if (data == nullptr) {
+			state.SkipWithError("Failed to read level");
+			break;
+		}
+		benchmark::DoNotOptimize(data.get());
+	}
+	state.SetBytesProcessed(state.iterations() * Level.encoded.size());
+	ReportSizes(state);
+}
+
+/** @brief SaveLevel as done when leaving a level: serialize, encode, compress and write to the save. */
+void BM_SaveLevel(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		pfile_save_level();
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+	state.counters["archive"] = static_cast<double>(FileSize(SavePath().c_str()));
+}
+
+/** @brief LoadLevel for a level that is not cached: read, decompress, decode and deserialize from the save. */
+void BM_LoadLevel(benchmark::State &state)
+{
+	InitOnce();
+	// Drops the cached levels, then writes the level to the save without caching it.
+	pfile_remove_temp_files();
+	{
+		SaveWriter saveWriter(SavePath());
+		SaveLevel(saveWriter);
+	}
+	for (auto _ : state) {
+		if (!LoadLevel().has_value()) {
+			state.SkipWithError("LoadLevel failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+}
+
+/** @brief LoadLevel when returning to a level that was left recently and is still cached. */
+void BM_LoadLevelCached(benchmark::State &state)
+{
+	InitOnce();
+	pfile_save_level();
+	for (auto _ : state) {
+		if (!LoadLevel().has_value()) {
+			state.SkipWithError("LoadLevel failed");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * Level.raw.size());
+	ReportSizes(state);
+}
+
+/** @brief A full save: game data including the current level, the hero and the hotkeys. */
+void BM_SaveGame(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		pfile_write_hero(/*writeGameData=*/true);
+	}
+	state.counters["archive"] = static_cast<double>(FileSize(SavePath().c_str()));
+}
+
+void BM_PackPlayer(benchmark::State &state)
+{
+	InitOnce();
+	PlayerPack pack;
+	for (auto _ : state) {
+		PackPlayer(pack, *MyPlayer);
+		benchmark::DoNotOptimize(pack);
+	}
+	state.SetBytesProcessed(state.iterations() * sizeof(pack));
+}
+
+void BM_UnPackPlayer(benchmark::State &state)
+{
+	InitOnce();
+	PlayerPack pack;
+	PackPlayer(pack, *MyPlayer);
+	for (auto _ : state) {
+		UnPackPlayer(pack, *MyPlayer);
+		benchmark::DoNotOptimize(MyPlayer);
+	}
+	state.SetBytesProcessed(state.iterations() * sizeof(pack));
+}
+
+BENCHMARK(BM_SerializeLevel);
+BENCHMARK(BM_EncodeLevel);
+BENCHMARK(BM_DecodeLevel);
+BENCHMARK(BM_CompressLevel);
+BENCHMARK(BM_DecompressLevel);
+BENCHMARK(BM_WriteLevelArchive);
+BENCHMARK(BM_ReadLevelArchive);
+BENCHMARK(BM_SaveLevel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadLevel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadLevelCached)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveGame)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PackPlayer);
+BENCHMARK(BM_UnPackPlayer);
+
+} // namespace
+} // namespace devilution
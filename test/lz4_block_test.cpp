@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/lz4_block.hpp"
+
+using namespace devilution;
+
+namespace {
+
+std::vector<std::byte> Compress(const std::vector<std::byte> &data)
+{
+	std::vector<std::byte> compressed(Lz4CompressBound(data.size()));
+	const size_t size = Lz4CompressBlock(data.data(), data.size(), compressed.data(), compressed.size());
+	compressed.resize(size);
+	return compressed;
+}
+
+void ExpectRoundTrip(const std::vector<std::byte> &data)
+{
+	const std::vector<std::byte> compressed = Compress(data);
+	ASSERT_FALSE(compressed.empty());
+	ASSERT_LE(compressed.size(), Lz4CompressBound(data.size()));
+
+	std::vector<std::byte> decompressed(data.size());
+	const size_t size = Lz4DecompressBlock(compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+	EXPECT_EQ(size, data.size());
+	EXPECT_EQ(decompressed, data);
+}
+
+std::vector<std::byte> MakeNoise(size_t size)
+{
+	std::vector<std::byte> data(size);
+	uint32_t state = 0x12345678;
+	for (std::byte &value : data) {
+		state = state * 1103515245 + 12345;
+		value = static_cast<std::byte>(state >> 24);
+	}
+	return data;
+}
+
+} // namespace
+
+TEST(Lz4Block, RoundTripShortInputs)
+{
+	for (size_t size = 0; size < 32; size++)
+		ExpectRoundTrip(std::vector<std::byte>(size, std::byte { 'a' }));
+}
+
+TEST(Lz4Block, RoundTripRepeatedData)
+{
+	std::vector<std::byte> data(100000, std::byte { 0xFF });
+	for (size_t i = 0; i < data.size(); i += 97)
+		data[i] = static_cast<std::byte>(i);
+	ExpectRoundTrip(data);
+	EXPECT_LT(Compress(data).size(), data.size() / 10);
+}
+
+TEST(Lz4Block, RoundTripIncompressibleData)
+{
+	ExpectRoundTrip(MakeNoise(70000));
+}
+
+TEST(Lz4Block, DecompressKnownBlock)
+{
+	// "abcabcabcabcabcabc" as literals "abc" followed by a match of 15 at offset 3
+	const std::vector<std::byte> block {
+		std::byte { 0x3B }, std::byte { 'a' }, std::byte { 'b' }, std::byte { 'c' }, std::byte { 0x03 }, std::byte { 0x00 },
+		std::byte { 0x00 }
+	};
+	std::vector<std::byte> decompressed(18);
+	ASSERT_EQ(Lz4DecompressBlock(block.data(), block.size(), decompressed.data(), decompressed.size()), 18);
+	for (size_t i = 0; i < decompressed.size(); i++)
+		EXPECT_EQ(decompressed[i], static_cast<std::byte>("abc"[i % 3]));
+}
+
+TEST(Lz4Block, RejectsMalformedInput)
+{
+	std::vector<std::byte> output(64);
+
+	// Match offset pointing before the start of the output
+	const std::vector<std::byte> badOffset { std::byte { 0x10 }, std::byte { 'a' }, std::byte { 0x02 }, std::byte { 0x00 } };
+	EXPECT_EQ(Lz4DecompressBlock(badOffset.data(), badOffset.size(), output.data(), output.size()), 0);
+
+	// Literal run longer than the input
+	const std::vector<std::byte> truncated { std::byte { 0x50 }, std::byte { 'a' } };
+	EXPECT_EQ(Lz4DecompressBlock(truncated.data(), truncated.size(), output.data(), output.size()), 0);
+
+	// Output that does not fit
+	const std::vector<std::byte> data(200, std::byte { 'x' });
+	const std::vector<std::byte> compressed = Compress(data);
+	EXPECT_EQ(Lz4DecompressBlock(compressed.data(), compressed.size(), output.data(), output.size()), 0);
+}
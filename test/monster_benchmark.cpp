@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/assets.hpp"
+#include "engine/random.hpp"
+#include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "itemdat.h"
+#include "items.h"
+#include "levels/gendung.h"
+#include "levels/tile_properties.hpp"
+#include "lighting.h"
+#include "missiles.h"
+#include "monstdat.h"
+#include "monster.h"
+#include "player.h"
+#include "playerdat.hpp"
+#include "spelldat.h"
+#include "sync.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+namespace {
+
+/** @brief Roughly the space left for sync data in a game tick */
+constexpr size_t SyncBufferSize = 512;
+/** @brief Game ticks per iteration of the ProcessMonsters benchmarks, enough for the monsters to walk a few tiles */
+constexpr int TicksPerIteration = 20;
+
+/**
+ * @brief Fills every monster slot with an active monster, in the scattered ActiveMonsters order a level has after
+ * monsters died and spawned.
+ */
+void InitMonsters()
+{
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[0];
+	MyPlayer->position.tile = { 56, 56 };
+	MyPlayer->_pLvlChanging = false;
+	ActiveItemCount = 0;
+
+	std::iota(std::begin(ActiveMonsters), std::end(ActiveMonsters), 0U);
+	std::mt19937 rng(42);
+	std::shuffle(std::begin(ActiveMonsters), std::end(ActiveMonsters), rng);
+	ActiveMonsterCount = MaxMonsters;
+
+	for (size_t i = 0; i < MaxMonsters; i++) {
+		Monster &monster = Monsters[i];
+		monster.position.tile = { static_cast<int8_t>(16 + rng() % 80), static_cast<int8_t>(16 + rng() % 80) };
+		monster.position.future = monster.position.tile;
+		monster.hitPoints = 100 << 6;
+		monster.maxHitPoints = monster.hitPoints;
+		monster.mode = MonsterMode::Stand;
+		monster.activeForTicks = rng() % 4 == 0 ? 0 : UINT8_MAX;
+		monster.flags = 0;
+		monster.enemy = 0;
+		monster.whoHit = 0;
+	}
+	sync_init();
+}
+
+/** @brief Pushes the monsters out of the data caches, as the rest of a game tick would. */
+void EvictCaches()
+{
+	static std::vector<std::byte> scratch(32 * 1024 * 1024);
+	for (size_t i = 0; i < scratch.size(); i += 64)
+		scratch[i] = static_cast<std::byte>(i);
+	benchmark::DoNotOptimize(scratch.data());
+	benchmark::ClobberMemory();
+}
+
+void BM_SyncAllMonsters(benchmark::State &state)
+{
+	InitMonsters();
+	std::array<std::byte, SyncBufferSize> buffer;
+	for (auto _ : state) {
+		const size_t left = sync_all_monsters(buffer.data(), buffer.size());
+		benchmark::DoNotOptimize(left);
+	}
+	state.SetItemsProcessed(state.iterations() * ActiveMonsterCount);
+}
+
+void BM_SyncAllMonstersColdCache(benchmark::State &state)
+{
+	InitMonsters();
+	std::array<std::byte, SyncBufferSize> buffer;
+	for (auto _ : state) {
+		state.PauseTiming();
+		EvictCaches();
+		state.ResumeTiming();
+		const size_t left = sync_all_monsters(buffer.data(), buffer.size());
+		benchmark::DoNotOptimize(left);
+	}
+	state.SetItemsProcessed(state.iterations() * ActiveMonsterCount);
+}
+
+void LoadGameData()
+{
+	[[maybe_unused]] static const bool GlobalInitDone = []() {
+		LoadCoreArchives();
+		LoadGameArchives();
+		if (!HaveMainData()) {
+			LogError("This benchmark needs spawn.mpq or diabdat.mpq");
+			exit(1);
+		}
+
+		HeadlessMode = true;
+		gbVanilla = false;
+		gbIsHellfire = false;
+		gbIsSpawn = false;
+		gbIsMultiplayer = false;
+
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadMissileData();
+		LoadMonsterData();
+		LoadItemData();
+		return true;
+	}();
+}
+
+/**
+ * @brief Fills a catacombs level with monsters that search for paths, chasing the player through the gaps of two walls.
+ */
+void PopulateLevel()
+{
+	currlevel = 5;
+	leveltype = DTYPE_CATACOMBS;
+	setlevel = false;
+	SetRndSeed(7);
+
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[0];
+	MyPlayer->plractive = true;
+	MyPlayer->setLevel(currlevel);
+	MyPlayer->position.tile = { 80, 56 };
+	MyPlayer->position.future = MyPlayer->position.tile;
+	MyPlayer->_pLvlChanging = false;
+	InitLighting();
+
+	SOLData[0] = TileProperties::None;
+	SOLData[1] = TileProperties::Solid | TileProperties::BlockMissile;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			const bool firstWall = x == 40 && y >= 16 && y < 96 && y != 30 && y != 56 && y != 80;
+			const bool secondWall = x == 60 && y >= 16 && y < 96 && y != 44 && y != 68;
+			dPiece[x][y] = firstWall || secondWall ? 1 : 0;
+			dMonster[x][y] = 0;
+		}
+	}
+
+	InitLevelMonsters();
+	AddMonsterType(MT_GOLEM, PLACE_SPECIAL);
+	for (int i = 0; i < MAX_PLRS; i++)
+		AddMonster(GolemHoldingCell, Direction::South, 0, false);
+	const size_t typeIndex = *AddMonsterType(MT_NGOATMC, PLACE_SCATTER);
+	for (int i = 0; i < 150; i++) {
+		Monster *monster = AddMonster({ 18 + (i % 10) * 2, 20 + (i / 10) * 4 }, Direction::South, typeIndex, true);
+		monster->flags |= MFLAG_SEARCH;
+		monster->flags &= ~MFLAG_NO_ENEMY;
+		monster->enemy = 0;
+		monster->enemyPosition = MyPlayer->position.tile;
+		monster->activeForTicks = UINT8_MAX;
+		monster->pathCount = 4;
+	}
+
+	InitItems();
+	InitMissiles();
+	CompileTileBitboards();
+}
+
+/** @brief Runs the monsters of a populated level, with or without searching paths ahead of the AI. */
+void ProcessMonsterTicks(benchmark::State &state, bool planned)
+{
+	LoadGameData();
+	TestForceMonsterPathPlanning(planned);
+	for (auto _ : state) {
+		state.PauseTiming();
+		PopulateLevel();
+		state.ResumeTiming();
+		for (int i = 0; i < TicksPerIteration; i++)
+			ProcessMonsters();
+	}
+	TestForceMonsterPathPlanning(std::nullopt);
+	ClearTileBitboards();
+	state.SetItemsProcessed(state.iterations() * TicksPerIteration);
+}
+
+void BM_ProcessMonstersPlanned(benchmark::State &state)
+{
+	ProcessMonsterTicks(state, true);
+}
+
+void BM_ProcessMonstersUnplanned(benchmark::State &state)
+{
+	ProcessMonsterTicks(state, false);
+}
+
+BENCHMARK(BM_SyncAllMonsters);
+BENCHMARK(BM_SyncAllMonstersColdCache);
+BENCHMARK(BM_ProcessMonstersPlanned);
+BENCHMARK(BM_ProcessMonstersUnplanned);
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,145 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/assets.hpp"
+#include "engine/random.hpp"
+#include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "itemdat.h"
+#include "items.h"
+#include "levels/gendung.h"
+#include "levels/tile_properties.hpp"
+#include "lighting.h"
+#include "loadsave.h"
+#include "missiles.h"
+#include "monstdat.h"
+#include "monster.h"
+#include "player.h"
+#include "playerdat.hpp"
+#include "spelldat.h"
+
+namespace devilution {
+namespace {
+
+constexpr Point PlayerPosition = { 60, 40 };
+/** @brief The monsters have to go through this gap in the wall to reach the player */
+constexpr Point WallGap = { 50, 40 };
+
+class PathPlanningTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		LoadCoreArchives();
+		LoadGameArchives();
+
+		// The tests need spawn.mpq or diabdat.mpq
+		// Please provide them so that the tests can run successfully
+		ASSERT_TRUE(HaveMainData());
+
+		HeadlessMode = true;
+		gbVanilla = false;
+		gbIsHellfire = false;
+		gbIsSpawn = false;
+		gbIsMultiplayer = false;
+		giNumberOfLevels = 17;
+
+		Players.resize(1);
+		MyPlayerId = 0;
+		MyPlayer = &Players[MyPlayerId];
+
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadMissileData();
+		LoadMonsterData();
+		LoadItemData();
+	}
+
+	void TearDown() override
+	{
+		TestForceMonsterPathPlanning(std::nullopt);
+		ClearTileBitboards();
+		for (int x = 0; x < MAXDUNX; x++) {
+			for (int y = 0; y < MAXDUNY; y++)
+				dPiece[x][y] = 0;
+		}
+	}
+};
+
+/**
+ * @brief Fills a catacombs level with monsters that search for paths, on the other side of a wall from the player.
+ */
+void PopulateLevel()
+{
+	currlevel = 5;
+	leveltype = DTYPE_CATACOMBS;
+	setlevel = false;
+	SetRndSeed(7);
+
+	Player &myPlayer = *MyPlayer;
+	myPlayer.plractive = true;
+	myPlayer.setLevel(currlevel);
+	myPlayer.position.tile = PlayerPosition;
+	myPlayer.position.future = PlayerPosition;
+	InitLighting();
+
+	SOLData[0] = TileProperties::None;
+	SOLData[1] = TileProperties::Solid | TileProperties::BlockMissile;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPiece[x][y] = x == WallGap.x && y >= 20 && y <= 60 && y != WallGap.y ? 1 : 0;
+			dMonster[x][y] = 0;
+		}
+	}
+
+	InitLevelMonsters();
+	AddMonsterType(MT_GOLEM, PLACE_SPECIAL);
+	for (int i = 0; i < MAX_PLRS; i++)
+		AddMonster(GolemHoldingCell, Direction::South, 0, false);
+	const size_t typeIndex = *AddMonsterType(MT_NGOATMC, PLACE_SCATTER);
+	for (int i = 0; i < 30; i++) {
+		Monster *monster = AddMonster({ 32 + (i % 6) * 3, 25 + (i / 6) * 6 }, Direction::South, typeIndex, true);
+		monster->flags |= MFLAG_SEARCH;
+		monster->flags &= ~MFLAG_NO_ENEMY;
+		monster->enemy = 0;
+		monster->enemyPosition = PlayerPosition;
+		monster->activeForTicks = UINT8_MAX;
+		monster->pathCount = 4;
+	}
+
+	InitItems();
+	InitMissiles();
+	CompileTileBitboards();
+}
+
+struct TickResult {
+	std::vector<std::byte> level;
+	uint32_t rngState;
+};
+
+TickResult RunTicks(bool planned)
+{
+	PopulateLevel();
+	TestForceMonsterPathPlanning(planned);
+	for (int i = 0; i < 100; i++)
+		ProcessMonsters();
+
+	SaveSnapshot snapshot;
+	SaveLevel(snapshot);
+	const SaveSnapshot::File &file = snapshot.files.front();
+	return { { file.data.get(), file.data.get() + file.size }, GetLCGEngineState() };
+}
+
+TEST_F(PathPlanningTest, PlannedTicksMatchUnplanned)
+{
+	const TickResult unplanned = RunTicks(false);
+	const TickResult planned = RunTicks(true);
+	EXPECT_EQ(planned.rngState, unplanned.rngState);
+	EXPECT_EQ(planned.level, unplanned.level);
+}
+
+} // namespace
+} // namespace devilution
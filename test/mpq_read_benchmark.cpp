@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "mpq/mpq_reader.hpp"
+#include "mpq/mpq_writer.hpp"
+#include "utils/file_util.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+namespace {
+
+constexpr char ArchivePath[] = "mpq_read_benchmark.mpq";
+constexpr size_t AssetCount = 256;
+
+/**
+ * @brief Builds an asset somewhere between 1 KiB and 160 KiB, mostly repetitive like sprite data, every fourth one noise like audio.
+ */
+std::vector<std::byte> MakeAsset(uint32_t seed)
+{
+	auto next = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return static_cast<std::byte>(seed >> 24);
+	};
+
+	const size_t size = 1024 + (seed * 40503U) % (159 * 1024);
+	const bool noise = seed % 4 == 0;
+	std::vector<std::byte> asset(size);
+	for (size_t i = 0; i < size; i++)
+		asset[i] = noise || (i % 61) < 5 ? next() : static_cast<std::byte>(i / 64);
+	return asset;
+}
+
+struct AssetArchive {
+	std::vector<std::string> names;
+	size_t bytes = 0;
+
+	AssetArchive()
+	{
+		RemoveFile(ArchivePath);
+		MpqWriter writer(ArchivePath);
+		for (size_t i = 0; i < AssetCount; i++) {
+			const std::vector<std::byte> asset = MakeAsset(static_cast<uint32_t>(i + 1));
+			names.push_back(StrCat("data\\asset", i, ".clx"));
+			writer.WriteFile(names.back(), asset.data(), asset.size());
+			bytes += asset.size();
+		}
+	}
+
+	~AssetArchive()
+	{
+		RemoveFile(ArchivePath);
+	}
+};
+
+/**
+ * @brief Reads every `stride`-th asset starting at `first` the way OpenAsset does, block by block.
+ * @return false on error
+ */
+bool LoadAssets(MpqArchive &archive, const std::vector<std::string> &names, size_t first, size_t stride)
+{
+	std::vector<uint8_t> block;
+	int32_t error;
+	for (size_t i = first; i < names.size(); i += stride) {
+		const std::string &name = names[i];
+		uint32_t fileNumber;
+		if (!archive.GetFileNumber(CalculateMpqFileHash(name), fileNumber) || archive.OpenBlockOffsetTable(fileNumber, name) != 0)
+			return false;
+		const uint32_t numBlocks = archive.GetNumBlocks(fileNumber, error);
+		for (uint32_t blockNumber = 0; blockNumber < numBlocks; blockNumber++) {
+			const size_t blockSize = archive.GetBlockSize(fileNumber, blockNumber, error);
+			block.resize(blockSize);
+			if (archive.ReadBlock(fileNumber, blockNumber, block.data(), blockSize) != 0)
+				return false;
+		}
+		archive.CloseBlockOffsetTable(fileNumber);
+		benchmark::DoNotOptimize(block.data());
+	}
+	return true;
+}
+
+void LoadAllAssets(benchmark::State &state, bool memoryMap)
+{
+	const AssetArchive assets;
+
+	for (auto _ : state) {
+		int32_t error;
+		std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error, memoryMap);
+		if (!archive || !LoadAssets(*archive, assets.names, 0, 1)) {
+			state.SkipWithError("Failed to read archive");
+			return;
+		}
+	}
+
+	state.SetBytesProcessed(state.iterations() * assets.bytes);
+}
+
+/** @brief Splits the assets over `state.range(0)` threads, each reading through its own clone of one shared archive. */
+void LoadAllAssetsThreaded(benchmark::State &state, bool memoryMap)
+{
+	const AssetArchive assets;
+	const auto threadCount = static_cast<size_t>(state.range(0));
+
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error, memoryMap);
+	if (!archive) {
+		state.SkipWithError("Failed to open archive");
+		return;
+	}
+
+	for (auto _ : state) {
+		std::vector<std::thread> threads;
+		std::vector<char> ok(threadCount, 0);
+		for (size_t i = 0; i < threadCount; i++) {
+			threads.emplace_back([&, i]() {
+				int32_t cloneError;
+				std::optional<MpqArchive> clone = archive->Clone(cloneError);
+				ok[i] = clone && LoadAssets(*clone, assets.names, i, threadCount) ? 1 : 0;
+			});
+		}
+		for (std::thread &thread : threads)
+			thread.join();
+		if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+			state.SkipWithError("Failed to read archive");
+			return;
+		}
+	}
+
+	state.SetBytesProcessed(state.iterations() * assets.bytes);
+}
+
+void BM_LoadAllAssetsLibmpq(benchmark::State &state)
+{
+	LoadAllAssets(state, false);
+}
+
+void BM_LoadAllAssetsMapped(benchmark::State &state)
+{
+	LoadAllAssets(state, true);
+}
+
+void BM_LoadAllAssetsThreadedLibmpq(benchmark::State &state)
+{
+	LoadAllAssetsThreaded(state, false);
+}
+
+void BM_LoadAllAssetsThreadedMapped(benchmark::State &state)
+{
+	LoadAllAssetsThreaded(state, true);
+}
+
+BENCHMARK(BM_LoadAllAssetsLibmpq)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadAllAssetsMapped)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadAllAssetsThreadedLibmpq)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadAllAssetsThreadedMapped)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace devilution
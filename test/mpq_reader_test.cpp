@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mpq/mpq_reader.hpp"
+#include "mpq/mpq_writer.hpp"
+#include "utils/file_util.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr char ArchivePath[] = "mpq_reader_test.mpq";
+
+std::vector<std::byte> MakeFile(size_t size, bool noise)
+{
+	uint32_t seed = static_cast<uint32_t>(size);
+	std::vector<std::byte> data(size);
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = noise || (i % 50) == 0 ? static_cast<std::byte>(seed >> 24) : static_cast<std::byte>(i / 100);
+	}
+	return data;
+}
+
+class MpqReaderTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		RemoveFile(ArchivePath);
+		files_ = {
+			{ "small.txt", MakeFile(10, false) },
+			{ "levels\\l1data\\l1.cel", MakeFile(70000, false) },
+			// Sectors that do not compress are stored as they are.
+			{ "sfx\\misc\\noise.wav", MakeFile(20000, true) },
+			{ "exact.bin", MakeFile(4096 * 3, false) },
+		};
+		MpqWriter writer(ArchivePath);
+		for (const auto &[name, data] : files_)
+			ASSERT_TRUE(writer.WriteFile(name, data.data(), data.size()));
+	}
+
+	void TearDown() override
+	{
+		RemoveFile(ArchivePath);
+	}
+
+	static std::vector<std::byte> ReadBlocks(MpqArchive &archive, const std::string &name)
+	{
+		std::vector<std::byte> result;
+		uint32_t fileNumber;
+		if (!archive.GetFileNumber(CalculateMpqFileHash(name), fileNumber))
+			return result;
+		EXPECT_EQ(archive.OpenBlockOffsetTable(fileNumber, name), 0);
+		int32_t error;
+		const uint32_t numBlocks = archive.GetNumBlocks(fileNumber, error);
+		EXPECT_EQ(error, 0);
+		for (uint32_t blockNumber = 0; blockNumber < numBlocks; blockNumber++) {
+			const size_t blockSize = archive.GetBlockSize(fileNumber, blockNumber, error);
+			EXPECT_EQ(error, 0);
+			const size_t offset = result.size();
+			result.resize(offset + blockSize);
+			EXPECT_EQ(archive.ReadBlock(fileNumber, blockNumber, reinterpret_cast<uint8_t *>(&result[offset]), blockSize), 0);
+		}
+		EXPECT_EQ(archive.GetUnpackedFileSize(fileNumber, error), result.size());
+		EXPECT_EQ(archive.CloseBlockOffsetTable(fileNumber), 0);
+		return result;
+	}
+
+	void ExpectContents(MpqArchive &archive)
+	{
+		for (const auto &[name, data] : files_) {
+			SCOPED_TRACE(name);
+			EXPECT_TRUE(archive.HasFile(name));
+
+			size_t size = 0;
+			int32_t error;
+			const std::unique_ptr<std::byte[]> contents = archive.ReadFile(name, size, error);
+			ASSERT_EQ(error, 0);
+			ASSERT_EQ(size, data.size());
+			EXPECT_EQ(memcmp(contents.get(), data.data(), size), 0);
+
+			EXPECT_EQ(ReadBlocks(archive, name), data);
+		}
+		EXPECT_FALSE(archive.HasFile("missing.txt"));
+	}
+
+	std::vector<std::pair<std::string, std::vector<std::byte>>> files_;
+};
+
+TEST_F(MpqReaderTest, Libmpq)
+{
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error);
+	ASSERT_TRUE(archive.has_value());
+	ExpectContents(*archive);
+}
+
+TEST_F(MpqReaderTest, MemoryMapped)
+{
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error, /*memoryMap=*/true);
+	ASSERT_TRUE(archive.has_value());
+	ExpectContents(*archive);
+
+	std::optional<MpqArchive> clone = archive->Clone(error);
+	ASSERT_TRUE(clone.has_value());
+	ExpectContents(*clone);
+}
+
+// Meant to be run with -DTSAN=ON to catch state shared between clones.
+TEST_F(MpqReaderTest, MemoryMappedConcurrentClones)
+{
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error, /*memoryMap=*/true);
+	ASSERT_TRUE(archive.has_value());
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; i++) {
+		threads.emplace_back([this, &archive]() {
+			int32_t cloneError;
+			std::optional<MpqArchive> clone = archive->Clone(cloneError);
+			ASSERT_TRUE(clone.has_value());
+			for (int repeat = 0; repeat < 10; repeat++) {
+				for (const auto &[name, data] : files_)
+					EXPECT_EQ(ReadBlocks(*clone, name), data);
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+}
+
+TEST_F(MpqReaderTest, MissingArchive)
+{
+	int32_t error = -1;
+	EXPECT_FALSE(MpqArchive::Open("mpq_reader_test_missing.mpq", error, /*memoryMap=*/true).has_value());
+	EXPECT_EQ(error, 0);
+}
+
+} // namespace
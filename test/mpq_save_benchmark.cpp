@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "mpq/mpq_writer.hpp"
+#include "utils/file_util.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+namespace {
+
+constexpr char SavePath[] = "mpq_save_benchmark.sv";
+constexpr size_t LevelCount = 64;
+constexpr size_t DungeonSize = 112 * 112;
+
+/**
+ * @brief Builds a buffer shaped like a SaveLevel file: mostly uniform dungeon flag arrays plus some varied records.
+ */
+std::vector<std::byte> MakeLevel(uint32_t seed)
+{
+	auto next = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return static_cast<std::byte>(seed >> 24);
+	};
+
+	std::vector<std::byte> level;
+	for (int array = 0; array < 6; array++) {
+		for (size_t i = 0; i < DungeonSize; i++)
+			level.push_back((i % 97) < 3 ? next() : static_cast<std::byte>(array));
+	}
+	for (size_t i = 0; i < 200 * 64; i++)
+		level.push_back((i % 4) == 0 ? next() : std::byte { 0 });
+	return level;
+}
+
+void WriteSave(benchmark::State &state, bool parallel)
+{
+	std::vector<std::vector<std::byte>> levels;
+	for (size_t i = 0; i < LevelCount; i++)
+		levels.push_back(MakeLevel(static_cast<uint32_t>(i + 1)));
+
+	size_t bytes = 0;
+	for (const std::vector<std::byte> &level : levels)
+		bytes += level.size();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		RemoveFile(SavePath);
+		state.ResumeTiming();
+
+		MpqWriter writer(SavePath);
+		writer.SetParallelCompression(parallel);
+		for (size_t i = 0; i < levels.size(); i++)
+			writer.WriteFile(StrCat("perml", i), levels[i].data(), levels[i].size());
+	}
+	RemoveFile(SavePath);
+
+	state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_WriteSaveSerial(benchmark::State &state)
+{
+	WriteSave(state, false);
+}
+
+void BM_WriteSaveParallel(benchmark::State &state)
+{
+	WriteSave(state, true);
+}
+
+BENCHMARK(BM_WriteSaveSerial)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WriteSaveParallel)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace devilution
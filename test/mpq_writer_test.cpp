@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mpq/mpq_reader.hpp"
+#include "mpq/mpq_writer.hpp"
+#include "utils/file_util.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr char ArchivePath[] = "mpq_writer_test.mpq";
+constexpr char OtherArchivePath[] = "mpq_writer_test_other.mpq";
+constexpr char CompactedArchivePath[] = "mpq_writer_test.mpq.tmp";
+
+std::vector<std::byte> MakeFile(size_t size, uint32_t seed, bool noise = false)
+{
+	std::vector<std::byte> data(size);
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = noise || (i % 50) == 0 ? static_cast<std::byte>(seed >> 24) : static_cast<std::byte>(i / 100);
+	}
+	return data;
+}
+
+std::vector<char> ReadRaw(const char *path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+std::optional<std::vector<std::byte>> ReadBack(const char *path, const std::string &name)
+{
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(path, error);
+	if (!archive)
+		return std::nullopt;
+	size_t size = 0;
+	const std::unique_ptr<std::byte[]> contents = archive->ReadFile(name, size, error);
+	if (error != 0)
+		return std::nullopt;
+	return std::vector<std::byte>(contents.get(), contents.get() + size);
+}
+
+class MpqWriterTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		RemoveFile(ArchivePath);
+		RemoveFile(OtherArchivePath);
+		RemoveFile(CompactedArchivePath);
+	}
+
+	void TearDown() override
+	{
+		RemoveFile(ArchivePath);
+		RemoveFile(OtherArchivePath);
+		RemoveFile(CompactedArchivePath);
+	}
+};
+
+TEST_F(MpqWriterTest, SaveUnchangedThenChanged)
+{
+	const std::vector<std::byte> hero = MakeFile(3000, 1);
+	const std::vector<std::byte> level = MakeFile(20000, 2);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		ASSERT_TRUE(writer.WriteFile("perml00", level.data(), level.size()));
+	}
+	const std::vector<char> firstSave = ReadRaw(ArchivePath);
+
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		ASSERT_TRUE(writer.WriteFile("perml00", level.data(), level.size()));
+	}
+	EXPECT_EQ(ReadRaw(ArchivePath), firstSave) << "Saving the same contents again leaves the archive as it was";
+
+	const std::vector<std::byte> changedLevel = MakeFile(20000, 3);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		ASSERT_TRUE(writer.WriteFile("perml00", changedLevel.data(), changedLevel.size()));
+	}
+	EXPECT_NE(ReadRaw(ArchivePath), firstSave);
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), changedLevel);
+}
+
+TEST_F(MpqWriterTest, RenamedFileStaysUnchanged)
+{
+	const std::vector<std::byte> level = MakeFile(20000, 4);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("templ00", level.data(), level.size()));
+		writer.RenameFile("templ00", "perml00");
+	}
+	const std::vector<char> firstSave = ReadRaw(ArchivePath);
+
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("perml00", level.data(), level.size()));
+	}
+	EXPECT_EQ(ReadRaw(ArchivePath), firstSave);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), level);
+}
+
+TEST_F(MpqWriterTest, ArchiveReplacedOnDiskIsRewritten)
+{
+	// Same size and shape, so the other archive ends up with the very same block for the file
+	const std::vector<std::byte> hero = MakeFile(3000, 5);
+	const std::vector<std::byte> otherHero = MakeFile(3000, 6);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+	}
+	{
+		MpqWriter writer(OtherArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", otherHero.data(), otherHero.size()));
+		ASSERT_TRUE(writer.WriteFile("game", otherHero.data(), otherHero.size()));
+	}
+	CopyFileOverwrite(OtherArchivePath, ArchivePath);
+	ASSERT_EQ(ReadBack(ArchivePath, "hero"), otherHero);
+
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+	}
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero) << "Writes to an archive that was replaced behind the writer's back must not be skipped";
+	EXPECT_EQ(ReadBack(ArchivePath, "game"), otherHero);
+}
+
+TEST_F(MpqWriterTest, CompactsFragmentedArchive)
+{
+	const std::vector<std::byte> large = MakeFile(400000, 7, /*noise=*/true);
+	const std::vector<std::byte> hero = MakeFile(3000, 8);
+	const std::vector<std::byte> level = MakeFile(20000, 9);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("perml01", large.data(), large.size()));
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		ASSERT_TRUE(writer.WriteFile("perml00", level.data(), level.size()));
+	}
+	std::uintmax_t sizeBefore;
+	ASSERT_TRUE(GetFileSize(ArchivePath, &sizeBefore));
+
+	{
+		// Leaves a hole in front of the other files that is most of the archive
+		MpqWriter writer(ArchivePath);
+		writer.RemoveHashEntry("perml01");
+	}
+	std::uintmax_t sizeAfter;
+	ASSERT_TRUE(GetFileSize(ArchivePath, &sizeAfter));
+	EXPECT_LT(sizeAfter, sizeBefore - large.size() / 2);
+
+	EXPECT_EQ(ReadBack(ArchivePath, "perml01"), std::nullopt);
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), level);
+
+	{
+		// The files moved, unchanged writes still have to be recognized and keep the archive intact
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		const std::vector<std::byte> changedLevel = MakeFile(20000, 10);
+		ASSERT_TRUE(writer.WriteFile("perml00", changedLevel.data(), changedLevel.size()));
+	}
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), MakeFile(20000, 10));
+	EXPECT_FALSE(FileExists(CompactedArchivePath));
+}
+
+TEST_F(MpqWriterTest, InterruptedCompactionLeavesArchiveReadable)
+{
+	const std::vector<std::byte> large = MakeFile(400000, 7, /*noise=*/true);
+	const std::vector<std::byte> hero = MakeFile(3000, 8);
+	const std::vector<std::byte> level = MakeFile(20000, 9);
+	{
+		MpqWriter writer(ArchivePath);
+		ASSERT_TRUE(writer.WriteFile("perml01", large.data(), large.size()));
+		ASSERT_TRUE(writer.WriteFile("hero", hero.data(), hero.size()));
+		ASSERT_TRUE(writer.WriteFile("perml00", level.data(), level.size()));
+	}
+	const std::vector<char> original = ReadRaw(ArchivePath);
+
+	{
+		// Stops after copying one of the two remaining files, before the tables of the archive are rewritten
+		MpqWriter::TestCrashNextCompaction(1);
+		MpqWriter writer(ArchivePath);
+		writer.RemoveHashEntry("perml01");
+	}
+	EXPECT_EQ(ReadRaw(ArchivePath), original);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml01"), large);
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), level);
+
+	{
+		// The leftover copy is overwritten by the next compaction
+		MpqWriter writer(ArchivePath);
+		writer.RemoveHashEntry("perml01");
+	}
+	EXPECT_LT(ReadRaw(ArchivePath).size(), original.size() - large.size() / 2);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml01"), std::nullopt);
+	EXPECT_EQ(ReadBack(ArchivePath, "hero"), hero);
+	EXPECT_EQ(ReadBack(ArchivePath, "perml00"), level);
+	EXPECT_FALSE(FileExists(CompactedArchivePath));
+}
+
+} // namespace
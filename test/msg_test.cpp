@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "headless_mode.hpp"
+#include "msg.h"
+#include "multi.h"
+#include "nthread.h"
+#include "player.h"
+#include "storm/storm_net.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr uint8_t RemotePlayer = 1;
+constexpr uint8_t Level = 1;
+
+class DeltaExportTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		HeadlessMode = true;
+		GameData gameData {};
+		ASSERT_TRUE(SNetInitializeProvider(SELCONN_LOOPBACK, &gameData));
+		Players.resize(2);
+		MyPlayerId = 0;
+		MyPlayer = &Players[MyPlayerId];
+		gbIsMultiplayer = true;
+		gdwLargestMsgSize = sizeof(TPkt);
+		delta_init();
+	}
+
+	void TearDown() override
+	{
+		delta_init();
+		gbIsMultiplayer = false;
+		SNetDestroy();
+	}
+};
+
+/** @brief Sends all level deltas to the remote player and waits until the compressed levels have been cached. */
+void ExportAndWait()
+{
+	DeltaExportData(RemotePlayer);
+	for (int i = 0; i < 5000 && !TestIsDeltaExportCached(Level); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		DeltaExportProcess();
+	}
+	DeltaExportCancel(RemotePlayer);
+}
+
+TEST_F(DeltaExportTest, UnchangedLevelReusesCompressedExport)
+{
+	TSyncMonster sync {};
+	sync._mndx = 5;
+	sync._mx = 10;
+	sync._my = 12;
+	sync._mhitpoints = 100 << 6;
+	delta_sync_monster(sync, Level);
+	EXPECT_FALSE(TestIsDeltaExportCached(Level));
+
+	ExportAndWait();
+	ASSERT_TRUE(TestIsDeltaExportCached(Level)) << "The first export compresses the level and keeps the result";
+
+	delta_sync_monster(sync, Level);
+	EXPECT_TRUE(TestIsDeltaExportCached(Level)) << "A sync message repeating the delta does not change the level";
+
+	ExportAndWait();
+	EXPECT_TRUE(TestIsDeltaExportCached(Level)) << "A second export without changes reuses the compressed level";
+
+	sync._mhitpoints = 50 << 6;
+	delta_sync_monster(sync, Level);
+	EXPECT_FALSE(TestIsDeltaExportCached(Level)) << "Changing the level drops the compressed export";
+}
+
+} // namespace
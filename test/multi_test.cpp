@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "multi.h"
+#include "nthread.h"
+#include "player.h"
+#include "storm/storm_net.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr uint8_t RemotePlayer = 1;
+
+class TurnParsingTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		Players.resize(2);
+		MyPlayerId = 0;
+		MyPlayer = &Players[MyPlayerId];
+		player_state[0] = PS_CONNECTED;
+		player_state[RemotePlayer] = PS_CONNECTED | PS_TURN_ARRIVED;
+		gdwTurnsInTransit = 2;
+		sgbNetUpdateRate = 1;
+		sgbSentThisCycle = 100;
+		sgdwGameLoops = 400;
+	}
+
+	void TearDown() override
+	{
+		player_state[RemotePlayer] = 0;
+		glpMsgTbl[RemotePlayer] = 0;
+		gdwMsgLenTbl[RemotePlayer] = 0;
+	}
+
+	/** @brief Hands the first `size` bytes of `buffer` to the game as the remote player's turn. */
+	void ReceiveTurn(const std::byte *buffer, size_t size)
+	{
+		glpMsgTbl[RemotePlayer] = reinterpret_cast<uintptr_t>(buffer);
+		gdwMsgLenTbl[RemotePlayer] = size;
+		multi_msg_countdown();
+	}
+
+	alignas(uint32_t) std::byte buffer_[2 * sizeof(uint32_t)] = {};
+};
+
+TEST_F(TurnParsingTest, TurnBehindLocalQueueKeepsCounters)
+{
+	const uint32_t turn = 99;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(turn));
+	EXPECT_EQ(sgbSentThisCycle, 100U) << "A turn the local player is ahead of must not resync";
+	EXPECT_EQ(sgdwGameLoops, 400U);
+}
+
+TEST_F(TurnParsingTest, TurnInsideGrownQueueKeepsCounters)
+{
+	// The turn pacing just grew the queue, the extra turns have not been sent yet
+	gdwTurnsInTransit = 5;
+	const uint32_t turn = 98;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(turn));
+	EXPECT_EQ(sgbSentThisCycle, 100U) << "Growing the queue must not reset the game loop counter";
+	EXPECT_EQ(sgdwGameLoops, 400U);
+}
+
+TEST_F(TurnParsingTest, TurnAheadOfLocalQueueResyncs)
+{
+	const uint32_t turn = 250;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(turn));
+	EXPECT_EQ(sgbSentThisCycle, 252U) << "Joining players continue gdwTurnsInTransit turns after the others";
+	EXPECT_EQ(sgdwGameLoops, 1000U);
+}
+
+TEST_F(TurnParsingTest, TruncatedTurnIsIgnored)
+{
+	const uint32_t turn = 250;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(turn) - 1);
+	EXPECT_EQ(sgbSentThisCycle, 100U);
+	EXPECT_EQ(sgdwGameLoops, 400U);
+
+	ReceiveTurn(buffer_, 0);
+	EXPECT_EQ(sgbSentThisCycle, 100U);
+	EXPECT_EQ(sgdwGameLoops, 400U);
+}
+
+TEST_F(TurnParsingTest, OversizedTurnIsIgnored)
+{
+	const uint32_t turn = 250;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	std::memcpy(buffer_ + sizeof(turn), &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(buffer_));
+	EXPECT_EQ(sgbSentThisCycle, 100U);
+	EXPECT_EQ(sgdwGameLoops, 400U);
+}
+
+TEST_F(TurnParsingTest, TurnThatHasNotArrivedIsIgnored)
+{
+	player_state[RemotePlayer] = PS_CONNECTED;
+	const uint32_t turn = 250;
+	std::memcpy(buffer_, &turn, sizeof(turn));
+	ReceiveTurn(buffer_, sizeof(turn));
+	EXPECT_EQ(sgbSentThisCycle, 100U);
+	EXPECT_EQ(sgdwGameLoops, 400U);
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "levels/gendung.h"
+#include "msg.h"
+#include "objdat.h"
+#include "objects.h"
+#include "player.h"
+
+namespace devilution {
+namespace {
+
+/** Door states kept in _oVar4, see objects.cpp */
+constexpr int DoorOpen = 1;
+constexpr int DoorBlocked = 2;
+
+class AwakeObjectsTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		LoadObjectData();
+	}
+
+	void SetUp() override
+	{
+		Players.resize(2);
+		MyPlayerId = 0;
+		MyPlayer = &Players[0];
+		currlevel = 1;
+		leveltype = DTYPE_CATHEDRAL;
+		setlevel = false;
+
+		ActiveObjectCount = 0;
+		for (int i = 0; i < MAXOBJECTS; i++)
+			AvailableObjects[i] = i;
+		for (auto &column : dObject) {
+			for (int8_t &tile : column)
+				tile = 0;
+		}
+		for (auto &column : dMonster) {
+			for (int16_t &tile : column)
+				tile = 0;
+		}
+	}
+
+	/** @brief Lets the barrel fall asleep, then starts an animation without waking it, as only a wake up would be noticed. */
+	static Object &AddSleepingBarrel(Point position)
+	{
+		Object &barrel = *AddObject(OBJ_BARREL, position);
+		ProcessObjects();
+		barrel._oAnimFlag = true;
+		barrel._oAnimDelay = 1;
+		barrel._oAnimCnt = 0;
+		barrel._oAnimFrame = 1;
+		return barrel;
+	}
+};
+
+TEST_F(AwakeObjectsTest, SleepingObjectIsNotUpdated)
+{
+	Object &barrel = AddSleepingBarrel({ 20, 20 });
+	ProcessObjects();
+	EXPECT_EQ(barrel._oAnimFrame, 1);
+}
+
+TEST_F(AwakeObjectsTest, OperateWakesObjects)
+{
+	Object &barrel = AddSleepingBarrel({ 20, 20 });
+	Object &other = *AddObject(OBJ_BARREL, { 24, 20 });
+	// Barrels are broken, not operated, so this does nothing but wake the objects
+	OperateObject(Players[1], other);
+	ProcessObjects();
+	EXPECT_EQ(barrel._oAnimFrame, 2);
+}
+
+TEST_F(AwakeObjectsTest, SyncWakesObjects)
+{
+	Object &barrel = AddSleepingBarrel({ 20, 20 });
+	SyncObjectAnim(barrel);
+	ProcessObjects();
+	EXPECT_EQ(barrel._oAnimFrame, 2);
+
+	Object &door = *AddObject(OBJ_L1LDOOR, { 30, 30 });
+	ProcessObjects();
+	SyncOpObject(Players[1], CMD_OPENDOOR, door);
+	ASSERT_EQ(door._oVar4, DoorOpen);
+	dMonster[30][30] = 1;
+	ProcessObjects();
+	EXPECT_EQ(door._oVar4, DoorBlocked);
+}
+
+TEST_F(AwakeObjectsTest, BreakWakesObjects)
+{
+	Object &barrel = AddSleepingBarrel({ 20, 20 });
+	Object &broken = *AddObject(OBJ_BARREL, { 24, 20 });
+	ProcessObjects();
+	// Neither drops an item nor activates a skeleton
+	broken._oVar2 = 5;
+	SyncBreakObj(Players[1], broken);
+	ProcessObjects();
+	EXPECT_EQ(barrel._oAnimFrame, 2);
+	EXPECT_EQ(broken._oAnimFrame, 2);
+}
+
+TEST_F(AwakeObjectsTest, WakeAllObjectsAfterLoad)
+{
+	Object &door = *AddObject(OBJ_L1LDOOR, { 30, 30 });
+	ProcessObjects();
+
+	// Loading a level restores the door open while it sleeps
+	door._oVar4 = DoorOpen;
+	dMonster[30][30] = 1;
+	ProcessObjects();
+	EXPECT_EQ(door._oVar4, DoorOpen);
+
+	WakeAllObjects();
+	ProcessObjects();
+	EXPECT_EQ(door._oVar4, DoorBlocked);
+}
+
+} // namespace
+} // namespace devilution
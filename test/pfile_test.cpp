@@ -0,0 +1,224 @@
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/assets.hpp"
+#include "engine/random.hpp"
+#include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "itemdat.h"
+#include "items.h"
+#include "levels/gendung.h"
+#include "lighting.h"
+#include "loadsave.h"
+#include "menu.h"
+#include "mpq/mpq_writer.hpp"
+#include "missiles.h"
+#include "monstdat.h"
+#include "monster.h"
+#include "pfile.h"
+#include "playerdat.hpp"
+#include "quests.h"
+#include "spelldat.h"
+#include "utils/file_util.h"
+#include "utils/paths.h"
+
+namespace devilution {
+namespace {
+
+/** @brief Name of the temporary level file for dungeon level 5 */
+constexpr std::string_view LevelName = "templ05";
+
+std::string SavePath()
+{
+	return paths::PrefPath() + "single_" + std::to_string(gSaveNumber) + ".sv";
+}
+
+class LevelFileCacheTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		LoadCoreArchives();
+		LoadGameArchives();
+
+		// The tests need spawn.mpq or diabdat.mpq
+		// Please provide them so that the tests can run successfully
+		ASSERT_TRUE(HaveMainData());
+
+		HeadlessMode = true;
+		paths::SetPrefPath(paths::BasePath());
+		gbVanilla = false;
+		gbIsHellfire = false;
+		gbIsSpawn = false;
+		gbIsMultiplayer = false;
+		gbIsHellfireSaveGame = false;
+		giNumberOfLevels = 17;
+
+		Players.resize(1);
+		MyPlayerId = 0;
+		MyPlayer = &Players[MyPlayerId];
+
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadMissileData();
+		LoadMonsterData();
+		LoadItemData();
+		LoadQuestData();
+		InitQuests();
+
+		_uiheroinfo info {};
+		info.heroclass = HeroClass::Warrior;
+		pfile_ui_save_create(&info);
+		gSaveNumber = info.saveNumber;
+	}
+
+	void SetUp() override
+	{
+		currlevel = 5;
+		leveltype = DTYPE_CATACOMBS;
+		setlevel = false;
+		SetRndSeed(7);
+
+		Player &myPlayer = *MyPlayer;
+		myPlayer.plractive = true;
+		myPlayer.setLevel(currlevel);
+		myPlayer.position.tile = { 56, 56 };
+		InitLighting();
+		myPlayer.lightId = AddLight(myPlayer.position.tile, 10);
+
+		InitLevelMonsters();
+		AddMonsterType(MT_GOLEM, PLACE_SPECIAL);
+		for (int i = 0; i < MAX_PLRS; i++)
+			AddMonster(GolemHoldingCell, Direction::South, 0, false);
+		const size_t typeIndex = *AddMonsterType(MT_NZOMBIE, PLACE_SCATTER);
+		for (int i = 0; i < 10; i++) {
+			Monster *monster = AddMonster({ 20 + i * 2, 20 }, Direction::South, typeIndex, true);
+			monster->hitPoints = monster->maxHitPoints / (1 + i % 3);
+		}
+
+		InitItems();
+		for (int i = 0; i < 10; i++) {
+			const int ii = AllocateItem();
+			Item &item = Items[ii];
+			SetupAllItems(myPlayer, item, IDI_HEAL, AdvanceRndSeed(), 5, 1, false, false);
+			item.position = { 20 + i * 2, 30 };
+			dItem[item.position.x][item.position.y] = ii + 1;
+		}
+
+		InitMissiles();
+		pfile_remove_temp_files();
+	}
+};
+
+std::vector<std::byte> SerializeLevel()
+{
+	SaveSnapshot snapshot;
+	SaveLevel(snapshot);
+	const SaveSnapshot::File &file = snapshot.files.front();
+	return { file.data.get(), file.data.get() + file.size };
+}
+
+TEST_F(LevelFileCacheTest, CachedLoadMatchesColdLoad)
+{
+	const std::vector<std::byte> saved = SerializeLevel();
+
+	// Writes the level to the save without keeping it in memory
+	{
+		SaveWriter saveWriter(SavePath());
+		SaveLevel(saveWriter);
+	}
+	ASSERT_TRUE(pfile_cached_level_file(LevelName).empty());
+	ASSERT_TRUE(LoadLevel().has_value());
+	const std::vector<std::byte> coldLoad = SerializeLevel();
+	EXPECT_EQ(coldLoad, saved);
+
+	pfile_save_level();
+	const std::span<const std::byte> cached = pfile_cached_level_file(LevelName);
+	ASSERT_FALSE(cached.empty());
+	EXPECT_EQ(std::vector<std::byte>(cached.begin(), cached.end()), coldLoad);
+
+	ASSERT_TRUE(LoadLevel().has_value());
+	EXPECT_EQ(SerializeLevel(), coldLoad);
+}
+
+TEST_F(LevelFileCacheTest, SavingLevelLeavesHeroIndexAlone)
+{
+	const std::string indexPath = paths::PrefPath() + "single_heroes.idx";
+	pfile_write_hero(/*writeGameData=*/false);
+	ASSERT_TRUE(FileExists(indexPath));
+
+	RemoveFile(indexPath.c_str());
+	pfile_save_level();
+	pfile_remove_temp_files();
+	EXPECT_FALSE(FileExists(indexPath));
+
+	pfile_write_hero(/*writeGameData=*/false);
+	EXPECT_TRUE(FileExists(indexPath));
+}
+
+std::vector<HeroClass> ListedHeroClasses;
+std::vector<uint8_t> ListedHeroLevels;
+
+bool ListHero(_uiheroinfo *info)
+{
+	ListedHeroClasses.push_back(info->heroclass);
+	ListedHeroLevels.push_back(info->level);
+	return true;
+}
+
+TEST_F(LevelFileCacheTest, DamagedHeroIndexEntryIsRescanned)
+{
+	const std::string indexPath = paths::PrefPath() + "single_heroes.idx";
+	pfile_write_hero(/*writeGameData=*/false);
+	const uint8_t level = MyPlayer->getCharacterLevel();
+
+	// Offsets of the level and class of the first entry, behind the 8 byte header
+	constexpr std::streamoff LevelOffset = 8 + 32;
+	constexpr std::streamoff ClassOffset = 8 + 33;
+	for (const auto &[offset, value] : { std::pair { ClassOffset, 0xFF }, std::pair { LevelOffset, 0 }, std::pair { LevelOffset, 0xFF } }) {
+		{
+			std::fstream index(indexPath, std::ios::in | std::ios::out | std::ios::binary);
+			ASSERT_TRUE(index.is_open());
+			index.seekp(offset);
+			index.put(static_cast<char>(value));
+		}
+		ListedHeroClasses.clear();
+		ListedHeroLevels.clear();
+		pfile_ui_set_hero_infos(ListHero);
+		ASSERT_EQ(ListedHeroClasses.size(), 1);
+		EXPECT_EQ(ListedHeroClasses[0], HeroClass::Warrior);
+		EXPECT_EQ(ListedHeroLevels[0], level);
+
+		// The rescan wrote the entry back
+		std::ifstream index(indexPath, std::ios::binary);
+		index.seekg(ClassOffset);
+		EXPECT_EQ(index.get(), static_cast<int>(HeroClass::Warrior));
+	}
+}
+
+TEST_F(LevelFileCacheTest, RemovingTempFilesDropsCache)
+{
+	pfile_save_level();
+	ASSERT_FALSE(pfile_cached_level_file(LevelName).empty());
+
+	pfile_remove_temp_files();
+	EXPECT_TRUE(pfile_cached_level_file(LevelName).empty());
+}
+
+TEST_F(LevelFileCacheTest, ConvertingLevelsDropsCache)
+{
+	pfile_save_level();
+	ASSERT_FALSE(pfile_cached_level_file(LevelName).empty());
+
+	ASSERT_TRUE(pfile_convert_levels().has_value());
+	EXPECT_TRUE(pfile_cached_level_file(LevelName).empty());
+}
+
+} // namespace
+} // namespace devilution
@@ -1,11 +1,16 @@
 #include "player_test.h"
 
+#include <tuple>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "cursor.h"
 #include "engine/assets.hpp"
 #include "init.hpp"
+#include "items.h"
 #include "playerdat.hpp"
+#include "spelldat.h"
 
 using namespace devilution;
 
@@ -196,3 +201,111 @@ TEST(Player, CreatePlayer)
 	CreatePlayer(Players[0], HeroClass::Rogue);
 	AssertPlayer(Players[0]);
 }
+
+namespace {
+
+/** @brief Everything CalcPlrInv derives, including the requirement flags of every item the player has. */
+auto GetDerivedStats(const Player &player)
+{
+	std::vector<bool> statFlags;
+	for (const Item &item : player.InvBody)
+		statFlags.push_back(item._iStatFlag);
+	for (int i = 0; i < player._pNumInv; i++)
+		statFlags.push_back(player.InvList[i]._iStatFlag);
+	for (const Item &item : player.SpdList)
+		statFlags.push_back(item._iStatFlag);
+
+	return std::make_tuple(
+	    player._pStrength, player._pMagic, player._pDexterity, player._pVitality,
+	    player._pIMinDam, player._pIMaxDam, player._pDamageMod, player._pIBonusDam, player._pIBonusDamMod, player._pIBonusToHit,
+	    player._pIAC, player._pIBonusAC, player._pIEnAc, player._pIGetHit, player._pIFlags, player.pDamAcFlags,
+	    player._pMagResist, player._pFireResist, player._pLghtResist, player._pLightRad,
+	    player._pMaxHP, player._pHitPoints, player._pMaxMana, player._pMana,
+	    player._pIFMinDam, player._pIFMaxDam, player._pILMinDam, player._pILMaxDam,
+	    player._pISpells, player._pScrlSpells, player._pISplLvlAdd, player._pRSpell, player._pRSplType,
+	    player._pBlockFlag, statFlags);
+}
+
+_item_indexes FindBaseItem(bool (*matches)(const ItemData &))
+{
+	for (size_t i = 0; i < AllItemsList.size(); i++) {
+		if (matches(AllItemsList[i]))
+			return static_cast<_item_indexes>(i);
+	}
+	return IDI_NONE;
+}
+
+/** @brief Applies a change affecting only `group`, updates just that group and checks the result against a full CalcPlrInv. */
+template <typename Change>
+void ExpectPartialUpdateMatchesFull(Player &player, PlayerStatGroup group, Change change)
+{
+	change(player);
+	CalcPlrInv(player, false, group);
+	const auto partial = GetDerivedStats(player);
+	CalcPlrInv(player, false);
+	EXPECT_EQ(partial, GetDerivedStats(player));
+}
+
+} // namespace
+
+TEST(Player, PartialCalcPlrInvMatchesFullRecompute)
+{
+	LoadCoreArchives();
+	LoadGameArchives();
+
+	// The tests need spawn.mpq or diabdat.mpq
+	// Please provide them so that the tests can run successfully
+	ASSERT_TRUE(HaveMainData());
+
+	LoadSpellData();
+	LoadPlayerDataFiles();
+	LoadMonsterData();
+	LoadItemData();
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[0];
+	Player &player = *MyPlayer;
+	CreatePlayer(player, HeroClass::Sorcerer);
+
+	const _item_indexes armor = FindBaseItem([](const ItemData &data) { return data.itype == ItemType::HeavyArmor && data.iMinStr > 0; });
+	const _item_indexes staff = FindBaseItem([](const ItemData &data) { return data.iMiscId == IMISC_STAFF && data.iSpell != SpellID::Null; });
+	const _item_indexes ring = FindBaseItem([](const ItemData &data) { return data.itype == ItemType::Ring && data.dropRate > 0; });
+	const _item_indexes scroll = FindBaseItem([](const ItemData &data) { return data.iMiscId == IMISC_SCROLL && data.iSpell != SpellID::Null && data.iMinMag > 0; });
+	ASSERT_NE(armor, IDI_NONE);
+	ASSERT_NE(staff, IDI_NONE);
+	ASSERT_NE(ring, IDI_NONE);
+	ASSERT_NE(scroll, IDI_NONE);
+
+	InitializeItem(player.InvBody[INVLOC_CHEST], armor);
+	InitializeItem(player.InvBody[INVLOC_HAND_LEFT], staff);
+	SetupAllItems(player, player.InvBody[INVLOC_RING_LEFT], ring, 1, 30, 1, true, false);
+	InitializeItem(player.InvList[player._pNumInv++], scroll);
+	InitializeItem(player.SpdList[0], scroll);
+	player._pBaseStr = AllItemsList[armor].iMinStr - 1;
+	player._pBaseMag = 0;
+	CalcPlrInv(player, false);
+	ASSERT_FALSE(player.InvBody[INVLOC_CHEST]._iStatFlag);
+
+	// The armor no longer requiring strength makes it usable, which has to update its bonuses as well
+	ExpectPartialUpdateMatchesFull(player, PlayerStatGroup::Equipment, [](Player &p) { p.InvBody[INVLOC_CHEST]._iMinStr = 0; });
+	EXPECT_TRUE(player.InvBody[INVLOC_CHEST]._iStatFlag);
+
+	// Using up the last staff charge
+	ExpectPartialUpdateMatchesFull(player, PlayerStatGroup::ItemBonuses, [](Player &p) { p.InvBody[INVLOC_HAND_LEFT]._iCharges = 0; });
+
+	// Restoring mana
+	ExpectPartialUpdateMatchesFull(player, PlayerStatGroup::ItemBonuses, [](Player &p) {
+		p._pMaxManaBase += 10 << 6;
+		p._pManaBase = p._pMaxManaBase;
+	});
+
+	// A magic bonus, like the one rage grants, makes the scrolls usable, which has to update the carried items as well
+	ExpectPartialUpdateMatchesFull(player, PlayerStatGroup::ItemBonuses, [](Player &p) { p.InvBody[INVLOC_RING_LEFT]._iPLMag += 100; });
+	EXPECT_TRUE(player.SpdList[0]._iStatFlag);
+
+	// Moving a scroll from the belt into the inventory
+	ExpectPartialUpdateMatchesFull(player, PlayerStatGroup::Carried, [](Player &p) {
+		p.InvList[p._pNumInv++] = p.SpdList[0];
+		p.SpdList[0].clear();
+	});
+}
@@ -0,0 +1,90 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "controls/control_mode.hpp"
+#include "controls/plrctrls.h"
+#include "cursor.h"
+#include "levels/gendung.h"
+#include "monster.h"
+#include "player.h"
+
+namespace devilution {
+namespace {
+
+constexpr Point PlayerPosition = { 56, 56 };
+
+/**
+ * @brief Places every monster slot on a dungeon floor around the player, like a packed level under gamepad control.
+ * @param lit Whether the monsters stand in light, unlit monsters can't be targeted so the search covers its full range
+ */
+void InitCrowdedLevel(bool lit)
+{
+	leveltype = DTYPE_CATACOMBS;
+	gbIsMultiplayer = false;
+	ControlMode = ControlTypes::Gamepad;
+
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[0];
+	MyPlayer->position.tile = PlayerPosition;
+	MyPlayer->position.future = PlayerPosition;
+	MyPlayer->_pdir = Direction::South;
+	MyPlayer->_pInvincible = false;
+	MyPlayer->_pRSpell = SpellID::Invalid;
+
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dMonster[x][y] = 0;
+			dFlags[x][y] = lit ? DungeonFlag::Lit : DungeonFlag::None;
+		}
+	}
+
+	std::mt19937 rng(42);
+	ActiveMonsterCount = 0;
+	while (ActiveMonsterCount < MaxMonsters) {
+		const Point position { static_cast<int>(16 + rng() % 80), static_cast<int>(16 + rng() % 80) };
+		// Keep the closest ones a few steps away so the search has to spread out
+		if (position.WalkingDistance(PlayerPosition) < 4 || dMonster[position.x][position.y] != 0)
+			continue;
+
+		const size_t mi = ActiveMonsterCount++;
+		ActiveMonsters[mi] = static_cast<unsigned>(mi);
+		Monster &monster = Monsters[mi];
+		monster.position.tile = position;
+		monster.position.future = position;
+		monster.hitPoints = 100 << 6;
+		monster.maxHitPoints = monster.hitPoints;
+		monster.flags = 0;
+		monster.goal = MonsterGoal::Normal;
+		dMonster[position.x][position.y] = static_cast<int16_t>(mi + 1);
+	}
+}
+
+void FindTargets(benchmark::State &state, bool lit)
+{
+	InitCrowdedLevel(lit);
+	for (auto _ : state) {
+		plrctrls_after_check_curs_move();
+		benchmark::DoNotOptimize(pcursmonst);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void BM_FindMeleeTargetCrowded(benchmark::State &state)
+{
+	FindTargets(state, true);
+}
+
+void BM_FindMeleeTargetNoneVisible(benchmark::State &state)
+{
+	FindTargets(state, false);
+}
+
+BENCHMARK(BM_FindMeleeTargetCrowded);
+BENCHMARK(BM_FindMeleeTargetNoneVisible);
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "utils/spsc_queue.hpp"
+
+using namespace devilution;
+
+namespace {
+
+TEST(SpscQueueTest, PushPop)
+{
+	SpscQueue<int, 4> queue;
+	EXPECT_TRUE(queue.empty());
+	EXPECT_EQ(queue.front(), nullptr);
+
+	for (int i = 0; i < 4; i++)
+		EXPECT_TRUE(queue.tryPush(i));
+	EXPECT_TRUE(queue.full());
+	EXPECT_FALSE(queue.tryPush(4));
+	EXPECT_EQ(queue.tryReserve(), nullptr);
+
+	for (int i = 0; i < 4; i++) {
+		ASSERT_NE(queue.front(), nullptr);
+		EXPECT_EQ(*queue.front(), i);
+		queue.pop();
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, WrapsAround)
+{
+	SpscQueue<int, 3> queue;
+	for (int i = 0; i < 100; i++) {
+		EXPECT_TRUE(queue.tryPush(i));
+		EXPECT_TRUE(queue.tryPush(i + 1000));
+		EXPECT_EQ(*queue.front(), i);
+		queue.pop();
+		EXPECT_EQ(*queue.front(), i + 1000);
+		queue.pop();
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+// Meant to be run with -DTSAN=ON to catch missing synchronization between the two threads.
+TEST(SpscQueueTest, StressTwoThreads)
+{
+	constexpr uint32_t Count = 200000;
+	SpscQueue<std::vector<uint32_t>, 64> queue;
+
+	std::thread producer([&queue]() {
+		for (uint32_t i = 0; i < Count;) {
+			std::vector<uint32_t> *slot = queue.tryReserve();
+			if (slot == nullptr) {
+				std::this_thread::yield();
+				continue;
+			}
+			slot->assign(i % 7 + 1, i);
+			queue.commit();
+			i++;
+		}
+	});
+
+	// A failed assertion would return with the producer still running, so failures are only counted until it is joined
+	uint32_t expected = 0;
+	uint32_t damaged = 0;
+	while (expected < Count) {
+		const std::vector<uint32_t> *message = queue.front();
+		if (message == nullptr) {
+			std::this_thread::yield();
+			continue;
+		}
+		bool intact = message->size() == expected % 7 + 1;
+		for (const uint32_t value : *message)
+			intact = intact && value == expected;
+		if (!intact)
+			damaged++;
+		queue.pop();
+		expected++;
+	}
+
+	producer.join();
+	EXPECT_EQ(damaged, 0U) << "Messages arrived out of order or damaged";
+	EXPECT_TRUE(queue.empty());
+}
+
+} // namespace
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "headless_mode.hpp"
+#include "multi.h"
+#include "storm/storm_net.hpp"
+
+using namespace devilution;
+
+namespace {
+
+class ReceiveQueueTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		HeadlessMode = true;
+		GameData gameData {};
+		ASSERT_TRUE(SNetInitializeProvider(SELCONN_LOOPBACK, &gameData));
+		DvlNet_SetReceiveQueueEnabled(true);
+	}
+
+	void TearDown() override
+	{
+		DvlNet_SetReceiveQueueEnabled(false);
+		SNetDestroy();
+	}
+};
+
+/** @brief Sends message number `i`, which is `i % 7 + 1` copies of `i`, to the local player. */
+bool SendMessage(uint32_t i)
+{
+	std::vector<uint32_t> message(i % 7 + 1, i);
+	return SNetSendMessage(0, message.data(), message.size() * sizeof(uint32_t));
+}
+
+/** @brief Returns whether `data` is message number `expected` as sent by SendMessage. */
+bool IsMessage(const void *data, size_t size, uint32_t expected)
+{
+	if (size != (expected % 7 + 1) * sizeof(uint32_t))
+		return false;
+	for (size_t offset = 0; offset < size; offset += sizeof(uint32_t)) {
+		uint32_t value;
+		std::memcpy(&value, static_cast<const std::byte *>(data) + offset, sizeof(value));
+		if (value != expected)
+			return false;
+	}
+	return true;
+}
+
+TEST_F(ReceiveQueueTest, DeliversInOrderPastQueueCapacity)
+{
+	// More than the queue holds, so the rest has to go through the overflow list
+	constexpr uint32_t Count = 1000;
+	for (uint32_t i = 0; i < Count; i++) {
+		ASSERT_TRUE(SendMessage(i));
+		if (i % 100 == 0)
+			DvlNet_PumpReceiveQueue();
+	}
+
+	for (uint32_t i = 0; i < Count; i++) {
+		uint8_t sender;
+		void *data;
+		size_t size;
+		ASSERT_TRUE(SNetReceiveMessage(&sender, &data, &size)) << "Message " << i << " went missing";
+		EXPECT_EQ(sender, 0);
+		ASSERT_TRUE(IsMessage(data, size, i)) << "Message " << i << " arrived out of order or damaged";
+	}
+
+	uint8_t sender;
+	void *data;
+	size_t size;
+	EXPECT_FALSE(SNetReceiveMessage(&sender, &data, &size));
+}
+
+#ifndef NONET
+TEST_F(ReceiveQueueTest, DisablingDropsQueuedMessages)
+{
+	ASSERT_TRUE(SendMessage(1));
+	DvlNet_PumpReceiveQueue();
+	DvlNet_SetReceiveQueueEnabled(false);
+
+	uint8_t sender;
+	void *data;
+	size_t size;
+	EXPECT_FALSE(SNetReceiveMessage(&sender, &data, &size));
+}
+#endif
+
+// Meant to be run with -DTSAN=ON: the network thread pumps while the game thread drains.
+TEST_F(ReceiveQueueTest, NetworkThreadHandsOffToGameThread)
+{
+	constexpr uint32_t Count = 20000;
+
+	uint32_t sendFailures = 0;
+	std::thread networkThread([&sendFailures]() {
+		for (uint32_t i = 0; i < Count; i++) {
+			if (!SendMessage(i))
+				sendFailures++;
+			if (i % 16 == 0)
+				DvlNet_PumpReceiveQueue();
+		}
+		DvlNet_PumpReceiveQueue();
+	});
+
+	// gtest assertions have to stay on this thread, so failures are only counted until the other thread is done
+	uint32_t expected = 0;
+	uint32_t damaged = 0;
+	while (expected < Count) {
+		uint8_t sender;
+		void *data;
+		size_t size;
+		if (!SNetReceiveMessage(&sender, &data, &size)) {
+			std::this_thread::yield();
+			continue;
+		}
+		if (sender != 0 || !IsMessage(data, size, expected))
+			damaged++;
+		expected++;
+	}
+
+	networkThread.join();
+	EXPECT_EQ(sendFailures, 0U);
+	EXPECT_EQ(damaged, 0U) << "Messages arrived out of order or damaged";
+}
+
+} // namespace
@@ -5,6 +5,7 @@
 
 #include "levels/dun_tile.hpp"
 #include "levels/gendung.h"
+#include "levels/line_of_sight.hpp"
 #include "objdat.h"
 #include "objects.h"
 
@@ -56,6 +57,70 @@ TEST(TilePropertiesTest, Walkable)
 	EXPECT_TRUE(IsTileWalkable({ 5, 5 }, true)) << "Solid tiles occupied by an open door become walkable when ignoring doors";
 }
 
+TEST(TilePropertiesTest, CompiledBitboards)
+{
+	dPiece[5][5] = 0;
+	dPiece[6][6] = 1;
+	SOLData[0] = TileProperties::Solid | TileProperties::BlockMissile;
+	SOLData[1] = TileProperties::None;
+	dObject[5][5] = 0;
+	dObject[6][6] = 1;
+	Objects[0]._otype = _object_id::OBJ_L1LDOOR;
+	Objects[0]._oSolidFlag = true;
+	CompileTileBitboards();
+
+	EXPECT_TRUE(IsTileSolid({ 5, 5 })) << "Solid tiles are solid when read from the bitboards";
+	EXPECT_FALSE(IsTileNotSolid({ 5, 5 })) << "IsTileNotSolid returns the inverse of IsTileSolid for in-bounds tiles";
+	EXPECT_TRUE(IsTileBlockingMissiles({ 5, 5 })) << "Tiles blocking missiles are read from the bitboards";
+	EXPECT_FALSE(IsTileWalkable({ 5, 5 }, true)) << "Solid non-door tiles are unwalkable";
+	EXPECT_FALSE(IsTileSolid({ -1, 1 })) << "Out of bounds tiles are not solid";
+	EXPECT_FALSE(IsTileNotSolid({ -1, 1 })) << "Out of bounds tiles are also not not solid";
+	EXPECT_FALSE(IsTileWalkable({ -1, 1 })) << "Out of bounds tiles are not walkable";
+
+	EXPECT_FALSE(IsTileSolid({ 6, 6 })) << "Non-solid tiles are not solid when read from the bitboards";
+	EXPECT_FALSE(IsTileBlockingMissiles({ 6, 6 })) << "Non-solid tiles let missiles through";
+	EXPECT_FALSE(IsTileWalkable({ 6, 6 })) << "Tile occupied by a closed door is unwalkable";
+	EXPECT_TRUE(IsTileWalkable({ 6, 6 }, true)) << "Tile occupied by a door is considered walkable when ignoring doors";
+
+	Objects[0]._oSolidFlag = false;
+	EXPECT_FALSE(IsTileWalkable({ 6, 6 })) << "Bitboards keep their answer until they are invalidated";
+	InvalidateTileBitboards();
+	EXPECT_TRUE(IsTileWalkable({ 6, 6 })) << "Invalidated bitboards are rebuilt on the next query";
+
+	SOLData[0] = TileProperties::None;
+	InvalidateTileBitboards();
+	EXPECT_FALSE(IsTileSolid({ 5, 5 })) << "Changes to the tile properties show up after invalidation";
+	EXPECT_FALSE(IsTileBlockingMissiles({ 5, 5 })) << "Changes to the tile properties show up after invalidation";
+	EXPECT_TRUE(IsTileWalkable({ 5, 5 })) << "Changes to the tile properties show up after invalidation";
+
+	ClearTileBitboards();
+	SOLData[0] = TileProperties::Solid;
+	EXPECT_TRUE(IsTileSolid({ 5, 5 })) << "Cleared bitboards fall back to the level arrays";
+	dObject[6][6] = 0;
+}
+
+TEST(TilePropertiesTest, InvalidationCoversLineOfSight)
+{
+	dPiece[4][5] = 1;
+	dPiece[5][5] = 0;
+	dPiece[6][5] = 1;
+	SOLData[0] = TileProperties::Solid | TileProperties::BlockMissile;
+	SOLData[1] = TileProperties::None;
+	CompileTileBitboards();
+	EXPECT_FALSE(IsMissileLineClear({ 4, 5 }, { 6, 5 })) << "Compiling the bitboards rebuilds the line of sight masks";
+	EXPECT_FALSE(IsSolidLineClear({ 4, 5 }, { 6, 5 })) << "Compiling the bitboards rebuilds the line of sight masks";
+
+	SOLData[0] = TileProperties::None;
+	InvalidateTileBitboards();
+	EXPECT_TRUE(IsMissileLineClear({ 4, 5 }, { 6, 5 })) << "Invalidating the bitboards also invalidates the line of sight masks";
+	EXPECT_TRUE(IsSolidLineClear({ 4, 5 }, { 6, 5 })) << "Invalidating the bitboards also invalidates the line of sight masks";
+
+	SOLData[0] = TileProperties::Solid;
+	ClearTileBitboards();
+	EXPECT_TRUE(IsMissileLineClear({ 4, 5 }, { 6, 5 })) << "Clearing the bitboards also invalidates the line of sight masks";
+	EXPECT_FALSE(IsSolidLineClear({ 4, 5 }, { 6, 5 })) << "Clearing the bitboards also invalidates the line of sight masks";
+}
+
 TEST(TilePropertiesTest, CanStepTest)
 {
 	dPiece[0][0] = 0;
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <string>
 #include <vector>
 
 #include <SDL_endian.h>
@@ -17,11 +18,26 @@
 #include "pfile.h"
 #include "playerdat.hpp"
 #include "utils/file_util.h"
+#include "utils/algorithm/container.hpp"
 #include "utils/paths.h"
 
 namespace devilution {
 namespace {
 
+std::vector<_uiheroinfo> ListedHeroes;
+
+bool ListHero(_uiheroinfo *info)
+{
+	ListedHeroes.push_back(*info);
+	return true;
+}
+
+const _uiheroinfo *FindListedHero(uint32_t saveNumber)
+{
+	const auto it = c_find_if(ListedHeroes, [saveNumber](const _uiheroinfo &info) { return info.saveNumber == saveNumber; });
+	return it != ListedHeroes.end() ? &*it : nullptr;
+}
+
 constexpr int SpellDatVanilla[] = {
 	0, 1, 1, 4, 5, -1, 3, 3, 6, -1, 7, 6, 8, 9,
 	8, 9, -1, -1, -1, -1, 3, 11, -1, 14, -1, -1,
@@ -415,5 +431,73 @@ TEST(Writehero, pfile_write_hero)
 	    "a79367caae6192d54703168d82e0316aa289b2a33251255fad8abe34889c1d3a");
 }
 
+TEST(Writehero, pfile_ui_set_hero_infos)
+{
+	LoadCoreArchives();
+	LoadGameArchives();
+
+	// The tests need spawn.mpq or diabdat.mpq
+	// Please provide them so that the tests can run successfully
+	ASSERT_TRUE(HaveMainData());
+
+	const std::string savePath = paths::BasePath() + "multi_0.sv";
+	const std::string indexPath = paths::BasePath() + "multi_heroes.idx";
+	paths::SetPrefPath(paths::BasePath());
+	RemoveFile(savePath.c_str());
+	RemoveFile(indexPath.c_str());
+
+	gbVanilla = true;
+	gbIsHellfire = false;
+	gbIsSpawn = false;
+	gbIsMultiplayer = true;
+	gbIsHellfireSaveGame = false;
+	leveltype = DTYPE_TOWN;
+	giNumberOfLevels = 17;
+
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[MyPlayerId];
+
+	LoadSpellData();
+	LoadPlayerDataFiles();
+	LoadMonsterData();
+	LoadItemData();
+	_uiheroinfo info {};
+	info.heroclass = HeroClass::Rogue;
+	pfile_ui_save_create(&info);
+	PlayerPack pks;
+	PackPlayerTest(&pks);
+	UnPackPlayer(pks, *MyPlayer);
+	pfile_write_hero();
+	ASSERT_TRUE(FileExists(indexPath));
+
+	ListedHeroes.clear();
+	pfile_ui_set_hero_infos(ListHero);
+	const _uiheroinfo *indexed = FindListedHero(0);
+	ASSERT_NE(indexed, nullptr);
+	const _uiheroinfo expected = *indexed;
+	EXPECT_EQ(expected.heroclass, HeroClass::Rogue);
+	EXPECT_EQ(expected.level, MyPlayer->getCharacterLevel());
+	EXPECT_EQ(expected.strength, MyPlayer->_pStrength);
+	EXPECT_FALSE(expected.hassaved);
+
+	// Without the index the hero is read back from the save and has to look the same
+	RemoveFile(indexPath.c_str());
+	ListedHeroes.clear();
+	pfile_ui_set_hero_infos(ListHero);
+	const _uiheroinfo *scanned = FindListedHero(0);
+	ASSERT_NE(scanned, nullptr);
+	EXPECT_STREQ(scanned->name, expected.name);
+	EXPECT_EQ(scanned->level, expected.level);
+	EXPECT_EQ(scanned->heroclass, expected.heroclass);
+	EXPECT_EQ(scanned->herorank, expected.herorank);
+	EXPECT_EQ(scanned->strength, expected.strength);
+	EXPECT_EQ(scanned->magic, expected.magic);
+	EXPECT_EQ(scanned->dexterity, expected.dexterity);
+	EXPECT_EQ(scanned->vitality, expected.vitality);
+	EXPECT_EQ(scanned->hassaved, expected.hassaved);
+	EXPECT_TRUE(FileExists(indexPath));
+}
+
 } // namespace
 } // namespace devilution